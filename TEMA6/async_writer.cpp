@@ -0,0 +1,329 @@
+#include "async_writer.h"
+#include "timing.h"
+#include <new>
+#include <cerrno>
+
+namespace AsyncWriter {
+
+    // pool buffers start on a page, which registered (and uncached) writes like
+    static constexpr size_t kBufferAlign = 4096;
+
+    const wchar_t* BackendName(Backend backend) {
+        switch (backend) {
+        case Backend::Threads: return L"threads";
+        case Backend::IoUring: return L"uring";
+        default: return L"unknown";
+        }
+    }
+
+    void Target::Reset(Platform::FileHandle f) {
+        file = f;
+        inFlight = 0;
+        writeCalls = 0;
+        bytes = 0;
+        failed = false;
+        error.clear();
+        slot = -1;
+    }
+
+    std::wstring Target::Error() {
+        errorLock.Lock();
+        std::wstring e = error;
+        errorLock.Unlock();
+        return e;
+    }
+
+    Service::~Service() {
+        Stop();
+    }
+
+    bool Service::Start(Backend requested, uint32_t threadCount, uint32_t producers, uint32_t queueDepth,
+        size_t blockBytes, std::wstring& err) {
+        Stop();
+        if (threadCount == 0 || blockBytes == 0) {
+            err = L"Async writer needs at least one thread and a buffer";
+            return false;
+        }
+        if (queueDepth == 0) queueDepth = 1;
+
+        // the queue can hold every buffer, so Submit never finds it full
+        bufferCount = producers + queueDepth;
+        queue.reset(new BoundedQueue<Block>(bufferCount));
+        pool.reset(new BoundedQueue<char*>(bufferCount));
+        bufferBytes = blockBytes;
+        stride = (bufferBytes + kBufferAlign - 1) / kBufferAlign * kBufferAlign;
+        region = static_cast<char*>(::operator new(stride * bufferCount, std::align_val_t(kBufferAlign), std::nothrow));
+        if (!region) {
+            err = L"Out of memory for " + std::to_wstring(bufferCount) + L" async output buffers of "
+                + std::to_wstring(bufferBytes) + L" bytes";
+            Stop();
+            return false;
+        }
+        for (uint32_t i = 0; i < bufferCount; i++) pool->TryPush(region + i * stride);
+
+        backend = Backend::Threads;
+        if (requested == Backend::IoUring) {
+            std::wstring ringErr;
+            if (ring.Open(bufferCount, region, stride, bufferCount, producers, ringErr)) {
+                backend = Backend::IoUring;
+                slots.assign(producers, nullptr);
+            }
+            else {
+                Platform::DebugLog(L"io_uring writer not available, using writer threads: " + ringErr);
+            }
+        }
+
+        depth = 0;
+        stopping = 0;
+        const uint32_t count = backend == Backend::IoUring ? 1 : threadCount;
+        for (uint32_t i = 0; i < count; i++) {
+            Platform::ThreadHandle thread = Platform::StartThread(backend == Backend::IoUring ? RingProc : WriterProc, this, err);
+            if (!thread) {
+                Stop();
+                return false;
+            }
+            threads.push_back(thread);
+        }
+        return true;
+    }
+
+    void Service::Stop() {
+        if (!threads.empty()) {
+            Sync::Publish(&stopping, 1);
+            Sync::IncrementAndWake(&submitted);
+            for (Platform::ThreadHandle thread : threads) Platform::JoinThread(thread);
+            threads.clear();
+        }
+        ring.Close();
+        slots.clear();
+        if (region) ::operator delete(region, std::align_val_t(kBufferAlign));
+        region = nullptr;
+        bufferCount = 0;
+        queue.reset();
+        pool.reset();
+        bufferBytes = 0;
+    }
+
+    bool Service::Attach(Target& target, std::wstring& err) {
+        if (backend != Backend::IoUring) return true;
+        slotLock.Lock();
+        uint32_t slot = 0;
+        while (slot < slots.size() && slots[slot]) slot++;
+        if (slot < slots.size()) slots[slot] = &target;
+        slotLock.Unlock();
+        if (slot == slots.size()) {
+            err = L"More io_uring writer targets than producers";
+            return false;
+        }
+        if (!ring.SetFile(slot, target.file, err)) {
+            Detach(target);
+            return false;
+        }
+        target.slot = (int32_t)slot;
+        return true;
+    }
+
+    void Service::Detach(Target& target) {
+        if (backend != Backend::IoUring) return;
+        slotLock.Lock();
+        for (uint32_t i = 0; i < slots.size(); i++) {
+            if (slots[i] != &target) continue;
+            std::wstring err;
+            ring.SetFile(i, Platform::kInvalidFile, err);
+            slots[i] = nullptr;
+        }
+        slotLock.Unlock();
+        target.slot = -1;
+    }
+
+    char* Service::Acquire(double& stall_us) {
+        char* data = nullptr;
+        if (pool->TryPop(data)) return data;
+
+        // backpressure: every buffer is queued or being written
+        Timing::Ticks start = Timing::Now();
+        waitingProducers++;
+        for (;;) {
+            int32_t seen = recycled.load();
+            if (pool->TryPop(data)) break;
+            Sync::WaitWhileEqual(&recycled, seen, Sync::WaitPolicy::Block);
+        }
+        waitingProducers--;
+        stall_us += Timing::ElapsedMicros(start, Timing::Now());
+        return data;
+    }
+
+    void Service::Recycle(char* data) {
+        pool->TryPush(data);
+        recycled++;
+        if (waitingProducers.load() > 0) Platform::WakeAllOnWord(recycled);
+    }
+
+    void Service::Release(char* data) {
+        if (data) Recycle(data);
+    }
+
+    uint32_t Service::Submit(Target& target, char* data, size_t bytes, uint64_t offset) {
+        target.inFlight++;
+        int32_t queued = ++depth;
+        while (!queue->TryPush({ &target, data, bytes, offset })) Platform::YieldThread();
+        submitted++;
+        if (idleWriters.load() > 0) Platform::WakeOneOnWord(submitted);
+        return (uint32_t)queued;
+    }
+
+    void Service::WaitIdle(Target& target) {
+        int32_t left;
+        while ((left = target.inFlight.load()) != 0) Sync::WaitWhileEqual(&target.inFlight, left, Sync::WaitPolicy::Block);
+    }
+
+    unsigned int PLATFORM_CALL Service::WriterProc(void* param) {
+        static_cast<Service*>(param)->WriterLoop();
+        return 0;
+    }
+
+    // Idle: sleep until a block is queued. False once the service stops and the queue is empty.
+    bool Service::WaitForBlocks() {
+        // announce the sleep before the last look, so a Submit after it always wakes us
+        idleWriters++;
+        int32_t seen = submitted.load();
+        bool more = depth.load() > 0;
+        if (!more && stopping.load()) {
+            idleWriters--;
+            return false;
+        }
+        if (!more) Sync::WaitWhileEqual(&submitted, seen, Sync::WaitPolicy::Block);
+        idleWriters--;
+        return true;
+    }
+
+    void Service::WriterLoop() {
+        for (;;) {
+            Block block;
+            if (queue->TryPop(block)) {
+                depth--;
+                Write(block);
+                continue;
+            }
+            if (!WaitForBlocks()) return;
+        }
+    }
+
+    unsigned int PLATFORM_CALL Service::RingProc(void* param) {
+        static_cast<Service*>(param)->RingLoop();
+        return 0;
+    }
+
+    // Every pool buffer can be in flight at once (the ring has an entry for each), so a
+    // block goes to the kernel as soon as it is popped; one io_uring_enter per round
+    // submits the batch and reaps what has finished
+    void Service::RingLoop() {
+        std::vector<Block> pending(bufferCount);     // by buffer index
+        std::vector<char*> bases(bufferCount);
+        std::vector<Platform::RingCompletion> done(bufferCount);
+        uint32_t inFlight = 0;
+        std::wstring err;
+
+        for (;;) {
+            Block block;
+            while (inFlight < bufferCount && queue->TryPop(block)) {
+                depth--;
+                uint32_t index = (uint32_t)((block.data - region) / stride);
+                bases[index] = block.data;
+                if (block.target->failed.load() || block.target->slot < 0) {
+                    if (block.target->slot < 0) {
+                        block.target->errorLock.Lock();
+                        if (block.target->error.empty()) block.target->error = L"Block for a target without a file slot";
+                        block.target->errorLock.Unlock();
+                        block.target->failed = true;
+                    }
+                    Finish(*block.target, block.data);
+                    continue;
+                }
+                pending[index] = block;
+                block.target->writeCalls++;
+                ring.QueueWrite((uint32_t)block.target->slot, index, block.data, block.bytes, block.offset, index);
+                inFlight++;
+            }
+
+            if (inFlight == 0) {
+                if (!WaitForBlocks()) return;
+                continue;
+            }
+
+            // wait for a completion only when there is nothing new to hand over
+            uint32_t waitFor = depth.load() == 0 || inFlight == bufferCount ? 1 : 0;
+            int count = ring.Submit(waitFor, done.data(), bufferCount, err);
+            if (count < 0) {
+                // the ring is unusable: fail what is in flight and write the rest with pwrite
+                Platform::DebugLog(L"io_uring writer failed, writing directly: " + err);
+                for (uint32_t i = 0; i < bufferCount; i++) {
+                    Block& b = pending[i];
+                    if (!b.target) continue;
+                    b.target->errorLock.Lock();
+                    if (b.target->error.empty()) b.target->error = err;
+                    b.target->errorLock.Unlock();
+                    b.target->failed = true;
+                    Finish(*b.target, bases[i]);
+                    b.target = nullptr;
+                }
+                WriterLoop();
+                return;
+            }
+
+            for (int c = 0; c < count; c++) {
+                uint32_t index = (uint32_t)done[c].tag;
+                Block& b = pending[index];
+                int64_t res = done[c].result;
+                if (res > 0 && (size_t)res < b.bytes) {
+                    // short write: the rest of the same registered buffer goes again
+                    b.target->bytes += (uint64_t)res;
+                    b.data += res;
+                    b.bytes -= (size_t)res;
+                    b.offset += (uint64_t)res;
+                    b.target->writeCalls++;
+                    ring.QueueWrite((uint32_t)b.target->slot, index, b.data, b.bytes, b.offset, index);
+                    continue;
+                }
+                if (res < 0 || (res == 0 && b.bytes > 0)) {
+                    b.target->errorLock.Lock();
+                    if (b.target->error.empty()) b.target->error = L"io_uring write failed: " + Platform::ErrorText(res < 0 ? (uint32_t)-res : (uint32_t)EIO);
+                    b.target->errorLock.Unlock();
+                    b.target->failed = true;
+                }
+                else {
+                    b.target->bytes += (uint64_t)res;
+                }
+                Target& target = *b.target;
+                b.target = nullptr;
+                inFlight--;
+                Finish(target, bases[index]);
+            }
+        }
+    }
+
+    void Service::Write(const Block& block) {
+        Target& target = *block.target;
+        // after a failure the rest of the target's blocks are dropped, like a latched writer
+        if (!target.failed.load()) {
+            std::wstring err;
+            target.writeCalls++;
+            if (Platform::WriteAt(target.file, block.data, block.bytes, block.offset, err)) {
+                target.bytes += block.bytes;
+            }
+            else {
+                target.errorLock.Lock();
+                if (target.error.empty()) target.error = err;
+                target.errorLock.Unlock();
+                target.failed = true;
+            }
+        }
+        Finish(target, block.data);
+    }
+
+    // a block is done with: its buffer back to the pool, the target one closer to idle
+    void Service::Finish(Target& target, char* data) {
+        Recycle(data);
+        if (--target.inFlight == 0) Platform::WakeAllOnWord(target.inFlight);
+    }
+}
@@ -0,0 +1,184 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include "platform.h"
+#include "sync_wait.h"
+
+// Writer threads for worker output. A worker hands each full buffer to a bounded queue
+// and carries on with a free buffer from a fixed pool; writer threads put the blocks
+// into place with positional writes and recycle the buffers. The disk only holds a
+// worker up when every pool buffer is queued or being written (backpressure), instead
+// of on every write. Used through ResultWriter::BufferedWriter::OpenQueued.
+namespace AsyncWriter {
+
+    // Who drains the queue
+    enum class Backend {
+        Threads,    // writer threads, one pwrite / WriteFile per block each
+        IoUring     // one thread feeding Platform::WriteRing: the pool buffers and worker files
+                    // are registered, queued blocks go to the kernel in batches and many
+                    // writes are in flight at once (Linux; elsewhere it falls back to Threads)
+    };
+    const wchar_t* BackendName(Backend backend);   // "threads", "uring"
+
+    // Bounded lock-free queue: an array of cells, each with a sequence number that says
+    // whose turn it is (D. Vyukov). Producers claim a slot with one CAS on head, the
+    // consumer side likewise on tail; many producers and any number of writer threads.
+    // TryPush / TryPop never wait, the callers decide how to.
+    template <typename T>
+    class BoundedQueue {
+    public:
+        explicit BoundedQueue(size_t minCapacity) {
+            size_t capacity = 2;
+            while (capacity < minCapacity) capacity *= 2;
+            cells.reset(new Cell[capacity]);
+            for (size_t i = 0; i < capacity; i++) cells[i].seq.store(i, std::memory_order_relaxed);
+            mask = capacity - 1;
+        }
+        BoundedQueue(const BoundedQueue&) = delete;
+        BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+        bool TryPush(const T& item) {
+            size_t pos = head.load(std::memory_order_relaxed);
+            for (;;) {
+                Cell& cell = cells[pos & mask];
+                intptr_t diff = (intptr_t)cell.seq.load(std::memory_order_acquire) - (intptr_t)pos;
+                if (diff == 0) {
+                    if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        cell.item = item;
+                        cell.seq.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0) {
+                    return false;   // full: the cell still holds an item a lap behind
+                }
+                else {
+                    pos = head.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        bool TryPop(T& item) {
+            size_t pos = tail.load(std::memory_order_relaxed);
+            for (;;) {
+                Cell& cell = cells[pos & mask];
+                intptr_t diff = (intptr_t)cell.seq.load(std::memory_order_acquire) - (intptr_t)(pos + 1);
+                if (diff == 0) {
+                    if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        item = cell.item;
+                        cell.seq.store(pos + mask + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0) {
+                    return false;   // empty
+                }
+                else {
+                    pos = tail.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+    private:
+        struct Cell {
+            std::atomic<size_t> seq;
+            T item;
+        };
+
+        std::unique_ptr<Cell[]> cells;
+        size_t mask = 0;
+        alignas(Sync::kCacheLine) std::atomic<size_t> head{ 0 };   // next push
+        alignas(Sync::kCacheLine) std::atomic<size_t> tail{ 0 };   // next pop
+    };
+
+    // One worker's output file as the writer threads see it. Counters are bumped by
+    // whichever writer thread wrote the block; the owner reads them after WaitIdle.
+    // Must stay alive until the Service is stopped.
+    struct Target {
+        Platform::FileHandle file = Platform::kInvalidFile;
+        Sync::Word inFlight{ 0 };               // blocks submitted and not yet written
+        std::atomic<uint64_t> writeCalls{ 0 };
+        std::atomic<uint64_t> bytes{ 0 };
+        std::atomic<bool> failed{ false };
+        Platform::Mutex errorLock;
+        std::wstring error;                     // first failed write (errorLock)
+        int32_t slot = -1;                      // IoUring: registered file slot (Service::Attach)
+
+        void Reset(Platform::FileHandle f);     // owner only, nothing in flight
+        std::wstring Error();
+    };
+
+    class Service {
+    public:
+        Service() = default;
+        ~Service();
+        Service(const Service&) = delete;
+        Service& operator=(const Service&) = delete;
+
+        // threads writer threads (IoUring: one ring thread) and a pool of producers +
+        // queueDepth buffers of bufferBytes. Every producer keeps one buffer to fill, so
+        // queueDepth is how many full blocks may wait for the disk before a producer has to.
+        // An io_uring the kernel refuses falls back to Threads (ActiveBackend, logged).
+        bool Start(Backend backend, uint32_t threads, uint32_t producers, uint32_t queueDepth, size_t bufferBytes, std::wstring& err);
+        // Writes whatever is still queued, joins the threads and frees the pool
+        void Stop();
+        bool Running() const { return !threads.empty(); }
+        Backend ActiveBackend() const { return backend; }
+
+        // Before a target's first Submit / after its WaitIdle: IoUring registers its file
+        bool Attach(Target& target, std::wstring& err);
+        void Detach(Target& target);
+
+        size_t BufferBytes() const { return bufferBytes; }
+
+        // A free buffer; while there is none the caller waits, and stall_us grows by the wait
+        char* Acquire(double& stall_us);
+        void Release(char* data);   // an unused buffer back to the pool
+        // A full block for target at offset (the buffer belongs to the service from here on);
+        // returns the queue depth including this block
+        uint32_t Submit(Target& target, char* data, size_t bytes, uint64_t offset);
+        // Until every block submitted for target is written
+        void WaitIdle(Target& target);
+
+    private:
+        struct Block {
+            Target* target;
+            char* data;
+            size_t bytes;
+            uint64_t offset;
+        };
+
+        static unsigned int PLATFORM_CALL WriterProc(void* param);
+        static unsigned int PLATFORM_CALL RingProc(void* param);
+        void WriterLoop();
+        void RingLoop();
+        bool WaitForBlocks();
+        void Write(const Block& block);
+        void Finish(Target& target, char* data);
+        void Recycle(char* data);
+
+        std::unique_ptr<BoundedQueue<Block>> queue;     // full blocks, oldest first
+        std::unique_ptr<BoundedQueue<char*>> pool;      // free buffers
+        char* region = nullptr;                         // every buffer, stride bytes apart
+        size_t stride = 0;
+        uint32_t bufferCount = 0;
+        std::vector<Platform::ThreadHandle> threads;
+        size_t bufferBytes = 0;
+        Backend backend = Backend::Threads;
+
+        Platform::WriteRing ring;
+        Platform::Mutex slotLock;
+        std::vector<Target*> slots;                     // IoUring: registered file per slot
+
+        std::atomic<int32_t> depth{ 0 };            // blocks in the queue
+        alignas(Sync::kCacheLine) Sync::Word submitted{ 0 };   // writer threads wait on it
+        std::atomic<int32_t> idleWriters{ 0 };
+        Sync::Word stopping{ 0 };
+        alignas(Sync::kCacheLine) Sync::Word recycled{ 0 };    // producers out of buffers wait on it
+        std::atomic<int32_t> waitingProducers{ 0 };
+    };
+}
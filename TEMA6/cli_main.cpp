@@ -0,0 +1,316 @@
+// Headless front end: runs the same sweep as the GUI's "Run all" and streams the
+// log to stdout. Exit code 0 = every validation passed, 1 = a validation failed,
+// 2 = bad arguments or the sweep could not start.
+#include "orchestration.h"
+#include "experiment.h"
+#include "microbench.h"
+#include "result_binary.h"
+#include "result_bitmap.h"
+#include "fileio.h"
+#include "platform.h"
+#include <cstdio>
+#include <cwchar>
+#include <string>
+#include <vector>
+
+namespace {
+    const int kExitPassed = 0;
+    const int kExitValidationFailed = 1;
+    const int kExitUsage = 2;
+    const uint32_t kFormatBenchValues = 4000000;
+
+    // Log text is written for the GUI's edit control (\r\n); stdout gets UTF-8 with \n
+    class ConsoleSink : public Orchestration::ProgressSink {
+    public:
+        void Log(const std::wstring& message) override {
+            std::wstring text;
+            text.reserve(message.size());
+            for (wchar_t c : message) {
+                if (c != L'\r') text += c;
+            }
+            std::string utf8 = Platform::ToUtf8(text);
+            fwrite(utf8.data(), 1, utf8.size(), stdout);
+            fflush(stdout);
+        }
+    };
+
+    void PrintUsage() {
+        fputs(
+            "Usage: TEMA6Cli --input <file> [options]\n"
+            "       TEMA6Cli --spec <file.ini> [--output <dir>] [--dry-run]\n"
+            "       TEMA6Cli --bench-format    result formatting microbenchmark\n"
+            "       TEMA6Cli --convert <file.bin> [--encoding utf16|utf8]\n"
+            "       TEMA6Cli --convert <file.bits> --input <file> [--encoding utf16|utf8]\n"
+            "  --input <file>      binary file of uint32 values (required)\n"
+            "  --t <list>          T values, comma separated (default 50)\n"
+            "  --workers <a-b|n>   worker counts to sweep (default 1-2P)\n"
+            "  --methods <list>    any of seq,static,dynamic,stdpar,openmp (default seq,static,dynamic;\n"
+            "                      stdpar and openmp both run the std::execution and OpenMP backends)\n"
+            "  --reps <n>          runs per method and point, fastest reported (default 1)\n"
+            "  --output <dir>      results root, gets static/, dinamic/, ... (default built-in path)\n"
+            "  --pin <policy>      none|compact|scatter|smt-last (default none)\n"
+            "  --wait <policy>     block|spin-then-yield|spin (default block)\n"
+            "  --buffer <KiB>      per-worker output buffer, 0 = one write per value (default 1024)\n"
+            "  --encoding <enc>    result files: utf16 (default, original format), utf8,\n"
+            "                      bin32 (packed uint32), bindelta (delta + varint) or\n"
+            "                      bitmap (one bit per input value)\n"
+            "  --segments <mode>   static/dynamic worker output: temp (default, temp files then\n"
+            "                      a merge) or direct (kept in memory, written in place)\n"
+            "  --writers <n>       static/dynamic with temp segments: n threads write the full\n"
+            "                      worker buffers while workers compute (default 0, workers write)\n"
+            "  --writer-queue <n>  full buffers that may wait for those threads before a worker\n"
+            "                      has to (default 0 = one per worker)\n"
+            "  --writer-backend <b>\n"
+            "                      threads (default) or uring: one thread hands the blocks to\n"
+            "                      io_uring in batches (Linux; elsewhere falls back to threads)\n"
+            "  --uncached          result blocks bypass the page cache (O_DIRECT / NO_BUFFERING),\n"
+            "                      result files of known size are preallocated\n"
+            "  --convert <file>    write a binary result as text next to it (<name>.txt);\n"
+            "                      a .bits bitmap also needs the --input it was made from\n"
+            "  --spec <file>       run an experiment matrix instead (see experiment.h for the format)\n"
+            "  --dry-run           with --spec: print the plan and its estimated run time only\n"
+            "Exit code: 0 all validations passed, 1 a validation failed, 2 usage or setup error\n",
+            stderr);
+    }
+
+    bool ParseUInt(const std::wstring& s, uint32_t& out) {
+        if (s.empty()) return false;
+        wchar_t* end = nullptr;
+        unsigned long v = std::wcstoul(s.c_str(), &end, 10);
+        if (*end != L'\0' || v > 0xFFFFFFFFul) return false;
+        out = (uint32_t)v;
+        return true;
+    }
+
+    std::vector<std::wstring> Split(const std::wstring& s, wchar_t sep) {
+        std::vector<std::wstring> parts;
+        size_t start = 0;
+        for (;;) {
+            size_t pos = s.find(sep, start);
+            parts.push_back(s.substr(start, pos == std::wstring::npos ? std::wstring::npos : pos - start));
+            if (pos == std::wstring::npos) break;
+            start = pos + 1;
+        }
+        return parts;
+    }
+
+    bool ParseWorkers(const std::wstring& s, uint32_t& lo, uint32_t& hi) {
+        size_t dash = s.find(L'-');
+        if (dash == std::wstring::npos) {
+            if (!ParseUInt(s, hi)) return false;
+            lo = hi;
+        }
+        else if (!ParseUInt(s.substr(0, dash), lo) || !ParseUInt(s.substr(dash + 1), hi)) {
+            return false;
+        }
+        return lo >= 1 && lo <= hi;
+    }
+
+    bool ParseMethods(const std::wstring& s, Orchestration::TestConfig& config) {
+        config.runSequential = config.runStatic = config.runDynamic = config.runtimeBackends = false;
+        for (const std::wstring& m : Split(s, L',')) {
+            if (m == L"seq" || m == L"sequential") config.runSequential = true;
+            else if (m == L"static") config.runStatic = true;
+            else if (m == L"dynamic") config.runDynamic = true;
+            else if (m == L"stdpar" || m == L"openmp") config.runtimeBackends = true;   // one switch in the engine
+            else return false;
+        }
+        return true;
+    }
+
+    bool ParsePin(const std::wstring& s, Topology::PinPolicy& out) {
+        const Topology::PinPolicy all[] = { Topology::PinPolicy::None, Topology::PinPolicy::Compact,
+            Topology::PinPolicy::Scatter, Topology::PinPolicy::SmtLast };
+        for (Topology::PinPolicy p : all) {
+            if (s == Topology::PolicyName(p)) { out = p; return true; }
+        }
+        return false;
+    }
+
+    bool ParseEncoding(const std::wstring& s, FileIO::ResultEncoding& out) {
+        const FileIO::ResultEncoding all[] = { FileIO::ResultEncoding::Utf16, FileIO::ResultEncoding::Utf8,
+            FileIO::ResultEncoding::Packed32, FileIO::ResultEncoding::DeltaVarint, FileIO::ResultEncoding::Bitmap };
+        for (FileIO::ResultEncoding e : all) {
+            if (s == FileIO::EncodingName(e)) { out = e; return true; }
+        }
+        return false;
+    }
+
+    bool ParseSegments(const std::wstring& s, ResultWriter::SegmentMode& out) {
+        const ResultWriter::SegmentMode all[] = { ResultWriter::SegmentMode::TempFiles, ResultWriter::SegmentMode::Direct };
+        for (ResultWriter::SegmentMode m : all) {
+            if (s == ResultWriter::SegmentModeName(m)) { out = m; return true; }
+        }
+        return false;
+    }
+
+    bool ParseWriterBackend(const std::wstring& s, AsyncWriter::Backend& out) {
+        const AsyncWriter::Backend all[] = { AsyncWriter::Backend::Threads, AsyncWriter::Backend::IoUring };
+        for (AsyncWriter::Backend b : all) {
+            if (s == AsyncWriter::BackendName(b)) { out = b; return true; }
+        }
+        return false;
+    }
+
+    bool ParseWait(const std::wstring& s, Sync::WaitPolicy& out) {
+        const Sync::WaitPolicy all[] = { Sync::WaitPolicy::Block, Sync::WaitPolicy::SpinThenYield, Sync::WaitPolicy::Spin };
+        for (Sync::WaitPolicy p : all) {
+            if (s == Sync::WaitPolicyName(p)) { out = p; return true; }
+        }
+        return false;
+    }
+
+    int RunCli(const std::vector<std::wstring>& args) {
+        Orchestration::TestConfig config;
+        config.tValues.clear();
+        config.maxWorkers = 2 * Orchestration::GetPhysicalCoreCount();
+
+        std::wstring specPath;
+        std::wstring convertPath;
+        bool dryRun = false;
+
+        for (size_t i = 0; i < args.size(); i++) {
+            const std::wstring& opt = args[i];
+            if (opt == L"--help" || opt == L"-h") {
+                PrintUsage();
+                return kExitPassed;
+            }
+            if (opt == L"--dry-run") {
+                dryRun = true;
+                continue;
+            }
+            if (opt == L"--uncached") {
+                config.uncachedOutput = true;
+                continue;
+            }
+            if (opt == L"--bench-format") {
+                ConsoleSink().Log(MicroBench::DecimalFormatReport(kFormatBenchValues));
+                return kExitPassed;
+            }
+
+            if (i + 1 >= args.size()) {
+                fprintf(stderr, "Missing value for %s\n", Platform::ToUtf8(opt).c_str());
+                return kExitUsage;
+            }
+            const std::wstring& val = args[++i];
+
+            bool ok = true;
+            if (opt == L"--input") {
+                config.inputFilePath = val;
+            }
+            else if (opt == L"--t") {
+                for (const std::wstring& t : Split(val, L',')) {
+                    uint32_t T = 0;
+                    if (!ParseUInt(t, T)) { ok = false; break; }
+                    config.tValues.push_back(T);
+                }
+            }
+            else if (opt == L"--workers") ok = ParseWorkers(val, config.minWorkers, config.maxWorkers);
+            else if (opt == L"--methods") ok = ParseMethods(val, config);
+            else if (opt == L"--reps") ok = ParseUInt(val, config.repetitions) && config.repetitions >= 1;
+            else if (opt == L"--output") config.outputDir = val;
+            else if (opt == L"--spec") specPath = val;
+            else if (opt == L"--pin") ok = ParsePin(val, config.pinPolicy);
+            else if (opt == L"--wait") ok = ParseWait(val, config.waitPolicy);
+            else if (opt == L"--buffer") {
+                uint32_t kib = 0;
+                ok = ParseUInt(val, kib) && ((size_t)kib << 10) <= ResultWriter::kMaxBufferBytes;
+                if (ok) config.outputBufferBytes = (size_t)kib << 10;
+            }
+            else if (opt == L"--encoding") ok = ParseEncoding(val, config.outputEncoding);
+            else if (opt == L"--segments") ok = ParseSegments(val, config.segmentMode);
+            else if (opt == L"--writers") ok = ParseUInt(val, config.writerThreads) && config.writerThreads <= 64;
+            else if (opt == L"--writer-queue") ok = ParseUInt(val, config.writerQueue) && config.writerQueue <= 4096;
+            else if (opt == L"--writer-backend") ok = ParseWriterBackend(val, config.writerBackend);
+            else if (opt == L"--convert") convertPath = val;
+            else {
+                fprintf(stderr, "Unknown option %s\n", Platform::ToUtf8(opt).c_str());
+                PrintUsage();
+                return kExitUsage;
+            }
+
+            if (!ok) {
+                fprintf(stderr, "Invalid value for %s: %s\n", Platform::ToUtf8(opt).c_str(), Platform::ToUtf8(val).c_str());
+                return kExitUsage;
+            }
+        }
+
+        if (!convertPath.empty()) {
+            std::wstring textPath, err;
+            uint64_t values = 0;
+            const std::wstring bitsExt = FileIO::ResultExtension(FileIO::ResultEncoding::Bitmap);
+            bool isBitmap = convertPath.size() > bitsExt.size() &&
+                convertPath.compare(convertPath.size() - bitsExt.size(), bitsExt.size(), bitsExt) == 0;
+            if (isBitmap && config.inputFilePath.empty()) {
+                fprintf(stderr, "%s: a bitmap result needs --input (the values it indexes)\n", Platform::ToUtf8(convertPath).c_str());
+                return kExitUsage;
+            }
+            bool ok = isBitmap
+                ? ResultBitmap::ExpandToText(convertPath, config.inputFilePath, textPath, config.outputEncoding, values, err)
+                : ResultBinary::ConvertToText(convertPath, textPath, config.outputEncoding, values, err);
+            if (!ok) {
+                fprintf(stderr, "%s: %s\n", Platform::ToUtf8(convertPath).c_str(), Platform::ToUtf8(err).c_str());
+                return kExitUsage;
+            }
+            printf("%llu values -> %s\n", (unsigned long long)values, Platform::ToUtf8(textPath).c_str());
+            return kExitPassed;
+        }
+
+        if (config.inputFilePath.empty() == specPath.empty() || (dryRun && specPath.empty())) {
+            PrintUsage();
+            return kExitUsage;
+        }
+        if (config.tValues.empty()) config.tValues.push_back(50);
+
+        if (!config.outputDir.empty()) FileIO::SetResultsRoot(config.outputDir);
+        std::wstring err;
+        if (!FileIO::EnsureResultsFolders(err)) {
+            fprintf(stderr, "Failed to create results folders: %s\n", Platform::ToUtf8(err).c_str());
+            return kExitUsage;
+        }
+
+        ConsoleSink sink;
+        Orchestration::TestSummary summary;
+
+        if (!specPath.empty()) {
+            std::vector<Experiment::JobSpec> jobs;
+            if (!Experiment::LoadSpec(specPath, jobs, err)) {
+                fprintf(stderr, "%s\n", Platform::ToUtf8(err).c_str());
+                return kExitUsage;
+            }
+            Experiment::RunPlan plan = Experiment::Expand(jobs);
+
+            if (dryRun) {
+                double estimate_us = 0.0;
+                std::wstring report;
+                sink.Log(Experiment::DescribePlan(plan));
+                if (!Experiment::EstimateRunTime(plan, estimate_us, report, err)) {
+                    fprintf(stderr, "%s\n", Platform::ToUtf8(err).c_str());
+                    return kExitUsage;
+                }
+                sink.Log(report);
+                return kExitPassed;
+            }
+
+            if (!Orchestration::RunExperimentPlan(plan, sink, summary)) return kExitUsage;
+            return summary.totalFailures == 0 ? kExitPassed : kExitValidationFailed;
+        }
+
+        if (!Orchestration::RunTestSuite(config, sink, summary)) return kExitUsage;
+
+        return summary.totalFailures == 0 ? kExitPassed : kExitValidationFailed;
+    }
+}
+
+#ifdef _WIN32
+int wmain(int argc, wchar_t* argv[]) {
+    std::vector<std::wstring> args(argv + 1, argv + argc);
+    return RunCli(args);
+}
+#else
+int main(int argc, char* argv[]) {
+    std::vector<std::wstring> args;
+    for (int i = 1; i < argc; i++) args.push_back(Platform::FromUtf8(argv[i]));
+    return RunCli(args);
+}
+#endif
@@ -31,4 +31,19 @@ namespace Collatz {
         }
         return steps >= T;
     }
-}
+
+    uint32_t CollatzStepsCapped(uint32_t n32, uint32_t cap) {
+        if (n32 <= 1) return 0;
+
+        uint64_t n = n32;
+        uint32_t steps = 0;
+
+        while (n != 1 && steps < cap) {
+            if ((n & 1ULL) == 0ULL) n >>= 1;
+            else n = 3ULL * n + 1ULL;
+
+            steps++;
+        }
+        return steps;
+    }
+}
\ No newline at end of file
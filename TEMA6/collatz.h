@@ -7,4 +7,7 @@ namespace Collatz {
 
     // FAST requirement: check only if Collatz length >= T, early-exit
     bool CollatzAtLeastT(uint32_t n, uint32_t T);
+
+    // Steps taken, stopping at cap (same work CollatzAtLeastT does for T = cap)
+    uint32_t CollatzStepsCapped(uint32_t n, uint32_t cap);
 }
@@ -0,0 +1,103 @@
+#include "cost_model.h"
+#include "collatz.h"
+#include "timing.h"
+#include "platform.h"
+
+namespace CostModel {
+
+    size_t DefaultBlockSize(size_t n) {
+        size_t bs = n / 4096;
+        if (bs < 256) bs = 256;
+        return bs;
+    }
+
+    BlockCosts EstimateBlockCosts(const uint32_t* v, size_t n, uint32_t T,
+        size_t blockSize, uint32_t samplesPerBlock) {
+        BlockCosts bc;
+        if (!v || n == 0) return bc;
+
+        if (blockSize == 0) blockSize = DefaultBlockSize(n);
+        if (samplesPerBlock == 0) samplesPerBlock = 1;
+        bc.blockSize = blockSize;
+
+        Timing::Ticks start = Timing::Now();
+
+        size_t nBlocks = (n + blockSize - 1) / blockSize;
+        bc.cost.resize(nBlocks);
+
+        for (size_t b = 0; b < nBlocks; b++) {
+            size_t first = b * blockSize;
+            size_t len = (first + blockSize <= n) ? blockSize : (n - first);
+
+            size_t samples = samplesPerBlock < len ? samplesPerBlock : len;
+            size_t stride = len / samples;
+
+            double sum = 0.0;
+            for (size_t s = 0; s < samples; s++) {
+                // +1: every element costs at least the call and the threshold test
+                sum += 1.0 + Collatz::CollatzStepsCapped(v[first + s * stride], T);
+            }
+
+            bc.cost[b] = sum * (double)len / (double)samples;
+        }
+
+        Timing::Ticks end = Timing::Now();
+        bc.time_us = Timing::ElapsedMicros(start, end);
+        return bc;
+    }
+
+    std::vector<size_t> BalancedBoundaries(const BlockCosts& costs, size_t n, uint32_t nWorkers,
+        const std::vector<double>* weights) {
+        std::vector<size_t> b(nWorkers + 1, 0);
+        b[nWorkers] = n;
+        if (nWorkers == 0) return b;
+
+        // cumulative share of the total work that ends at worker i
+        std::vector<double> share(nWorkers + 1, 0.0);
+        double sumW = 0.0;
+        for (uint32_t i = 0; i < nWorkers; i++) {
+            double w = (weights && i < weights->size() && (*weights)[i] > 0.0) ? (*weights)[i] : 1.0;
+            sumW += w;
+            share[i + 1] = sumW;
+        }
+        for (uint32_t i = 1; i <= nWorkers; i++) share[i] /= sumW;
+
+        if (costs.cost.empty() || costs.blockSize == 0) {
+            // no model: uniform cost per element
+            for (uint32_t i = 1; i < nWorkers; i++) b[i] = (size_t)(share[i] * (double)n);
+            return b;
+        }
+
+        double total = 0.0;
+        for (double c : costs.cost) total += c;
+
+        // walk blocks once, cutting inside a block by linear interpolation
+        size_t blk = 0;
+        double before = 0.0;   // cost of blocks [0, blk)
+        for (uint32_t i = 1; i < nWorkers; i++) {
+            double target = total * share[i];
+
+            while (blk < costs.cost.size() && before + costs.cost[blk] < target) {
+                before += costs.cost[blk];
+                blk++;
+            }
+
+            size_t cut;
+            if (blk >= costs.cost.size()) {
+                cut = n;
+            }
+            else {
+                size_t first = blk * costs.blockSize;
+                size_t len = (first + costs.blockSize <= n) ? costs.blockSize : (n - first);
+                double frac = costs.cost[blk] > 0.0 ? (target - before) / costs.cost[blk] : 0.0;
+                cut = first + (size_t)(frac * (double)len);
+            }
+
+            if (cut < b[i - 1]) cut = b[i - 1];
+            if (cut > n) cut = n;
+            b[i] = cut;
+        }
+
+        return b;
+    }
+}
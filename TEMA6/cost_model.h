@@ -0,0 +1,27 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <cstddef>
+
+namespace CostModel {
+    struct BlockCosts {
+        size_t blockSize = 0;        // Elements per block (last block may be shorter)
+        std::vector<double> cost;    // Estimated work per block, in Collatz steps
+        double time_us = 0.0;        // Time spent sampling
+    };
+
+    // Block size used when the caller passes 0: ~4096 blocks, at least 256 elements each
+    size_t DefaultBlockSize(size_t n);
+
+    // Sample up to samplesPerBlock evenly spaced elements of every block and scale
+    // their step counts (capped at T, like the real kernel) to the whole block
+    BlockCosts EstimateBlockCosts(const uint32_t* v, size_t n, uint32_t T,
+        size_t blockSize, uint32_t samplesPerBlock);
+
+    // Place nWorkers contiguous ranges so each one gets ~equal estimated cost, or, with
+    // weights, a share proportional to weights[i] (relative throughput of worker i).
+    // Empty costs mean every element costs the same.
+    // Returns nWorkers + 1 boundaries: worker i owns [b[i], b[i + 1]).
+    std::vector<size_t> BalancedBoundaries(const BlockCosts& costs, size_t n, uint32_t nWorkers,
+        const std::vector<double>* weights = nullptr);
+}
@@ -0,0 +1,140 @@
+#include "decimal_format.h"
+#include <bit>
+#include <cstring>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace DecimalFormat {
+
+    static const char kDigitPairs[201] =
+        "0001020304050607080910111213141516171819"
+        "2021222324252627282930313233343536373839"
+        "4041424344454647484950515253545556575859"
+        "6061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+
+    // kPow10[t] is the smallest value with t + 1 digits (0 for t = 0)
+    static const uint32_t kPow10[kMaxDigits] = {
+        0, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+    };
+
+    uint32_t DigitCount(uint32_t x) {
+        // bit length * log10(2), then one compare to fix the rounding
+        uint32_t t = ((32 - (uint32_t)std::countl_zero(x | 1)) * 1233) >> 12;
+        return t + 1 - (x < kPow10[t] ? 1 : 0);
+    }
+
+    template <typename Unit>
+    static size_t FormatDigits(uint32_t x, Unit* out) {
+        size_t len = DigitCount(x);
+        Unit* p = out + len;
+        while (x >= 100) {
+            const char* pair = kDigitPairs + (x % 100) * 2;
+            x /= 100;
+            p -= 2;
+            p[0] = (Unit)pair[0];
+            p[1] = (Unit)pair[1];
+        }
+        if (x >= 10) {
+            p[-2] = (Unit)kDigitPairs[x * 2];
+            p[-1] = (Unit)kDigitPairs[x * 2 + 1];
+        }
+        else {
+            p[-1] = (Unit)('0' + x);
+        }
+        return len;
+    }
+
+    size_t FormatU32(uint32_t x, char* out) { return FormatDigits(x, out); }
+    size_t FormatU32(uint32_t x, char16_t* out) { return FormatDigits(x, out); }
+
+#if defined(__AVX2__)
+    // x / 10 in each 32-bit lane: (x * 0xCCCCCCCD) >> 35 is exact for every uint32,
+    // done as two 32x32->64 multiplies (even lanes, then odd lanes)
+    static inline __m256i Div10(__m256i x) {
+        const __m256i magic = _mm256_set1_epi64x(0xCCCCCCCDll);
+        __m256i even = _mm256_srli_epi64(_mm256_mul_epu32(x, magic), 35);
+        __m256i odd = _mm256_srli_epi64(_mm256_mul_epu32(_mm256_srli_epi64(x, 32), magic), 35);
+        return _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+    }
+
+    // All ten digits of eight values, as ASCII text right-aligned in 16-byte rows
+    // (row bytes 6..15). Each lane collects its digits into three little-endian words.
+    // rows has a spare row so a fixed ten-byte copy may run past the last one.
+    static void DigitRows8(const uint32_t* values, char rows[kBatch + 1][16]) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values));
+        __m256i low = _mm256_setzero_si256(), mid = _mm256_setzero_si256(), high = _mm256_setzero_si256();
+        const __m256i ten = _mm256_set1_epi32(10);
+
+        for (int k = 0; k < (int)kMaxDigits; k++) {
+            __m256i q = Div10(x);
+            __m256i d = _mm256_sub_epi32(x, _mm256_mullo_epi32(q, ten));
+            x = q;
+            // digit k (from the right) lands at row byte 15 - k
+            if (k < 4) low = _mm256_or_si256(low, _mm256_sllv_epi32(d, _mm256_set1_epi32(8 * (3 - k))));
+            else if (k < 8) mid = _mm256_or_si256(mid, _mm256_sllv_epi32(d, _mm256_set1_epi32(8 * (7 - k))));
+            else high = _mm256_or_si256(high, _mm256_sllv_epi32(d, _mm256_set1_epi32(8 * (9 - k))));
+        }
+        low = _mm256_add_epi32(low, _mm256_set1_epi32(0x30303030));
+        mid = _mm256_add_epi32(mid, _mm256_set1_epi32(0x30303030));
+        high = _mm256_add_epi32(high, _mm256_set1_epi32(0x3030));
+
+        alignas(32) uint32_t lowWords[kBatch], midWords[kBatch], highWords[kBatch];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lowWords), low);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(midWords), mid);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(highWords), high);
+        for (size_t i = 0; i < kBatch; i++) {
+            memcpy(rows[i] + 6, &highWords[i], 2);
+            memcpy(rows[i] + 8, &midWords[i], 4);
+            memcpy(rows[i] + 12, &lowWords[i], 4);
+        }
+    }
+
+    template <typename Unit>
+    static size_t FormatListImpl(const uint32_t* values, size_t n, bool leadingComma, Unit* out) {
+        Unit* p = out;
+        size_t i = 0;
+        for (; i + kBatch <= n; i += kBatch) {
+            char rows[kBatch + 1][16];
+            DigitRows8(values + i, rows);
+            for (size_t j = 0; j < kBatch; j++) {
+                if (leadingComma || i + j > 0) *p++ = (Unit)',';
+                // always copy ten units and advance by the digit count: no data-dependent
+                // loop, and the overshoot stays within ListCapacity (later text overwrites it)
+                size_t len = DigitCount(values[i + j]);
+                const char* digits = rows[j] + 16 - len;
+                for (size_t k = 0; k < kMaxDigits; k++) p[k] = (Unit)digits[k];
+                p += len;
+            }
+        }
+        for (; i < n; i++) {
+            if (leadingComma || i > 0) *p++ = (Unit)',';
+            p += FormatDigits(values[i], p);
+        }
+        return (size_t)(p - out);
+    }
+
+    const wchar_t* ListPathName() { return L"AVX2"; }
+#else
+    template <typename Unit>
+    static size_t FormatListImpl(const uint32_t* values, size_t n, bool leadingComma, Unit* out) {
+        Unit* p = out;
+        for (size_t i = 0; i < n; i++) {
+            if (leadingComma || i > 0) *p++ = (Unit)',';
+            p += FormatDigits(values[i], p);
+        }
+        return (size_t)(p - out);
+    }
+
+    const wchar_t* ListPathName() { return L"scalar"; }
+#endif
+
+    size_t FormatList(const uint32_t* values, size_t n, bool leadingComma, char* out) {
+        return FormatListImpl(values, n, leadingComma, out);
+    }
+
+    size_t FormatList(const uint32_t* values, size_t n, bool leadingComma, char16_t* out) {
+        return FormatListImpl(values, n, leadingComma, out);
+    }
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+namespace DecimalFormat {
+    constexpr size_t kMaxDigits = 10;               // 4294967295
+    constexpr size_t kBatch = 8;                    // values per FormatList SIMD step
+
+    // Units FormatList may write for n values (digits plus separators)
+    constexpr size_t ListCapacity(size_t n) { return n * (kMaxDigits + 1); }
+
+    uint32_t DigitCount(uint32_t x);
+
+    // Plain decimal digits of x, no terminator; returns the count. Digit pairs come
+    // from a 200-byte table, so there is one divide by 100 per two digits and no
+    // locale or format-string work. char is ASCII (and so UTF-8), char16_t is UTF-16.
+    size_t FormatU32(uint32_t x, char* out);
+    size_t FormatU32(uint32_t x, char16_t* out);
+
+    // "a,b,c" (",a,b,c" when leadingComma) for n values; returns the units written,
+    // at most ListCapacity(n). Built with AVX2 (/arch:AVX2, -mavx2) the digits of eight
+    // values are produced per step in vector lanes; otherwise FormatU32 per value.
+    size_t FormatList(const uint32_t* values, size_t n, bool leadingComma, char* out);
+    size_t FormatList(const uint32_t* values, size_t n, bool leadingComma, char16_t* out);
+
+    // "AVX2" or "scalar": which FormatList this build uses
+    const wchar_t* ListPathName();
+}
@@ -0,0 +1,530 @@
+#include "experiment.h"
+#include "orchestration.h"
+#include "fileio.h"
+#include "collatz.h"
+#include "timing.h"
+#include "platform.h"
+#include <algorithm>
+#include <map>
+#include <tuple>
+#include <thread>
+#include <sstream>
+#include <iomanip>
+#include <fstream>
+#include <filesystem>
+
+namespace Experiment {
+
+    static constexpr size_t kEstimateSamples = 65536;   // values sampled per (input, T)
+    static constexpr uint32_t kHitCalibration = 4096;   // formatted writes timed for the per-hit cost
+    static constexpr uint32_t kMaxSpecWorkers = 4096;   // largest worker count a spec may ask for
+
+    std::vector<uint32_t> DefaultTValues() {
+        return { 5, 10, 50, 100, 500, 1000, 1500 };
+    }
+
+    const wchar_t* MethodName(Method method) {
+        switch (method) {
+        case Method::Sequential: return L"seq";
+        case Method::Static: return L"static";
+        case Method::Dynamic: return L"dynamic";
+        case Method::StdPar: return L"stdpar";
+        case Method::OpenMP: return L"openmp";
+        default: return L"unknown";
+        }
+    }
+
+    const wchar_t* StaticSplitName(StaticSplit split) {
+        switch (split) {
+        case StaticSplit::Equal: return L"equal";
+        case StaticSplit::Cost: return L"cost";
+        default: return L"unknown";
+        }
+    }
+
+    static std::string Trim(const std::string& s) {
+        size_t first = s.find_first_not_of(" \t\r");
+        if (first == std::string::npos) return std::string();
+        size_t last = s.find_last_not_of(" \t\r");
+        return s.substr(first, last - first + 1);
+    }
+
+    static std::vector<std::wstring> SplitList(const std::string& value) {
+        std::vector<std::wstring> items;
+        std::stringstream ss(value);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            item = Trim(item);
+            if (!item.empty()) items.push_back(Platform::FromUtf8(item));
+        }
+        return items;
+    }
+
+    // digits only: wcstoul would also take a sign or leading blanks, and "-1" wraps
+    static bool ParseCount(const std::wstring& s, uint32_t& out) {
+        if (s.empty() || s.find_first_not_of(L"0123456789") != std::wstring::npos) return false;
+        wchar_t* end = nullptr;
+        unsigned long v = std::wcstoul(s.c_str(), &end, 10);
+        if (*end != L'\0' || v > 0xFFFFFFFFul) return false;
+        out = (uint32_t)v;
+        return true;
+    }
+
+    // "8", "P", "2P"
+    static bool ParseWorkerCount(const std::wstring& s, uint32_t P, uint32_t& out) {
+        if (!s.empty() && (s.back() == L'P' || s.back() == L'p')) {
+            uint32_t k = 1;
+            if (s.size() > 1 && !ParseCount(s.substr(0, s.size() - 1), k)) return false;
+            if ((uint64_t)k * P > 0xFFFFFFFFull) return false;
+            out = k * P;
+            return true;
+        }
+        return ParseCount(s, out);
+    }
+
+    // Named value lookup shared by methods, policies, ... (names as the modules print them)
+    template <typename E, typename NameFn>
+    static bool ParseNames(const std::vector<std::wstring>& items, const std::vector<E>& all, NameFn name, std::vector<E>& out) {
+        out.clear();
+        for (const std::wstring& item : items) {
+            auto it = std::find_if(all.begin(), all.end(), [&](E e) { return item == name(e); });
+            if (it == all.end()) return false;
+            if (std::find(out.begin(), out.end(), *it) == out.end()) out.push_back(*it);
+        }
+        return !out.empty();
+    }
+
+    static bool ApplyKey(JobSpec& job, const std::string& key, const std::string& value, std::wstring& err) {
+        std::vector<std::wstring> items = SplitList(value);
+        if (items.empty()) {
+            err = L"empty value";
+            return false;
+        }
+
+        if (key == "input") {
+            job.inputs.insert(job.inputs.end(), items.begin(), items.end());
+        }
+        else if (key == "t") {
+            job.tValues.clear();
+            for (const std::wstring& item : items) {
+                uint32_t T = 0;
+                if (!ParseCount(item, T) || T == 0) { err = L"bad T value '" + item + L"' (1 or more)"; return false; }
+                job.tValues.push_back(T);
+            }
+        }
+        else if (key == "workers") {
+            const uint32_t P = Orchestration::GetPhysicalCoreCount();
+            job.workers.clear();
+            for (const std::wstring& item : items) {
+                size_t dash = item.find(L'-');
+                uint32_t lo = 0, hi = 0;
+                bool ok = (dash == std::wstring::npos)
+                    ? ParseWorkerCount(item, P, lo) && ParseWorkerCount(item, P, hi)
+                    : ParseWorkerCount(item.substr(0, dash), P, lo) && ParseWorkerCount(item.substr(dash + 1), P, hi);
+                // the cap also keeps the loop below from wrapping at 0xFFFFFFFF
+                if (!ok || lo == 0 || lo > hi || hi > kMaxSpecWorkers) {
+                    err = L"bad worker count '" + item + L"' (1 to " + std::to_wstring(kMaxSpecWorkers) + L")";
+                    return false;
+                }
+                for (uint32_t w = lo; w <= hi; w++) job.workers.push_back(w);
+            }
+            std::sort(job.workers.begin(), job.workers.end());
+            job.workers.erase(std::unique(job.workers.begin(), job.workers.end()), job.workers.end());
+        }
+        else if (key == "methods") {
+            std::vector<std::wstring> names = items;
+            for (std::wstring& n : names) if (n == L"sequential") n = L"seq";
+            const std::vector<Method> all = { Method::Sequential, Method::Static, Method::Dynamic, Method::StdPar, Method::OpenMP };
+            if (!ParseNames(names, all, MethodName, job.methods)) { err = L"unknown method in '" + Platform::FromUtf8(value) + L"'"; return false; }
+        }
+        else if (key == "policies") {
+            if (!ParseNames(items, Scheduling::AllPolicyKinds(), Scheduling::PolicyKindName, job.policies)) {
+                err = L"unknown policy in '" + Platform::FromUtf8(value) + L"'";
+                return false;
+            }
+        }
+        else if (key == "static_split") {
+            const std::vector<StaticSplit> all = { StaticSplit::Equal, StaticSplit::Cost };
+            if (!ParseNames(items, all, StaticSplitName, job.staticSplits)) { err = L"unknown split in '" + Platform::FromUtf8(value) + L"'"; return false; }
+        }
+        else if (key == "omp_schedule") {
+            const std::vector<ParallelBackends::OmpSchedule> all = { ParallelBackends::OmpSchedule::Static,
+                ParallelBackends::OmpSchedule::Dynamic, ParallelBackends::OmpSchedule::Guided };
+            if (!ParseNames(items, all, ParallelBackends::OmpScheduleName, job.ompSchedules)) {
+                err = L"unknown OpenMP schedule in '" + Platform::FromUtf8(value) + L"'";
+                return false;
+            }
+        }
+        else if (key == "reps") {
+            if (items.size() != 1 || !ParseCount(items[0], job.repetitions) || job.repetitions == 0) { err = L"bad repetition count"; return false; }
+        }
+        else if (key == "pin") {
+            std::vector<Topology::PinPolicy> pin;
+            const std::vector<Topology::PinPolicy> all = { Topology::PinPolicy::None, Topology::PinPolicy::Compact,
+                Topology::PinPolicy::Scatter, Topology::PinPolicy::SmtLast };
+            if (items.size() != 1 || !ParseNames(items, all, Topology::PolicyName, pin)) { err = L"bad pin policy"; return false; }
+            job.pinPolicy = pin[0];
+        }
+        else if (key == "wait") {
+            std::vector<Sync::WaitPolicy> wait;
+            const std::vector<Sync::WaitPolicy> all = { Sync::WaitPolicy::Block, Sync::WaitPolicy::SpinThenYield, Sync::WaitPolicy::Spin };
+            if (items.size() != 1 || !ParseNames(items, all, Sync::WaitPolicyName, wait)) { err = L"bad wait policy"; return false; }
+            job.waitPolicy = wait[0];
+        }
+        else if (key == "buffer_kib") {
+            uint32_t kib = 0;
+            if (items.size() != 1 || !ParseCount(items[0], kib) || ((size_t)kib << 10) > ResultWriter::kMaxBufferBytes) {
+                err = L"bad output buffer size (KiB, 0 to " + std::to_wstring(ResultWriter::kMaxBufferBytes >> 10) + L")";
+                return false;
+            }
+            job.outputBufferBytes = (size_t)kib << 10;
+        }
+        else if (key == "encoding") {
+            std::vector<FileIO::ResultEncoding> encoding;
+            const std::vector<FileIO::ResultEncoding> all = { FileIO::ResultEncoding::Utf16, FileIO::ResultEncoding::Utf8,
+                FileIO::ResultEncoding::Packed32, FileIO::ResultEncoding::DeltaVarint, FileIO::ResultEncoding::Bitmap };
+            if (items.size() != 1 || !ParseNames(items, all, FileIO::EncodingName, encoding)) { err = L"bad output encoding"; return false; }
+            job.outputEncoding = encoding[0];
+        }
+        else if (key == "segments") {
+            std::vector<ResultWriter::SegmentMode> mode;
+            const std::vector<ResultWriter::SegmentMode> all = { ResultWriter::SegmentMode::TempFiles, ResultWriter::SegmentMode::Direct };
+            if (items.size() != 1 || !ParseNames(items, all, ResultWriter::SegmentModeName, mode)) { err = L"bad segment mode"; return false; }
+            job.segmentMode = mode[0];
+        }
+        else if (key == "writers") {
+            if (items.size() != 1 || !ParseCount(items[0], job.writerThreads) || job.writerThreads > 64) { err = L"bad writer thread count (0 to 64)"; return false; }
+        }
+        else if (key == "writer_queue") {
+            if (items.size() != 1 || !ParseCount(items[0], job.writerQueue) || job.writerQueue > 4096) { err = L"bad writer queue depth (0 to 4096)"; return false; }
+        }
+        else if (key == "writer_backend") {
+            std::vector<AsyncWriter::Backend> backend;
+            const std::vector<AsyncWriter::Backend> all = { AsyncWriter::Backend::Threads, AsyncWriter::Backend::IoUring };
+            if (items.size() != 1 || !ParseNames(items, all, AsyncWriter::BackendName, backend)) { err = L"bad writer backend"; return false; }
+            job.writerBackend = backend[0];
+        }
+        else if (key == "uncached") {
+            if (items.size() != 1 || (items[0] != L"on" && items[0] != L"off")) { err = L"bad uncached setting (on, off)"; return false; }
+            job.uncachedOutput = items[0] == L"on";
+        }
+        else {
+            err = L"unknown key '" + Platform::FromUtf8(key) + L"'";
+            return false;
+        }
+        return true;
+    }
+
+    static JobSpec DefaultJob() {
+        JobSpec job;
+        job.tValues = DefaultTValues();
+        for (uint32_t w = 1; w <= 2 * Orchestration::GetPhysicalCoreCount(); w++) job.workers.push_back(w);
+        job.methods = { Method::Sequential, Method::Static, Method::Dynamic };
+        job.policies = { Scheduling::PolicyKind::Halving };
+        job.staticSplits = { StaticSplit::Equal };
+        job.ompSchedules = { ParallelBackends::OmpSchedule::Static };
+        return job;
+    }
+
+    bool LoadSpec(const std::wstring& path, std::vector<JobSpec>& jobs, std::wstring& err) {
+        jobs.clear();
+        err.clear();
+
+        std::ifstream f{ std::filesystem::path(path) };
+        if (!f) {
+            err = L"Cannot open experiment spec: " + path;
+            return false;
+        }
+
+        JobSpec defaults = DefaultJob();
+        JobSpec* current = &defaults;
+        std::string line;
+        size_t lineNo = 0;
+        while (std::getline(f, line)) {
+            lineNo++;
+            if (lineNo == 1 && line.compare(0, 3, "\xEF\xBB\xBF") == 0) line.erase(0, 3);
+
+            // comments start a line or follow whitespace, so paths may contain '#' and ';'
+            for (size_t i = 0; i < line.size(); i++) {
+                if ((line[i] == '#' || line[i] == ';') && (i == 0 || line[i - 1] == ' ' || line[i - 1] == '\t')) {
+                    line.erase(i);
+                    break;
+                }
+            }
+            line = Trim(line);
+            if (line.empty()) continue;
+
+            std::wstring where = path + L" line " + std::to_wstring(lineNo) + L": ";
+
+            if (line.front() == '[') {
+                if (line.back() != ']') {
+                    err = where + L"unterminated section";
+                    return false;
+                }
+                std::string section = Trim(line.substr(1, line.size() - 2));
+                if (section == "defaults") {
+                    if (!jobs.empty()) {
+                        err = where + L"[defaults] must come before the jobs";
+                        return false;
+                    }
+                    current = &defaults;
+                    continue;
+                }
+                if (section.compare(0, 3, "job") != 0) {
+                    err = where + L"unknown section [" + Platform::FromUtf8(section) + L"]";
+                    return false;
+                }
+
+                jobs.push_back(defaults);
+                jobs.back().name = Platform::FromUtf8(Trim(section.substr(3)));
+                if (jobs.back().name.empty()) jobs.back().name = L"job" + std::to_wstring(jobs.size());
+                current = &jobs.back();
+                continue;
+            }
+
+            size_t eq = line.find('=');
+            if (eq == std::string::npos) {
+                err = where + L"expected key = value";
+                return false;
+            }
+
+            std::wstring keyErr;
+            if (!ApplyKey(*current, Trim(line.substr(0, eq)), Trim(line.substr(eq + 1)), keyErr)) {
+                err = where + keyErr;
+                return false;
+            }
+        }
+
+        if (jobs.empty()) {
+            err = L"Experiment spec defines no [job] sections: " + path;
+            return false;
+        }
+        for (const JobSpec& job : jobs) {
+            if (job.inputs.empty()) {
+                err = L"Job '" + job.name + L"' has no input";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Sort key: everything that identifies a measurement, in execution order.
+    // Sequential sorts first within a T so its timed run doubles as the reference.
+    static auto PointKey(const RunPoint& p) {
+        return std::make_tuple(p.input, (int)p.pinPolicy, (int)p.waitPolicy, p.outputBufferBytes, (int)p.outputEncoding,
+            (int)p.segmentMode, p.writerThreads, p.writerQueue, (int)p.writerBackend, p.uncachedOutput, p.T,
+            p.method == Method::Sequential ? 0u : p.nWorkers, (int)p.method,
+            (int)p.split, (int)p.policy, (int)p.schedule);
+    }
+
+    RunPlan Expand(const std::vector<JobSpec>& jobs) {
+        RunPlan plan;
+        plan.jobs = jobs;
+
+        std::map<std::wstring, uint32_t> inputIndex;
+        std::map<decltype(PointKey(RunPoint())), size_t> seen;
+
+        auto add = [&](RunPoint p) {
+            auto key = PointKey(p);
+            auto it = seen.find(key);
+            if (it != seen.end()) {
+                RunPoint& existing = plan.points[it->second];
+                if (p.repetitions > existing.repetitions) existing.repetitions = p.repetitions;
+                return;
+            }
+            seen[key] = plan.points.size();
+            plan.points.push_back(p);
+            if (p.nWorkers > plan.maxWorkers) plan.maxWorkers = p.nWorkers;
+        };
+
+        for (uint32_t j = 0; j < jobs.size(); j++) {
+            const JobSpec& job = jobs[j];
+            for (const std::wstring& path : job.inputs) {
+                auto in = inputIndex.find(path);
+                if (in == inputIndex.end()) {
+                    in = inputIndex.emplace(path, (uint32_t)plan.inputs.size()).first;
+                    plan.inputs.push_back(path);
+                }
+
+                RunPoint base{};
+                base.input = in->second;
+                base.job = j;
+                base.repetitions = job.repetitions;
+                base.pinPolicy = job.pinPolicy;
+                base.waitPolicy = job.waitPolicy;
+                base.outputBufferBytes = job.outputBufferBytes;
+                base.outputEncoding = job.outputEncoding;
+                base.segmentMode = job.segmentMode;
+                base.writerThreads = job.writerThreads;
+                base.writerQueue = job.writerQueue;
+                base.writerBackend = job.writerBackend;
+                base.uncachedOutput = job.uncachedOutput;
+                base.split = StaticSplit::Equal;
+                base.policy = Scheduling::PolicyKind::Halving;
+                base.schedule = ParallelBackends::OmpSchedule::Static;
+
+                for (uint32_t T : job.tValues) {
+                    base.T = T;
+                    for (Method m : job.methods) {
+                        base.method = m;
+                        if (m == Method::Sequential) {
+                            RunPoint p = base;
+                            p.nWorkers = 1;
+                            add(p);
+                            continue;
+                        }
+
+                        for (uint32_t w : job.workers) {
+                            RunPoint p = base;
+                            p.nWorkers = w;
+                            if (m == Method::Static) {
+                                for (StaticSplit s : job.staticSplits) { p.split = s; add(p); }
+                            }
+                            else if (m == Method::Dynamic) {
+                                for (Scheduling::PolicyKind k : job.policies) { p.policy = k; add(p); }
+                            }
+                            else if (m == Method::OpenMP) {
+                                for (ParallelBackends::OmpSchedule s : job.ompSchedules) { p.schedule = s; add(p); }
+                            }
+                            else {
+                                add(p);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        std::stable_sort(plan.points.begin(), plan.points.end(),
+            [](const RunPoint& a, const RunPoint& b) { return PointKey(a) < PointKey(b); });
+        return plan;
+    }
+
+    // Microseconds per Collatz step on this machine (same kernel as the calibration task)
+    static double CalibrateStepCost_us() {
+        Timing::Ticks start = Timing::Now();
+        uint64_t steps = 0;
+        for (uint32_t x = 1; x < 200000; x++) steps += Collatz::CollatzStepsCapped(x, 1000);
+        double us = Timing::ElapsedMicros(start, Timing::Now());
+        return steps > 0 ? us / (double)steps : 0.0;
+    }
+
+    // Microseconds per reported value: formatted into a result writer over a results-folder
+    // temp file, the way the runners emit hits. 0 when no temp file can be created.
+    static double CalibrateHitCost_us(size_t bufferBytes, FileIO::ResultEncoding encoding) {
+        std::wstring err;
+        std::wstring path = FileIO::MakeTempPath(FileIO::GetResultsRootPath(), 0, 0, 0, L"estimate");
+        Platform::FileHandle h = Platform::OpenFile(path, Platform::FileMode::Temp, err);
+        if (h == Platform::kInvalidFile) return 0.0;
+
+        ResultWriter::BufferedWriter out;
+        double us = 0.0;
+        // Bitmap writes n bits whatever the hits (Open refuses it): no per-hit cost
+        if (out.Open(h, bufferBytes, encoding, err)) {
+            Timing::Ticks start = Timing::Now();
+            for (uint32_t i = 0; i < kHitCalibration; i++) out.AppendValue(1000000000u + i);
+            out.Close();
+            us = Timing::ElapsedMicros(start, Timing::Now());
+        }
+
+        Platform::CloseFile(h);
+        Platform::RemoveFile(path);
+        return us / kHitCalibration;
+    }
+
+    bool EstimateRunTime(const RunPlan& plan, double& total_us, std::wstring& report, std::wstring& err) {
+        total_us = 0.0;
+        report.clear();
+        err.clear();
+
+        const double stepCost = CalibrateStepCost_us();
+        std::map<std::pair<size_t, FileIO::ResultEncoding>, double> hitCost;   // per output buffer size and encoding in the plan
+        for (const RunPoint& p : plan.points) {
+            auto key = std::make_pair(p.outputBufferBytes, p.outputEncoding);
+            if (hitCost.find(key) == hitCost.end()) hitCost[key] = CalibrateHitCost_us(p.outputBufferBytes, p.outputEncoding);
+        }
+        unsigned int cpus = std::thread::hardware_concurrency();
+        if (cpus == 0) cpus = 1;
+
+        std::wstringstream out;
+        for (uint32_t input = 0; input < plan.inputs.size(); input++) {
+            FileIO::MappedFile mf;
+            if (!FileIO::MapBinaryUInt32File(plan.inputs[input], mf, err)) {
+                err = plan.inputs[input] + L": " + err;
+                return false;
+            }
+
+            // Sequential cost of each T for this input, from an evenly spaced sample
+            std::map<uint32_t, double> computeCost, hitCount;
+            size_t stride = mf.count > kEstimateSamples ? mf.count / kEstimateSamples : 1;
+            double inputTotal = 0.0;
+            size_t points = 0;
+
+            for (const RunPoint& p : plan.points) {
+                if (p.input != input) continue;
+
+                if (computeCost.find(p.T) == computeCost.end()) {
+                    uint64_t steps = 0, hits = 0, sampled = 0;
+                    for (size_t i = 0; i < mf.count; i += stride) {
+                        uint32_t s = Collatz::CollatzStepsCapped(mf.data[i], p.T);
+                        steps += s;
+                        if (p.T == 0 || (mf.data[i] > 1 && s >= p.T)) hits++;
+                        sampled++;
+                    }
+                    double scale = (double)mf.count / (double)sampled;
+                    computeCost[p.T] = (double)steps * scale * stepCost;
+                    hitCount[p.T] = (double)hits * scale;
+
+                    // reference pass when no sequential point precedes this T
+                    if (p.method != Method::Sequential) inputTotal += computeCost[p.T];
+                }
+
+                double run_us = computeCost[p.T] + hitCount[p.T] * hitCost[std::make_pair(p.outputBufferBytes, p.outputEncoding)];
+                if (p.method != Method::Sequential) run_us /= (double)(p.nWorkers < cpus ? p.nWorkers : cpus);
+                inputTotal += run_us * p.repetitions;
+                points++;
+            }
+
+            FileIO::UnmapFile(mf);
+            out << L"  " << plan.inputs[input] << L": " << points << L" runs, ~" << Timing::FormatMicros(inputTotal) << L"\r\n";
+            total_us += inputTotal;
+        }
+
+        out << L"Estimated run time: ~" << Timing::FormatMicros(total_us)
+            << L" (" << std::fixed << std::setprecision(2) << (stepCost * 1000.0) << L" ns/step, "
+            << L"ns/reported value:";
+        for (const auto& hc : hitCost) {
+            out << L" " << (hc.second * 1000.0) << L" at " << (hc.first.first >> 10) << L" KiB "
+                << FileIO::EncodingName(hc.first.second);
+        }
+        out << L", " << cpus << L" CPUs)\r\n";
+        report = out.str();
+        return true;
+    }
+
+    std::wstring DescribePlan(const RunPlan& plan) {
+        std::wstringstream ss;
+        ss << L"Experiment plan: " << plan.jobs.size() << L" job(s), " << plan.inputs.size() << L" input(s), "
+            << plan.points.size() << L" runs, up to " << plan.maxWorkers << L" workers\r\n";
+
+        for (const JobSpec& job : plan.jobs) {
+            ss << L"  [" << job.name << L"] T:";
+            for (uint32_t T : job.tValues) ss << L" " << T;
+            ss << L"; workers " << job.workers.front() << L".." << job.workers.back()
+                << L" (" << job.workers.size() << L"); methods:";
+            for (Method m : job.methods) ss << L" " << MethodName(m);
+            ss << L"; reps " << job.repetitions << L"; pin " << Topology::PolicyName(job.pinPolicy)
+                << L"; wait " << Sync::WaitPolicyName(job.waitPolicy)
+                << L"; buffer " << (job.outputBufferBytes >> 10) << L" KiB; " << FileIO::EncodingName(job.outputEncoding)
+                << L"; segments " << ResultWriter::SegmentModeName(job.segmentMode);
+            if (job.writerThreads) {
+                ss << L"; writers " << job.writerThreads << L" (queue "
+                    << (job.writerQueue ? std::to_wstring(job.writerQueue) : std::wstring(L"1/worker")) << L", "
+                    << AsyncWriter::BackendName(job.writerBackend) << L")";
+            }
+            if (job.uncachedOutput) ss << L"; uncached";
+            ss << L"\r\n";
+        }
+        return ss.str();
+    }
+}
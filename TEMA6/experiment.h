@@ -0,0 +1,106 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "topology.h"
+#include "sync_wait.h"
+#include "scheduling_policy.h"
+#include "parallel_backends.h"
+#include "result_writer.h"
+
+namespace Experiment {
+    enum class Method {
+        Sequential,
+        Static,     // one run per StaticSplit
+        Dynamic,    // one run per Scheduling::PolicyKind
+        StdPar,
+        OpenMP      // one run per ParallelBackends::OmpSchedule
+    };
+
+    enum class StaticSplit {
+        Equal,      // equal element counts
+        Cost        // boundaries from the sampled cost model
+    };
+
+    // One [job] section of a spec, with [defaults] applied
+    struct JobSpec {
+        std::wstring name;
+        std::vector<std::wstring> inputs;
+        std::vector<uint32_t> tValues;
+        std::vector<uint32_t> workers;      // explicit worker counts, ascending
+        std::vector<Method> methods;
+        std::vector<Scheduling::PolicyKind> policies;
+        std::vector<StaticSplit> staticSplits;
+        std::vector<ParallelBackends::OmpSchedule> ompSchedules;
+        uint32_t repetitions = 1;
+        Topology::PinPolicy pinPolicy = Topology::PinPolicy::None;
+        Sync::WaitPolicy waitPolicy = Sync::WaitPolicy::Block;
+        size_t outputBufferBytes = ResultWriter::kDefaultBufferBytes;
+        FileIO::ResultEncoding outputEncoding = FileIO::ResultEncoding::Utf16;
+        ResultWriter::SegmentMode segmentMode = ResultWriter::SegmentMode::TempFiles;
+        uint32_t writerThreads = 0;
+        uint32_t writerQueue = 0;           // 0 = one block per worker
+        AsyncWriter::Backend writerBackend = AsyncWriter::Backend::Threads;
+        bool uncachedOutput = false;
+    };
+
+    // One timed measurement. Only the variant field of its method is meaningful.
+    struct RunPoint {
+        uint32_t input;         // index into RunPlan::inputs
+        uint32_t job;           // index into RunPlan::jobs (first job that asked for it)
+        uint32_t T;
+        uint32_t nWorkers;      // 1 for Sequential
+        Method method;
+        StaticSplit split;
+        Scheduling::PolicyKind policy;
+        ParallelBackends::OmpSchedule schedule;
+        uint32_t repetitions;
+        Topology::PinPolicy pinPolicy;
+        Sync::WaitPolicy waitPolicy;
+        size_t outputBufferBytes;   // per-worker result buffer, 0 = one write per value
+        FileIO::ResultEncoding outputEncoding;
+        ResultWriter::SegmentMode segmentMode;  // static and dynamic only
+        uint32_t writerThreads;                 // static and dynamic only
+        uint32_t writerQueue;
+        AsyncWriter::Backend writerBackend;
+        bool uncachedOutput;                    // seq, static and dynamic
+    };
+
+    struct RunPlan {
+        std::vector<JobSpec> jobs;
+        std::vector<std::wstring> inputs;   // distinct input files
+        std::vector<RunPoint> points;       // in execution order
+        uint32_t maxWorkers = 0;
+    };
+
+    // T values offered by the GUI and used when a spec gives none
+    std::vector<uint32_t> DefaultTValues();
+
+    const wchar_t* MethodName(Method method);
+    const wchar_t* StaticSplitName(StaticSplit split);
+
+    // Read an INI-style spec:
+    //   [defaults]            keys here apply to every [job ...] that follows
+    //   [job <name>]          one job; needs at least one input
+    //   key = a, b, c         comma separated lists, '#' or ';' starts a comment
+    // Keys: input, t, workers (e.g. 1-2P, 1,2,4,8, P = physical cores), methods (seq,
+    // static, dynamic, stdpar, openmp), policies, static_split (equal, cost),
+    // omp_schedule, reps, pin, wait, buffer_kib (0 = one write per value), encoding (utf16, utf8,
+    // bin32, bindelta, bitmap), segments (temp, direct), writers (0 = workers write),
+    // writer_queue (0 = one block per worker), writer_backend (threads, uring),
+    // uncached (on, off: result blocks bypass the page cache, known sizes preallocated).
+    bool LoadSpec(const std::wstring& path, std::vector<JobSpec>& jobs, std::wstring& err);
+
+    // Cross product of every job, duplicates dropped (highest repetitions kept), ordered
+    // input -> pin/wait -> T -> worker count -> method so each input is mapped once, the
+    // reference count is taken once per (input, T) and the pool is re-placed rarely.
+    RunPlan Expand(const std::vector<JobSpec>& jobs);
+
+    // Predicted wall time of the whole plan: maps every input once, samples the Collatz
+    // cost and hit rate per T and prices both with a short calibration on this machine.
+    // report gets one line per input and the total. Not part of any timed run.
+    bool EstimateRunTime(const RunPlan& plan, double& total_us, std::wstring& report, std::wstring& err);
+
+    // Job list and point counts, for the log before the plan runs
+    std::wstring DescribePlan(const RunPlan& plan);
+}
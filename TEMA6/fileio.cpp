@@ -1,98 +1,51 @@
 #include "fileio.h"
+#ifdef _WIN32
 #include <windows.h>
 #include "security.h"
+#else
+#include <unistd.h>
+#include <climits>
+#endif
 #include <vector>
 #include <sstream>
 
 using namespace std;
 
-extern std::wstring GetLastErrorMessage(DWORD err);
-
 namespace FileIO {
+    static const std::wstring kSep(1, Platform::kPathSep);
+#ifdef _WIN32
     static const std::wstring kBaseFolder = L"E:\\Facultate\\CSSO\\FinalWeek";
-    static const std::wstring kResultsFolder = kBaseFolder + L"\\rezultate";
-    static const std::wstring kInfoFilePath = kBaseFolder + L"\\info.txt";
+#else
+    static const std::wstring kBaseFolder = L"FinalWeek";   // relative to the working directory
+#endif
+    static std::wstring g_resultsFolder = kBaseFolder + kSep + L"rezultate";
+    static const std::wstring kInfoFilePath = kBaseFolder + kSep + L"info.txt";
 
     bool MapBinaryUInt32File(const std::wstring& path, MappedFile& out, std::wstring& err) {
         out = MappedFile();
         err.clear();
 
-        out.hFile = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
-        if (out.hFile == INVALID_HANDLE_VALUE) {
-            err = L"Failed to open file: " + GetLastErrorMessage(GetLastError());
-            return false;
-        }
+        if (!Platform::MapReadOnly(path, out.region, err)) return false;
 
-        LARGE_INTEGER fileSize;
-        if (!GetFileSizeEx(out.hFile, &fileSize)) {
-            err = L"Failed to get file size: " + GetLastErrorMessage(GetLastError());
-            CloseHandle(out.hFile);
-            out.hFile = INVALID_HANDLE_VALUE;
-            return false;
-        }
-
-        if (fileSize.QuadPart == 0) {
-            err = L"File is empty";
-            CloseHandle(out.hFile);
-            out.hFile = INVALID_HANDLE_VALUE;
-            return false;
-        }
-
-        if (fileSize.QuadPart > SIZE_MAX) {
-            err = L"File is too large";
-            CloseHandle(out.hFile);
-            out.hFile = INVALID_HANDLE_VALUE;
-            return false;
-        }
-
-        out.bytes = static_cast<size_t>(fileSize.QuadPart);
+        out.bytes = out.region.bytes;
 
         if (out.bytes % sizeof(uint32_t) != 0) {
             std::wstringstream ss;
             ss << L"File size (" << out.bytes << L" bytes) is not a multiple of 4";
             err = ss.str();
-            CloseHandle(out.hFile);
-            out.hFile = INVALID_HANDLE_VALUE;
+            Platform::Unmap(out.region);
+            out.bytes = 0;
             return false;
         }
 
-        out.hMap = CreateFileMappingW(out.hFile, NULL, PAGE_READONLY, 0, 0, NULL);
-        if (out.hMap == NULL) {
-            err = L"Failed to create file mapping: " + GetLastErrorMessage(GetLastError());
-            CloseHandle(out.hFile);
-            out.hFile = INVALID_HANDLE_VALUE;
-            return false;
-        }
-
-        out.view = MapViewOfFile(out.hMap, FILE_MAP_READ, 0, 0, out.bytes);
-        if (out.view == nullptr) {
-            err = L"Failed to map view: " + GetLastErrorMessage(GetLastError());
-            CloseHandle(out.hMap);
-            CloseHandle(out.hFile);
-            out.hMap = NULL;
-            out.hFile = INVALID_HANDLE_VALUE;
-            return false;
-        }
-
-        out.data = static_cast<const uint32_t*>(out.view);
+        out.data = static_cast<const uint32_t*>(out.region.data);
         out.count = out.bytes / sizeof(uint32_t);
         return true;
     }
 
     void UnmapFile(MappedFile& mf) {
-        if (mf.view != nullptr) {
-            UnmapViewOfFile(mf.view);
-            mf.view = nullptr;
-            mf.data = nullptr;
-        }
-        if (mf.hMap != NULL) {
-            CloseHandle(mf.hMap);
-            mf.hMap = NULL;
-        }
-        if (mf.hFile != INVALID_HANDLE_VALUE) {
-            CloseHandle(mf.hFile);
-            mf.hFile = INVALID_HANDLE_VALUE;
-        }
+        Platform::Unmap(mf.region);
+        mf.data = nullptr;
         mf.bytes = 0;
         mf.count = 0;
     }
@@ -112,45 +65,41 @@ namespace FileIO {
     }
 
     bool WriteResultsToFile(const std::wstring& filepath, const std::wstring& content) {
-        HANDLE hFile = CreateFileW(filepath.c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
-        if (hFile == INVALID_HANDLE_VALUE) return false;
-
-        int utf8Size = WideCharToMultiByte(CP_UTF8, 0, content.c_str(), -1, NULL, 0, NULL, NULL);
-        if (utf8Size == 0) {
-            CloseHandle(hFile);
-            return false;
-        }
-
-        std::vector<char> utf8Buffer(utf8Size);
-        WideCharToMultiByte(CP_UTF8, 0, content.c_str(), -1, utf8Buffer.data(), utf8Size, NULL, NULL);
+        std::wstring err;
+        Platform::FileHandle hFile = Platform::OpenFile(filepath, Platform::FileMode::Write, err);
+        if (hFile == Platform::kInvalidFile) return false;
 
-        DWORD bytesWritten;
-        BOOL result = WriteFile(hFile, utf8Buffer.data(), utf8Size - 1, &bytesWritten, NULL);
-        CloseHandle(hFile);
-        return result != FALSE;
+        std::string utf8 = Platform::ToUtf8(content);
+        bool result = Platform::WriteAll(hFile, utf8.data(), utf8.size(), err);
+        Platform::CloseFile(hFile);
+        return result;
     }
 
     std::wstring GetResultsFolder() {
+#ifdef _WIN32
         wchar_t path[MAX_PATH];
         GetModuleFileNameW(NULL, path, MAX_PATH);
         std::wstring exePath(path);
+#else
+        char path[PATH_MAX];
+        ssize_t len = readlink("/proc/self/exe", path, sizeof(path) - 1);
+        std::wstring exePath = len > 0 ? std::wstring(path, path + len) : std::wstring(L".");
+#endif
         size_t pos = exePath.find_last_of(L"\\/");
-        return exePath.substr(0, pos) + L"\\Results";
+        return exePath.substr(0, pos) + kSep + L"Results";
     }
 
     bool CreateDirectoryRecursive(const std::wstring& path, std::wstring& err) {
         err.clear();
 
         // Check if already exists
-        DWORD attrs = GetFileAttributesW(path.c_str());
-        if (attrs != INVALID_FILE_ATTRIBUTES) {
-            if (attrs & FILE_ATTRIBUTE_DIRECTORY) {
-                return true; // Already exists
-            }
-            else {
-                err = L"Path exists but is not a directory: " + path;
-                return false;
-            }
+        bool exists = false;
+        if (Platform::IsDirectory(path, exists)) {
+            return true; // Already exists
+        }
+        if (exists) {
+            err = L"Path exists but is not a directory: " + path;
+            return false;
         }
 
         // Find parent directory
@@ -167,14 +116,34 @@ namespace FileIO {
         }
 
         // Create this directory
-        if (!CreateDirectoryW(path.c_str(), NULL)) {
-            DWORD error = GetLastError();
-            if (error != ERROR_ALREADY_EXISTS) {
-                err = L"Failed to create directory '" + path + L"': " + GetLastErrorMessage(error);
-                return false;
-            }
+        return Platform::CreateDir(path, err);
+    }
+
+    // UTF-8 with BOM, the layout of info.txt and the ACL'd text results
+    static bool WriteUtf8WithBom(const std::wstring& filepath, const std::wstring& content, std::wstring& err) {
+        Platform::FileHandle hFile = Platform::OpenFile(filepath, Platform::FileMode::Write, err);
+        if (hFile == Platform::kInvalidFile) {
+            err = L"Failed to create file: " + err;
+            return false;
+        }
+
+        std::string utf8 = Platform::ToUtf8(content);
+
+        // Write UTF-8 BOM for better compatibility
+        const unsigned char bom[] = { 0xEF, 0xBB, 0xBF };
+        if (!Platform::WriteAll(hFile, bom, sizeof(bom), err)) {
+            err = L"Failed to write BOM: " + err;
+            Platform::CloseFile(hFile);
+            return false;
+        }
+
+        if (!Platform::WriteAll(hFile, utf8.data(), utf8.size(), err)) {
+            err = L"Failed to write content: " + err;
+            Platform::CloseFile(hFile);
+            return false;
         }
 
+        Platform::CloseFile(hFile);
         return true;
     }
 
@@ -199,68 +168,37 @@ namespace FileIO {
             return false;
         }
 
-        // Create and write to file using CreateFile + WriteFile
-        HANDLE hFile = CreateFileW(
-            fixedPath.c_str(),
-            GENERIC_WRITE,
-            0,  // No sharing
-            NULL,
-            CREATE_ALWAYS,  // Overwrite if exists
-            FILE_ATTRIBUTE_NORMAL,
-            NULL
-        );
-
-        if (hFile == INVALID_HANDLE_VALUE) {
-            err = L"Failed to create file: " + GetLastErrorMessage(GetLastError());
-            return false;
-        }
-
-        // Convert to UTF-8 for consistent encoding
-        int utf8Size = WideCharToMultiByte(CP_UTF8, 0, content.c_str(), -1, NULL, 0, NULL, NULL);
-        if (utf8Size == 0) {
-            err = L"Failed to convert to UTF-8: " + GetLastErrorMessage(GetLastError());
-            CloseHandle(hFile);
-            return false;
-        }
-
-        std::vector<char> utf8Buffer(utf8Size);
-        WideCharToMultiByte(CP_UTF8, 0, content.c_str(), -1, utf8Buffer.data(), utf8Size, NULL, NULL);
-
-        // Write UTF-8 BOM for better compatibility
-        const unsigned char bom[] = { 0xEF, 0xBB, 0xBF };
-        DWORD bytesWritten;
-        if (!WriteFile(hFile, bom, sizeof(bom), &bytesWritten, NULL)) {
-            err = L"Failed to write BOM: " + GetLastErrorMessage(GetLastError());
-            CloseHandle(hFile);
-            return false;
-        }
+        return WriteUtf8WithBom(fixedPath, content, err);
+    }
 
-        // Write content (exclude null terminator)
-        if (!WriteFile(hFile, utf8Buffer.data(), utf8Size - 1, &bytesWritten, NULL)) {
-            err = L"Failed to write content: " + GetLastErrorMessage(GetLastError());
-            CloseHandle(hFile);
-            return false;
-        }
+    std::wstring GetResultsRootPath() {
+        return g_resultsFolder;
+    }
 
-        CloseHandle(hFile);
-        return true;
+    void SetResultsRoot(const std::wstring& folder) {
+        g_resultsFolder = folder;
+        while (g_resultsFolder.size() > 1 && (g_resultsFolder.back() == L'\\' || g_resultsFolder.back() == L'/')) g_resultsFolder.pop_back();
     }
 
     std::wstring GetStaticResultsPath() {
-        return kResultsFolder + L"\\static";
+        return g_resultsFolder + kSep + L"static";
 
     }
 
     std::wstring GetDynamicResultsPath() {
-        return kResultsFolder + L"\\dinamic";
+        return g_resultsFolder + kSep + L"dinamic";
 
     }
 
+    std::wstring GetBackendResultsPath(const wchar_t* backend) {
+        return g_resultsFolder + kSep + backend;
+    }
+
     bool EnsureResultsFolders(std::wstring& err) {
         err.clear();
 
         // Base results folder
-       const std::wstring baseResultsPath = kResultsFolder;
+       const std::wstring baseResultsPath = g_resultsFolder;
 
 
         // Create base results folder
@@ -269,23 +207,21 @@ namespace FileIO {
         }
 
         // Create static subfolder
-        std::wstring staticPath = GetStaticResultsPath();
-        if (!CreateDirectoryW(staticPath.c_str(), NULL)) {
-            DWORD error = GetLastError();
-            if (error != ERROR_ALREADY_EXISTS) {
-                err = L"Failed to create static folder: " + GetLastErrorMessage(error);
-                return false;
-            }
+        if (!Platform::CreateDir(GetStaticResultsPath(), err)) {
+            err = L"Failed to create static folder: " + err;
+            return false;
         }
 
         // Create dinamic subfolder
-        std::wstring dynamicPath = GetDynamicResultsPath();
-        if (!CreateDirectoryW(dynamicPath.c_str(), NULL)) {
-            DWORD error = GetLastError();
-            if (error != ERROR_ALREADY_EXISTS) {
-                err = L"Failed to create dinamic folder: " + GetLastErrorMessage(error);
-                return false;
-            }
+        if (!Platform::CreateDir(GetDynamicResultsPath(), err)) {
+            err = L"Failed to create dinamic folder: " + err;
+            return false;
+        }
+
+        // Alternative-runtime subfolders (ParallelBackends)
+        const wchar_t* backends[] = { L"stdpar", L"openmp_static", L"openmp_dynamic", L"openmp_guided" };
+        for (const wchar_t* backend : backends) {
+            if (!Platform::CreateDir(GetBackendResultsPath(backend), err)) return false;
         }
 
         return true;
@@ -295,50 +231,9 @@ namespace FileIO {
         err.clear();
 
         // First, write the file normally
-        HANDLE hFile = CreateFileW(
-            filepath.c_str(),
-            GENERIC_WRITE,
-            0,
-            NULL,
-            CREATE_ALWAYS,
-            FILE_ATTRIBUTE_NORMAL,
-            NULL
-        );
-
-        if (hFile == INVALID_HANDLE_VALUE) {
-            err = L"Failed to create file: " + GetLastErrorMessage(GetLastError());
-            return false;
-        }
-
-        // Convert to UTF-8
-        int utf8Size = WideCharToMultiByte(CP_UTF8, 0, content.c_str(), -1, NULL, 0, NULL, NULL);
-        if (utf8Size == 0) {
-            err = L"Failed to convert to UTF-8: " + GetLastErrorMessage(GetLastError());
-            CloseHandle(hFile);
-            return false;
-        }
-
-        std::vector<char> utf8Buffer(utf8Size);
-        WideCharToMultiByte(CP_UTF8, 0, content.c_str(), -1, utf8Buffer.data(), utf8Size, NULL, NULL);
-
-        // Write UTF-8 BOM
-        const unsigned char bom[] = { 0xEF, 0xBB, 0xBF };
-        DWORD bytesWritten;
-        if (!WriteFile(hFile, bom, sizeof(bom), &bytesWritten, NULL)) {
-            err = L"Failed to write BOM: " + GetLastErrorMessage(GetLastError());
-            CloseHandle(hFile);
-            return false;
-        }
-
-        // Write content
-        if (!WriteFile(hFile, utf8Buffer.data(), utf8Size - 1, &bytesWritten, NULL)) {
-            err = L"Failed to write content: " + GetLastErrorMessage(GetLastError());
-            CloseHandle(hFile);
-            return false;
-        }
-
-        CloseHandle(hFile);
+        if (!WriteUtf8WithBom(filepath, content, err)) return false;
 
+#ifdef _WIN32
         // Now apply ACL
         PSID currentUserSid = Security::GetCurrentUserSidBinary();
         PSID everyoneSid = Security::GetEveryoneSidBinary();
@@ -357,35 +252,32 @@ namespace FileIO {
         Security::FreeSidBinary(everyoneSid);
 
         return aclResult;
+#else
+        return true;   // created 0644
+#endif
     }
    
     bool ApplyResultsAcl(const std::wstring& path, std::wstring& err) {
+#ifdef _WIN32
         return Security::ApplyResultsFileAcl(path, err);
+#else
+        (void)path;
+        err.clear();
+        return true;
+#endif
     }
 
-    bool CreateResultsFileWithAcl(const std::wstring& path, HANDLE& outFile, std::wstring& err) {
+    bool CreateResultsFileWithAcl(const std::wstring& path, Platform::FileHandle& outFile, std::wstring& err) {
         err.clear();
-        outFile = CreateFileW(
-            path.c_str(),
-            GENERIC_READ | GENERIC_WRITE,
-            FILE_SHARE_READ,
-            nullptr,
-            CREATE_ALWAYS,
-            FILE_ATTRIBUTE_NORMAL,
-            nullptr
-        );
-
-        if (outFile == INVALID_HANDLE_VALUE) {
-            err = L"CreateFileW failed: " + std::to_wstring(GetLastError());
-            return false;
-        }
+        outFile = Platform::OpenFile(path, Platform::FileMode::ReadWrite, err);
+        if (outFile == Platform::kInvalidFile) return false;
 
         // apply ACL immediately (safe, file exists)
         std::wstring aclErr;
-        if (!Security::ApplyResultsFileAcl(path, aclErr)) {
+        if (!ApplyResultsAcl(path, aclErr)) {
             // Close and fail: requirement wants ACL correct
-            CloseHandle(outFile);
-            outFile = INVALID_HANDLE_VALUE;
+            Platform::CloseFile(outFile);
+            outFile = Platform::kInvalidFile;
             err = L"ApplyResultsFileAcl failed: " + aclErr;
             return false;
         }
@@ -393,55 +285,69 @@ namespace FileIO {
         return true;
     }
 
-    bool WriteW(HANDLE h, const wchar_t* s, size_t wcharCount, std::wstring& err) {
+    bool WriteW(Platform::FileHandle h, const wchar_t* s, size_t wcharCount, std::wstring& err) {
         err.clear();
-        DWORD bw = 0;
-        const DWORD bytes = (DWORD)(wcharCount * sizeof(wchar_t));
-        if (!WriteFile(h, s, bytes, &bw, nullptr) || bw != bytes) {
-            err = L"WriteFile failed: " + std::to_wstring(GetLastError());
-            return false;
+#ifdef _WIN32
+        return Platform::WriteAll(h, s, wcharCount * sizeof(wchar_t), err);
+#else
+        // wchar_t is UTF-32 here; results files stay UTF-16LE like the Windows build
+        std::u16string units;
+        units.reserve(wcharCount);
+        for (size_t i = 0; i < wcharCount; i++) {
+            uint32_t c = (uint32_t)s[i];
+            if (c >= 0x10000) {
+                c -= 0x10000;
+                units += (char16_t)(0xD800 + (c >> 10));
+                units += (char16_t)(0xDC00 + (c & 0x3FF));
+            } else {
+                units += (char16_t)c;
+            }
         }
-        return true;
+        return Platform::WriteAll(h, units.data(), units.size() * sizeof(char16_t), err);
+#endif
     }
 
-    bool AppendFileToHandle(HANDLE hOut, const std::wstring& srcPath, std::wstring& err) {
+    bool WriteText(Platform::FileHandle h, const wchar_t* s, size_t wcharCount, ResultEncoding encoding, std::wstring& err) {
+        if (encoding != ResultEncoding::Utf8) return WriteW(h, s, wcharCount, err);
+
         err.clear();
+        std::string utf8 = Platform::ToUtf8(std::wstring(s, wcharCount));
+        return Platform::WriteAll(h, utf8.data(), utf8.size(), err);
+    }
 
-        HANDLE hIn = CreateFileW(srcPath.c_str(), GENERIC_READ, FILE_SHARE_READ,
-            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
-        if (hIn == INVALID_HANDLE_VALUE) {
-            err = L"Open temp failed: " + std::to_wstring(GetLastError());
-            return false;
+    const wchar_t* EncodingName(ResultEncoding encoding) {
+        switch (encoding) {
+        case ResultEncoding::Utf16: return L"utf16";
+        case ResultEncoding::Utf8: return L"utf8";
+        case ResultEncoding::Packed32: return L"bin32";
+        case ResultEncoding::DeltaVarint: return L"bindelta";
+        case ResultEncoding::Bitmap: return L"bitmap";
+        default: return L"unknown";
         }
+    }
 
-        const DWORD BUF_BYTES = 1 << 20; // 1MB
-        std::vector<char> buf(BUF_BYTES);
-
-        for (;;) {
-            DWORD br = 0;
-            if (!ReadFile(hIn, buf.data(), BUF_BYTES, &br, nullptr)) {
-                err = L"ReadFile failed: " + std::to_wstring(GetLastError());
-                CloseHandle(hIn);
-                return false;
-            }
-            if (br == 0) break;
+    bool IsBinary(ResultEncoding encoding) {
+        return encoding == ResultEncoding::Packed32 || encoding == ResultEncoding::DeltaVarint;
+    }
 
-            DWORD bw = 0;
-            if (!WriteFile(hOut, buf.data(), br, &bw, nullptr) || bw != br) {
-                err = L"WriteFile merge failed: " + std::to_wstring(GetLastError());
-                CloseHandle(hIn);
-                return false;
-            }
+    size_t UnitBytes(ResultEncoding encoding) {
+        switch (encoding) {
+        case ResultEncoding::Utf16: return sizeof(char16_t);
+        case ResultEncoding::Packed32: return sizeof(uint32_t);
+        case ResultEncoding::Bitmap: return sizeof(uint64_t);
+        default: return 1;
         }
+    }
 
-        CloseHandle(hIn);
-        return true;
+    const wchar_t* ResultExtension(ResultEncoding encoding) {
+        if (encoding == ResultEncoding::Bitmap) return L".bits";
+        return IsBinary(encoding) ? L".bin" : L".txt";
     }
 
     std::wstring MakeTempPath(const std::wstring& folder, uint32_t T, uint32_t nWorkers, uint32_t workerId, const wchar_t* tag) {
-        DWORD pid = GetCurrentProcessId();
+        uint32_t pid = Platform::ProcessId();
         std::wstring p = folder;
-        p += L"\\tmp_";
+        p += kSep + L"tmp_";
         p += std::to_wstring(pid);
         p += L"_";
         p += tag;
@@ -454,4 +360,4 @@ namespace FileIO {
         p += L".tmp";
         return p;
     }
-}
\ No newline at end of file
+}
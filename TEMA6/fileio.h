@@ -1,13 +1,12 @@
 #pragma once
 #include <string>
 #include <vector>
-#include <windows.h>
+#include <cstdint>
+#include "platform.h"
 
 namespace FileIO {
     struct MappedFile {
-        HANDLE hFile = INVALID_HANDLE_VALUE;
-        HANDLE hMap = NULL;
-        void* view = nullptr;
+        Platform::MappedRegion region;
         const uint32_t* data = nullptr;
         size_t bytes = 0;
         size_t count = 0;
@@ -20,8 +19,13 @@ namespace FileIO {
     bool WriteResultsToFileWithAcl(const std::wstring& filepath, const std::wstring& content, std::wstring& err);
     std::wstring GetResultsFolder();
     bool EnsureResultsFolders(std::wstring& err);
+    std::wstring GetResultsRootPath();   // ...\rezultate (sequential runs write here)
+    // Redirect every results path below folder (e.g. a CLI --output directory).
+    // Only call while no run is in progress.
+    void SetResultsRoot(const std::wstring& folder);
     std::wstring GetStaticResultsPath();
     std::wstring GetDynamicResultsPath();
+    std::wstring GetBackendResultsPath(const wchar_t* backend);  // ...\rezultate\<backend>
 
     // Create directory recursively
     bool CreateDirectoryRecursive(const std::wstring& path, std::wstring& err);
@@ -29,16 +33,36 @@ namespace FileIO {
     // Write system info to fixed path
     bool WriteSystemInfoToFile(const std::wstring& content, std::wstring& err);
 
-    bool CreateResultsFileWithAcl(const std::wstring& path, HANDLE& outFile, std::wstring& err);
+    // Read/write results file; on Windows the results ACL is applied right away, elsewhere
+    // the file is created 0644 (owner RW, everyone R)
+    bool CreateResultsFileWithAcl(const std::wstring& path, Platform::FileHandle& outFile, std::wstring& err);
 
     // NEW: finalize file (close handle) and apply ACL (if you prefer applying after)
     bool ApplyResultsAcl(const std::wstring& path, std::wstring& err);
 
-    // NEW: append entire file contents (used to merge worker temp files)
-    bool AppendFileToHandle(HANDLE hOut, const std::wstring& srcPath, std::wstring& err);
+    // Encoding of result files. Result text is ASCII digits and separators, so Utf8 is
+    // plain ASCII at half the bytes of Utf16 (UTF-16LE, the original format). The binary
+    // encodings write a ResultBinary file (header, then per-worker value segments).
+    // Bitmap writes a ResultBitmap file instead: one bit per input element, not per value.
+    enum class ResultEncoding {
+        Utf16,
+        Utf8,
+        Packed32,       // binary, little-endian uint32 per value
+        DeltaVarint,    // binary, zigzag delta + LEB128 varint (1-2 bytes/value on sorted input)
+        Bitmap          // n bits whatever the hit count; reading it back needs the input
+    };
+    const wchar_t* EncodingName(ResultEncoding encoding);   // "utf16", "utf8", "bin32", "bindelta", "bitmap"
+    // Packed32 and DeltaVarint (value segments); Bitmap has its own file format
+    bool IsBinary(ResultEncoding encoding);
+    // Granularity of a segment in bytes: one character for text, one value for Packed32,
+    // one word for Bitmap
+    size_t UnitBytes(ResultEncoding encoding);
+    const wchar_t* ResultExtension(ResultEncoding encoding);  // ".txt", ".bin" or ".bits"
 
-    // NEW: write wide string to file handle (UTF-16)
-    bool WriteW(HANDLE h, const wchar_t* s, size_t wcharCount, std::wstring& err);
+    // NEW: write wide string to file handle (UTF-16LE on every platform)
+    bool WriteW(Platform::FileHandle h, const wchar_t* s, size_t wcharCount, std::wstring& err);
+    // Same, in the given text encoding (UTF-16 for the binary ones)
+    bool WriteText(Platform::FileHandle h, const wchar_t* s, size_t wcharCount, ResultEncoding encoding, std::wstring& err);
 
     // NEW: get temp path inside results folders
     std::wstring MakeTempPath(const std::wstring& folder, uint32_t T, uint32_t nWorkers, uint32_t workerId, const wchar_t* tag);
@@ -2,7 +2,7 @@
 #include <string>
 #include <CommCtrl.h>
 #include "ui.h"
-#include "orchestration.h"
+#include "orchestration_gui.h"
 
 #pragma comment(lib, "comctl32.lib")
 
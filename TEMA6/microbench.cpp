@@ -0,0 +1,153 @@
+#include "microbench.h"
+#include "thread_pool.h"
+#include "sync_wait.h"
+#include "timing.h"
+#include "platform.h"
+#include "decimal_format.h"
+#include <cwchar>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+
+namespace MicroBench {
+
+    // Same fields as the worker state in ParallelStatic before padding: ~56 bytes,
+    // so neighbouring workers' counters land on the same line
+    struct PackedSlot {
+        uint32_t workerId;
+        const uint32_t* data;
+        size_t startIndex;
+        size_t endIndex;
+        uint32_t threshold;
+        uint64_t count;
+        double time_us;
+    };
+
+    struct alignas(Sync::kCacheLine) PaddedSlot {
+        uint32_t workerId;
+        const uint32_t* data;
+        size_t startIndex;
+        size_t endIndex;
+        uint32_t threshold;
+        uint64_t count;
+        double time_us;
+    };
+
+    struct CounterJob {
+        volatile uint64_t* counter;   // volatile: one store per increment, like count++ around a WriteFile
+        uint64_t increments;
+    };
+
+    static unsigned int PLATFORM_CALL CounterProc(void* param) {
+        CounterJob* job = static_cast<CounterJob*>(param);
+        for (uint64_t i = 0; i < job->increments; i++) *job->counter = *job->counter + 1;
+        return 0;
+    }
+
+    template <typename Slot>
+    static double TimeCounters(uint32_t nWorkers, uint64_t increments) {
+        std::vector<Slot> slots(nWorkers);
+        std::vector<CounterJob> jobs(nWorkers);
+        std::vector<ThreadPool::Task> tasks(nWorkers);
+        for (uint32_t i = 0; i < nWorkers; i++) {
+            slots[i] = Slot{};
+            slots[i].workerId = i;
+            jobs[i] = { &slots[i].count, increments };
+            tasks[i] = { CounterProc, &jobs[i] };
+        }
+
+        ThreadPool::JobOptions opts;
+        opts.startBarrier = true;
+        ThreadPool::JobTiming timing;
+        if (!ThreadPool::RunJob(tasks, opts, timing)) return 0.0;
+        return Timing::ElapsedMicros(timing.releasedAt, timing.finishedAt);
+    }
+
+    std::wstring FalseSharingReport(uint32_t nWorkers, uint64_t incrementsPerWorker) {
+        if (nWorkers == 0) nWorkers = 1;
+
+        // warm-up: wakes and (re)pins the pool threads
+        TimeCounters<PaddedSlot>(nWorkers, incrementsPerWorker / 16);
+
+        double packed = TimeCounters<PackedSlot>(nWorkers, incrementsPerWorker);
+        double padded = TimeCounters<PaddedSlot>(nWorkers, incrementsPerWorker);
+
+        std::wstringstream ss;
+        ss << L"False sharing: " << nWorkers << L" workers x " << incrementsPerWorker << L" increments\r\n"
+            << L"  Packed slots (" << sizeof(PackedSlot) << L" B): " << Timing::FormatMicros(packed) << L"\r\n"
+            << L"  Padded slots (" << sizeof(PaddedSlot) << L" B): " << Timing::FormatMicros(padded) << L"\r\n";
+        if (padded > 0.0) {
+            ss << L"  Packed / padded: " << std::fixed << std::setprecision(2) << (packed / padded) << L"x\r\n";
+        }
+        return ss.str();
+    }
+
+    // Format passes are timed over the whole value set; the text is kept to compare
+    template <typename Unit, typename FormatOne>
+    static double TimeFormat(const std::vector<uint32_t>& values, std::vector<Unit>& text, FormatOne format) {
+        text.assign(DecimalFormat::ListCapacity(values.size()), 0);
+        Timing::Ticks start = Timing::Now();
+        size_t used = 0;
+        for (uint32_t v : values) used += format(v, text.data() + used);
+        double us = Timing::ElapsedMicros(start, Timing::Now());
+        text.resize(used);
+        return us;
+    }
+
+    std::wstring DecimalFormatReport(uint32_t count) {
+        if (count == 0) count = 1;
+
+        // xorshift32, shifted by a random amount so every digit length shows up
+        std::vector<uint32_t> values(count);
+        uint32_t state = 2463534242u;
+        auto next = [&state] { state ^= state << 13; state ^= state >> 17; state ^= state << 5; return state; };
+        for (uint32_t& v : values) v = next() >> (next() % 32);
+
+        std::vector<char16_t> viaPrintf, viaTable, viaList;
+        std::vector<char> viaTable8;
+        double printfUs = TimeFormat(values, viaPrintf, [](uint32_t v, char16_t* out) {
+            wchar_t digits[16];
+            int len = swprintf_s(digits, L",%u", v);
+            for (int i = 0; i < len; i++) out[i] = (char16_t)digits[i];
+            return (size_t)len;
+        });
+        double tableUs = TimeFormat(values, viaTable, [](uint32_t v, char16_t* out) {
+            out[0] = u',';
+            return 1 + DecimalFormat::FormatU32(v, out + 1);
+        });
+        double table8Us = TimeFormat(values, viaTable8, [](uint32_t v, char* out) {
+            out[0] = ',';
+            return 1 + DecimalFormat::FormatU32(v, out + 1);
+        });
+
+        viaList.assign(DecimalFormat::ListCapacity(values.size()), 0);
+        Timing::Ticks start = Timing::Now();
+        size_t used = 0;
+        for (size_t i = 0; i < values.size(); i += DecimalFormat::kBatch) {
+            size_t n = values.size() - i < DecimalFormat::kBatch ? values.size() - i : DecimalFormat::kBatch;
+            used += DecimalFormat::FormatList(values.data() + i, n, true, viaList.data() + used);
+        }
+        double listUs = Timing::ElapsedMicros(start, Timing::Now());
+        viaList.resize(used);
+
+        bool same = viaTable == viaPrintf && viaList == viaPrintf && viaTable8.size() == viaPrintf.size();
+        for (size_t i = 0; same && i < viaTable8.size(); i++) same = (char16_t)viaTable8[i] == viaPrintf[i];
+
+        auto line = [&](const wchar_t* name, double us) {
+            std::wstringstream ls;
+            ls << L"  " << std::left << std::setw(30) << name << std::right << std::fixed << std::setprecision(2)
+                << (us * 1000.0 / count) << L" ns/value";
+            if (us > 0.0) ls << L"  (" << (printfUs / us) << L"x)";
+            return ls.str() + L"\r\n";
+        };
+
+        std::wstringstream ss;
+        ss << L"Result formatting: " << count << L" values, " << viaPrintf.size() << L" characters\r\n"
+            << line(L"swprintf_s, UTF-16", printfUs)
+            << line(L"digit pairs, UTF-16", tableUs)
+            << line(L"digit pairs, UTF-8", table8Us)
+            << line((std::wstring(L"FormatList (") + DecimalFormat::ListPathName() + L"), UTF-16").c_str(), listUs)
+            << L"  Output identical: " << (same ? L"yes" : L"NO") << L"\r\n";
+        return ss.str();
+    }
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace MicroBench {
+    // Per-worker counters bumped in a tight loop by nWorkers pool threads, once with
+    // the old packed worker-state layout and once with cache-line-padded slots.
+    // Returns a printable report (time per variant, slowdown of the packed layout).
+    std::wstring FalseSharingReport(uint32_t nWorkers, uint64_t incrementsPerWorker);
+
+    // Formats `count` pseudo-random values (all digit lengths) as ",v" result text with
+    // swprintf_s, with DecimalFormat::FormatU32 (UTF-16 and UTF-8) and with the batched
+    // FormatList. Reports ns per value and whether every variant produced the same text.
+    std::wstring DecimalFormatReport(uint32_t count);
+}
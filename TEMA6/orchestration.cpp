@@ -7,41 +7,28 @@
 #include "fileio.h"
 #include "timing.h"
 #include "sysinfo.h"
-#include <process.h>
+#include "thread_pool.h"
+#include "cost_model.h"
+#include "collatz.h"
+#include "scheduling_policy.h"
+#include "replication.h"
+#include "parallel_backends.h"
+#include "experiment.h"
+#include "platform.h"
+#include <map>
+#include <thread>
 #include <sstream>
 #include <iomanip>
 #include <float.h>
 
 namespace Orchestration {
-    void LogToUI(HWND hwnd, const std::wstring& message) {
-        wchar_t* msg = new wchar_t[message.length() + 1];
-        wcscpy_s(msg, message.length() + 1, message.c_str());
-        PostMessageW(hwnd, WM_ORCHESTRATION_LOG, 0, reinterpret_cast<LPARAM>(msg));
-    }
-
     uint32_t GetPhysicalCoreCount() {
-        SYSTEM_INFO sysInfo;
-        GetSystemInfo(&sysInfo);
-
-        DWORD length = 0;
-        GetLogicalProcessorInformation(nullptr, &length);
-
-        if (GetLastError() == ERROR_INSUFFICIENT_BUFFER && length > 0) {
-            std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> buffer(
-                length / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
-
-            if (GetLogicalProcessorInformation(buffer.data(), &length)) {
-                uint32_t physicalCores = 0;
-                for (const auto& info : buffer) {
-                    if (info.Relationship == RelationProcessorCore) {
-                        physicalCores++;
-                    }
-                }
-                return physicalCores > 0 ? physicalCores : sysInfo.dwNumberOfProcessors;
-            }
-        }
+        // GetSystemCpuSetInformation / sysfs through the topology layer
+        const Topology::CpuTopology& topo = Topology::Get();
+        if (topo.coreCount > 0) return topo.coreCount;
 
-        return sysInfo.dwNumberOfProcessors;
+        unsigned int logical = std::thread::hardware_concurrency();
+        return logical > 0 ? logical : 1;
     }
 
     void UpdateMethodStats(MethodStats& stats, double time, bool validationPassed) {
@@ -56,21 +43,277 @@ namespace Orchestration {
         }
     }
 
-    unsigned int __stdcall OrchestrationThread(void* param) {
-        OrchestrationThreadData* data = static_cast<OrchestrationThreadData*>(param);
-        HWND hwnd = data->targetWindow;
-        TestConfig config = data->config;
-        delete data;
+    struct CalibrationTask {
+        double time_us = 0.0;
+    };
+
+    // Fixed integer workload, identical for every worker
+    static unsigned int PLATFORM_CALL CalibrationProc(void* param) {
+        CalibrationTask* ct = static_cast<CalibrationTask*>(param);
+
+        Timing::Ticks start = Timing::Now();
+        volatile uint32_t sink = 0;
+        for (uint32_t x = 1; x < 200000; x++) sink = sink + Collatz::CollatzStepsCapped(x, 1000);
+        ct->time_us = Timing::ElapsedMicros(start, Timing::Now());
+        return 0;
+    }
+
+    // Run the calibration kernel on all pinned workers at once; weight = fastest time / own time
+    static std::vector<double> MeasureWorkerWeights(uint32_t nWorkers) {
+        std::vector<CalibrationTask> ct(nWorkers);
+        std::vector<ThreadPool::Task> tasks(nWorkers);
+        for (uint32_t i = 0; i < nWorkers; i++) tasks[i] = { CalibrationProc, &ct[i] };
+
+        std::vector<double> w(nWorkers, 1.0);
+        if (!ThreadPool::RunJob(tasks)) return w;
+
+        double best = DBL_MAX;
+        for (const auto& c : ct) if (c.time_us > 0.0 && c.time_us < best) best = c.time_us;
+        for (uint32_t i = 0; i < nWorkers; i++) {
+            if (ct[i].time_us > 0.0) w[i] = best / ct[i].time_us;
+        }
+        return w;
+    }
+
+    // Shrinks an elastic run to half width at 25% of the expected time, restores it at 60%
+    struct ElasticScript {
+        ParallelDynamic::WorkerControl* control;
+        uint32_t maxWorkers;
+        double expected_us;
+    };
+
+    static unsigned int PLATFORM_CALL ElasticScriptProc(void* param) {
+        ElasticScript* es = static_cast<ElasticScript*>(param);
+        Platform::SleepMillis((uint32_t)(es->expected_us * 0.25 / 1000.0));
+        es->control->SetTarget(es->maxWorkers / 2);
+        Platform::SleepMillis((uint32_t)(es->expected_us * 0.35 / 1000.0));
+        es->control->SetTarget(es->maxWorkers);
+        return 0;
+    }
+
+    // Worker count vs throughput, at most ~maxRows rows plus every change of worker count
+    static std::wstring FormatTimeline(const std::vector<ParallelDynamic::ElasticSample>& tl, size_t maxRows) {
+        std::wstringstream ss;
+        if (tl.empty()) return ss.str();
+
+        size_t stride = tl.size() / maxRows + 1;
+        size_t prev = 0;
+        for (size_t i = 1; i < tl.size(); i++) {
+            bool changed = tl[i].activeWorkers != tl[i - 1].activeWorkers;
+            if (!changed && i % stride != 0 && i + 1 != tl.size()) continue;
+
+            double dt = tl[i].t_us - tl[prev].t_us;
+            double rate = dt > 0.0 ? (double)(tl[i].elementsDone - tl[prev].elementsDone) / dt : 0.0;
+            ss << L"      " << std::fixed << std::setprecision(1) << std::setw(9) << (tl[i].t_us / 1000.0) << L" ms  workers "
+                << tl[i].activeWorkers << L"/" << (tl[i].targetWorkers > tl[0].activeWorkers ? tl[0].activeWorkers : tl[i].targetWorkers)
+                << L"  " << std::setprecision(2) << rate << L" Mval/s\r\n";
+            prev = i;
+        }
+        return ss.str();
+    }
+
+    // Fastest of reps runs (every run still writes its own output file)
+    template <typename Result, typename Run>
+    static Result BestOf(uint32_t reps, Run run) {
+        Result best = run();
+        for (uint32_t r = 1; r < reps; r++) {
+            Result next = run();
+            if (next.time_us < best.time_us) best = std::move(next);
+        }
+        return best;
+    }
+
+    // " (Speedup: 3.21x)" against the sequential time, when there is one
+    static std::wstring SpeedupText(double seq_us, double par_us) {
+        if (seq_us <= 0.0 || par_us <= 0.0) return L"";
+        std::wstringstream ss;
+        ss << L" (Speedup: " << std::fixed << std::setprecision(2) << (seq_us / par_us) << L"x)";
+        return ss.str();
+    }
+
+    static void LogValidation(ProgressSink& sink, const Validation::ValidationResult& val) {
+        if (val.passed) {
+            sink.Log(L"    Validation: ✓ PASS\r\n\r\n");
+        }
+        else {
+            std::wstringstream valErr;
+            valErr << L"    Validation: ✗ FAIL (missing: " << val.missingCount
+                << L", extra: " << val.extraCount << L")\r\n\r\n";
+            sink.Log(valErr.str());
+        }
+    }
+
+    // "Output: 12 writes, 1024.0 KiB/write", the writer queue (writer threads only) and the
+    // first write error, if any
+    static std::wstring OutputText(const wchar_t* indent, const ResultWriter::WriteStats& io) {
+        std::wstringstream ss;
+        ss << indent << L"Output: " << io.writeCalls << L" writes, " << std::fixed << std::setprecision(1)
+            << (io.BytesPerWrite() / 1024.0) << L" KiB/write\r\n";
+        if (io.queuedBlocks) {
+            ss << indent << L"Writer queue: mean depth " << std::setprecision(1) << io.MeanQueueDepth()
+                << L", max " << io.maxQueueDepth << L"; workers stalled " << Timing::FormatMicros(io.stall_us)
+                << L" in total waiting for a buffer\r\n";
+        }
+        if (!io.error.empty()) ss << indent << L"Output error: " << io.error << L"\r\n";
+        return ss.str();
+    }
+
+    // Timed sequential run; its count is the reference for the runs that follow
+    static Sequential::SequentialResult RunSequentialPoint(ProgressSink& sink, TestSummary& summary,
+        const FileIO::MappedFile& mf, uint32_t T, uint32_t reps, size_t bufferBytes, FileIO::ResultEncoding encoding,
+        bool uncached) {
+        sink.Log(L"Running Sequential...\r\n");
+        Sequential::SequentialResult seqResult = BestOf<Sequential::SequentialResult>(reps,
+            [&] { return Sequential::RunSequential(mf.data, mf.count, T, bufferBytes, encoding, uncached); });
+
+        std::wstringstream seqLog;
+        seqLog << L"  Time: " << Timing::FormatMicros(seqResult.time_us) << L"\r\n"
+            << L"  Found: " << seqResult.count << L" values\r\n"
+            << OutputText(L"  ", seqResult.io) << L"\r\n";
+        sink.Log(seqLog.str());
+
+        // the count is still a valid reference; the broken result file is the failure
+        bool written = seqResult.io.error.empty();
+        summary.totalTests++;
+        UpdateMethodStats(summary.sequential, seqResult.time_us, written);
+        if (!written) summary.totalFailures++;
+        return seqResult;
+    }
+
+    static void RunStaticPoint(ProgressSink& sink, TestSummary& summary, const FileIO::MappedFile& mf,
+        uint32_t T, uint32_t nWorkers, uint32_t reps, const ParallelStatic::StaticOptions& staticOpts,
+        const Sequential::SequentialResult& seqResult) {
+        sink.Log(staticOpts.costs ? L"  Running Parallel Static (cost-balanced)...\r\n" : L"  Running Parallel Static...\r\n");
+        ParallelStatic::ParallelStaticResult staticResult = BestOf<ParallelStatic::ParallelStaticResult>(reps,
+            [&] { return ParallelStatic::RunParallelStatic(mf.data, mf.count, T, nWorkers, staticOpts); });
+
+        std::wstringstream staticLog;
+        staticLog << L"    Time: " << Timing::FormatMicros(staticResult.time_us)
+            << SpeedupText(seqResult.time_us, staticResult.time_us) << L"\r\n"
+            << L"    Found: " << staticResult.totalCount << L" values\r\n"
+            << L"    Imbalance: " << std::fixed << std::setprecision(1) << (staticResult.imbalance * 100.0) << L"%\r\n"
+            << L"    Startup (not timed): " << Timing::FormatMicros(staticResult.startup_us) << L"\r\n"
+            << OutputText(L"    ", staticResult.io);
+        sink.Log(staticLog.str());
+
+        Validation::ValidationResult staticVal = Validation::ValidateCounts(seqResult.count, staticResult.totalCount);
+        if (!staticResult.io.error.empty()) staticVal.passed = false;
+
+        summary.totalTests++;
+        UpdateMethodStats(summary.parallelStatic, staticResult.time_us, staticVal.passed);
+        if (!staticVal.passed) summary.totalFailures++;
+        LogValidation(sink, staticVal);
+    }
+
+    // Returns the fastest time (0 if the run produced none)
+    static double RunDynamicPoint(ProgressSink& sink, TestSummary& summary, const FileIO::MappedFile& mf,
+        uint32_t T, uint32_t nWorkers, uint32_t reps, const ParallelDynamic::DynamicOptions& dynamicOpts,
+        const Sequential::SequentialResult& seqResult, bool logController) {
+        sink.Log(L"  Running Parallel Dynamic...\r\n");
+        ParallelDynamic::ParallelDynamicResult dynamicResult = BestOf<ParallelDynamic::ParallelDynamicResult>(reps,
+            [&] { return ParallelDynamic::RunParallelDynamic(mf.data, mf.count, T, nWorkers, dynamicOpts); });
+
+        std::wstringstream dynamicLog;
+        dynamicLog << L"    Time: " << Timing::FormatMicros(dynamicResult.time_us)
+            << SpeedupText(seqResult.time_us, dynamicResult.time_us) << L"\r\n"
+            << L"    Found: " << dynamicResult.totalCount << L" values\r\n"
+            << L"    Startup (not timed): " << Timing::FormatMicros(dynamicResult.startup_us) << L"\r\n"
+            << OutputText(L"    ", dynamicResult.io);
+
+        const ParallelDynamic::DynamicTelemetry& tel = dynamicResult.telemetry;
+        if (!tel.chunks.empty()) {
+            size_t minChunk = tel.chunks[0].size, maxChunk = tel.chunks[0].size;
+            for (const auto& c : tel.chunks) {
+                if (c.size < minChunk) minChunk = c.size;
+                if (c.size > maxChunk) maxChunk = c.size;
+            }
+            dynamicLog << L"    Dispatches: " << tel.dispatchCount
+                << L" (" << tel.policyName << L", chunk " << minChunk << L".." << maxChunk << L")\r\n";
+            if (tel.queueCount > 1) {
+                dynamicLog << L"    Queues: " << tel.queueCount << L" NUMA-local, "
+                    << tel.stealCount << L" cross-node steals\r\n";
+            }
+            if (logController) {
+                dynamicLog << L"    Controller: " << std::fixed << std::setprecision(4) << tel.perElement_us
+                    << L" us/value, " << std::setprecision(1) << tel.dispatchOverhead_us << L" us/dispatch\r\n";
+            }
+        }
+        sink.Log(dynamicLog.str());
+
+        Validation::ValidationResult dynamicVal = Validation::ValidateCounts(seqResult.count, dynamicResult.totalCount);
+        if (!dynamicResult.io.error.empty()) dynamicVal.passed = false;
+
+        summary.totalTests++;
+        UpdateMethodStats(summary.parallelDynamic, dynamicResult.time_us, dynamicVal.passed);
+        if (!dynamicVal.passed) summary.totalFailures++;
+        LogValidation(sink, dynamicVal);
+        return dynamicResult.time_us;
+    }
+
+    // Log line of a runtime-backend point; a count mismatch or an output error is a failure
+    static void RunBackendPoint(ProgressSink& sink, TestSummary& summary, const std::wstring& name,
+        const ParallelBackends::BackendResult& br, const Sequential::SequentialResult& seqResult) {
+        std::wstringstream log;
+        log << L"  " << std::left << std::setw(20) << name << std::right;
+        if (!br.available) {
+            log << L" not compiled in\r\n";
+            sink.Log(log.str());
+            return;
+        }
+
+        bool passed = br.totalCount == seqResult.count && br.io.error.empty();
+        log << L" " << Timing::FormatMicros(br.time_us) << SpeedupText(seqResult.time_us, br.time_us)
+            << L", " << br.io.writeCalls << L" writes"
+            << (br.totalCount == seqResult.count ? L"" : L"  COUNT MISMATCH")
+            << (br.io.error.empty() ? L"" : L"  OUTPUT ERROR: " + br.io.error) << L"\r\n";
+        sink.Log(log.str());
+
+        summary.totalTests++;
+        if (!passed) summary.totalFailures++;
+    }
+
+    static void LogFinalSummary(ProgressSink& sink, const TestSummary& summary, const std::wstring& notes) {
+        std::wstringstream summaryLog;
+        summaryLog << L"========================================\r\nFINAL SUMMARY\r\n========================================\r\n\r\n"
+            << L"Total Tests Run: " << summary.totalTests << L"\r\n"
+            << L"Total Failures: " << summary.totalFailures << L"\r\n\r\n"
+            << notes;
+
+        if (summary.sequential.minTime != DBL_MAX) {
+            summaryLog << L"Sequential:\r\n"
+                << L"  Min time: " << Timing::FormatMicros(summary.sequential.minTime) << L"\r\n"
+                << L"  Max time: " << Timing::FormatMicros(summary.sequential.maxTime) << L"\r\n\r\n";
+        }
+
+        summaryLog << L"Parallel Static:\r\n"
+            << L"  Min time: " << Timing::FormatMicros(summary.parallelStatic.minTime) << L"\r\n"
+            << L"  Max time: " << Timing::FormatMicros(summary.parallelStatic.maxTime) << L"\r\n"
+            << L"  Validations passed: " << summary.parallelStatic.validationsPassed << L"\r\n"
+            << L"  Validations failed: " << summary.parallelStatic.validationsFailed << L"\r\n\r\n"
+            << L"Parallel Dynamic:\r\n"
+            << L"  Min time: " << Timing::FormatMicros(summary.parallelDynamic.minTime) << L"\r\n"
+            << L"  Max time: " << Timing::FormatMicros(summary.parallelDynamic.maxTime) << L"\r\n"
+            << L"  Validations passed: " << summary.parallelDynamic.validationsPassed << L"\r\n"
+            << L"  Validations failed: " << summary.parallelDynamic.validationsFailed << L"\r\n\r\n";
+
+        summaryLog << (summary.totalFailures == 0 ? L"✓ ALL TESTS PASSED!\r\n" : L"✗ SOME TESTS FAILED - Review results above\r\n");
+        summaryLog << L"\r\n========================================\r\n";
+        sink.Log(summaryLog.str());
+    }
+
+    bool RunTestSuite(const TestConfig& config, ProgressSink& sink, TestSummary& summary) {
+        summary = TestSummary();
+        summary.totalTests = 0;
+        summary.totalFailures = 0;
 
-        LogToUI(hwnd, L"========================================\r\nCOMPREHENSIVE TEST SUITE\r\n========================================\r\n\r\n");
+        sink.Log(L"========================================\r\nCOMPREHENSIVE TEST SUITE\r\n========================================\r\n\r\n");
 
         FileIO::MappedFile mf;
         std::wstring err;
 
         if (!FileIO::MapBinaryUInt32File(config.inputFilePath, mf, err)) {
-            LogToUI(hwnd, L"ERROR: Failed to map input file: " + err + L"\r\n");
-            PostMessageW(hwnd, WM_ORCHESTRATION_COMPLETE, 0, 0);
-            return 1;
+            sink.Log(L"ERROR: Failed to map input file: " + err + L"\r\n");
+            return false;
         }
 
         // RAII struct to ensure file is unmapped
@@ -80,143 +323,449 @@ namespace Orchestration {
             ~FileGuard() { FileIO::UnmapFile(mf); }
         } fileGuard(mf);
 
+        // One pool for the whole sweep: maxWorkers workers + the dynamic coordinator
+        if (!ThreadPool::Initialize(config.maxWorkers + 1, err)) {
+            sink.Log(L"WARNING: Thread pool pre-start failed (" + err + L"), threads will be created on demand\r\n");
+        }
+
+        struct PoolGuard {
+            ~PoolGuard() { ThreadPool::Shutdown(); }
+        } poolGuard;
+
+        // Injected topology (e.g. a hybrid layout to exercise weighting on a homogeneous host)
+        struct TopologyGuard {
+            bool active = false;
+            ~TopologyGuard() { if (active) Topology::ClearOverride(); }
+        } topologyGuard;
+
+        if (!config.topologyFile.empty()) {
+            Topology::CpuTopology injected;
+            if (Topology::LoadFromFile(config.topologyFile, injected, err)) {
+                Topology::SetOverride(injected);
+                topologyGuard.active = true;
+                sink.Log(L"Topology loaded from " + config.topologyFile + L" ("
+                    + std::to_wstring(injected.cpus.size()) + L" CPUs)\r\n");
+            }
+            else {
+                sink.Log(L"WARNING: " + err + L", using detected topology\r\n");
+            }
+        }
+
+        // Workers follow the placement order; this thread takes the CPU the order fills last
+        ThreadPool::SetPlacement(config.pinPolicy);
+        if (config.pinPolicy != Topology::PinPolicy::None) {
+            if (!Topology::PinControlThread(config.pinPolicy, err)) {
+                sink.Log(L"WARNING: Could not pin orchestration thread: " + err + L"\r\n");
+            }
+
+            std::vector<Topology::LogicalCpu> order = Topology::PlacementOrder(Topology::Get(), config.pinPolicy);
+            sink.Log(std::wstring(L"Thread placement (") + Topology::PolicyName(config.pinPolicy) + L"):\r\n"
+                + Topology::DescribePlacement(order, config.maxWorkers) + L"\r\n");
+        }
+
+        // Per-worker throughput for the largest worker count; smaller counts use a prefix
+        std::vector<double> maxWeights;
+        if (config.coreWeighting != CoreWeighting::None) {
+            if (config.pinPolicy == Topology::PinPolicy::None) {
+                sink.Log(L"WARNING: Core weighting needs a pinning policy; workers are not bound to cores\r\n");
+            }
+
+            maxWeights = (config.coreWeighting == CoreWeighting::Measured)
+                ? MeasureWorkerWeights(config.maxWorkers)
+                : Topology::WorkerWeights(config.pinPolicy, config.maxWorkers);
+
+            std::wstringstream wlog;
+            wlog << L"Worker weights (" << (config.coreWeighting == CoreWeighting::Measured ? L"measured" : L"declared") << L"):";
+            for (double w : maxWeights) wlog << L" " << std::fixed << std::setprecision(2) << w;
+            wlog << L"\r\n\r\n";
+            sink.Log(wlog.str());
+        }
+
+        // NUMA node of every worker, for the per-node dynamic queues and input replicas
+        std::vector<uint32_t> maxNodes;
+        if (config.numaQueues || config.replicateInput) {
+            if (config.pinPolicy == Topology::PinPolicy::None) {
+                sink.Log(L"WARNING: NUMA-local queues/replicas need a pinning policy; workers are not bound to nodes\r\n");
+            }
+            else {
+                maxNodes = Topology::WorkerNodes(config.pinPolicy, config.maxWorkers);
+                if (config.numaQueues) {
+                    sink.Log(L"NUMA-local dynamic queues: " + std::to_wstring(Topology::Get().nodeCount) + L" node(s)\r\n");
+                }
+            }
+        }
+
+        // Node-local input copies, made once for the whole sweep; not part of any timed run
+        Replication::InputReplicas replicas;
+        struct ReplicaGuard {
+            Replication::InputReplicas& r;
+            explicit ReplicaGuard(Replication::InputReplicas& rep) : r(rep) {}
+            ~ReplicaGuard() { Replication::ReleaseReplicas(r); }
+        } replicaGuard(replicas);
+
+        if (config.replicateInput && !maxNodes.empty()) {
+            if (Replication::ReplicateInput(mf, maxNodes, replicas, err)) {
+                std::wstringstream repLog;
+                repLog << L"Input replicated to " << replicas.nodes.size() << L" node(s) ("
+                    << (replicas.bytes >> 20) << L" MB each) in " << Timing::FormatMicros(replicas.time_us) << L"\r\n";
+                sink.Log(repLog.str());
+            }
+            else {
+                sink.Log(L"WARNING: Input replication failed (" + err + L"), workers read the mapped file\r\n");
+            }
+        }
+        if (!maxNodes.empty()) sink.Log(L"\r\n");
+
         std::wstringstream info;
         info << L"Input File: " << config.inputFilePath << L"\r\n"
             << L"File size: " << mf.count << L" values\r\n"
-            << L"Physical cores (P): " << (config.maxWorkers / 2) << L"\r\n"
-            << L"Testing worker counts: 1 to " << config.maxWorkers << L"\r\n\r\n";
-        LogToUI(hwnd, info.str());
-
-        TestSummary summary;
-        summary.totalTests = 0;
-        summary.totalFailures = 0;
+            << L"Testing worker counts: " << config.minWorkers << L" to " << config.maxWorkers << L"\r\n"
+            << L"Methods:" << (config.runSequential ? L" sequential" : L"") << (config.runStatic ? L" static" : L"")
+            << (config.runDynamic ? L" dynamic" : L"") << L"\r\n"
+            << L"Repetitions: " << config.repetitions << L" (fastest reported)\r\n"
+            << L"Results folder: " << FileIO::GetResultsRootPath() << L"\r\n"
+            << L"Static partitioning: " << (config.costBalancedStatic ? L"cost-balanced" : L"equal counts") << L"\r\n"
+            << L"Worker wait policy: " << Sync::WaitPolicyName(config.waitPolicy) << L"\r\n"
+            << L"Output buffer: " << (config.outputBufferBytes ? std::to_wstring(config.outputBufferBytes >> 10) + L" KiB per worker" : L"none (one write per value)") << L"\r\n"
+            << L"Output encoding: " << FileIO::EncodingName(config.outputEncoding) << L"\r\n"
+            << L"Worker segments: " << ResultWriter::SegmentModeName(config.segmentMode) << L"\r\n"
+            << L"Writer threads: " << (config.writerThreads ? std::to_wstring(config.writerThreads) + L", queue "
+                + (config.writerQueue ? L"depth " + std::to_wstring(config.writerQueue) : std::wstring(L"one block per worker"))
+                + L", backend " + AsyncWriter::BackendName(config.writerBackend)
+                : std::wstring(L"none (workers write)")) << L"\r\n"
+            << L"Page cache: " << (config.uncachedOutput ? L"bypassed for whole result blocks, known sizes preallocated" : L"used for results") << L"\r\n\r\n";
+        sink.Log(info.str());
 
         for (uint32_t T : config.tValues) {
             std::wstringstream tHeader;
             tHeader << L"========================================\r\nTesting with T = " << T
                 << L"\r\n========================================\r\n\r\n";
-            LogToUI(hwnd, tHeader.str());
+            sink.Log(tHeader.str());
 
-            LogToUI(hwnd, L"Running Sequential...\r\n");
-            Sequential::SequentialResult seqResult = Sequential::RunSequential(mf.data, mf.count, T);
+            // Reference count for validation; time 0 = no sequential baseline for speedups
+            Sequential::SequentialResult seqResult{};
+            if (config.runSequential) {
+                seqResult = RunSequentialPoint(sink, summary, mf, T, config.repetitions,
+                    config.outputBufferBytes, config.outputEncoding, config.uncachedOutput);
+            }
+            else {
+                seqResult.count = Sequential::CountMatches(mf.data, mf.count, T);
+                sink.Log(L"Reference count (not timed): " + std::to_wstring(seqResult.count) + L" values\r\n\r\n");
+            }
 
-            std::wstringstream seqLog;
-            seqLog << L"  Time: " << Timing::FormatMicros(seqResult.time_us) << L"\r\n"
-                << L"  Found: " << seqResult.count << L" values\r\n\r\n";
-            LogToUI(hwnd, seqLog.str());
+            // Cost model is independent of the worker count: sample once per T, outside any timed section
+            CostModel::BlockCosts costs;
+            if (config.costBalancedStatic) {
+                costs = CostModel::EstimateBlockCosts(mf.data, mf.count, T, 0, 16);
 
-            UpdateMethodStats(summary.sequential, seqResult.time_us, true);
+                std::wstringstream costLog;
+                costLog << L"Cost model pre-pass: " << costs.cost.size() << L" blocks of "
+                    << costs.blockSize << L" values in " << Timing::FormatMicros(costs.time_us) << L"\r\n\r\n";
+                sink.Log(costLog.str());
+            }
 
-            for (uint32_t nWorkers = 1; nWorkers <= config.maxWorkers; nWorkers++) {
+            for (uint32_t nWorkers = config.minWorkers; nWorkers <= config.maxWorkers; nWorkers++) {
                 std::wstringstream workerHeader;
                 workerHeader << L"Testing with " << nWorkers << L" workers:\r\n----------------------------------\r\n";
-                LogToUI(hwnd, workerHeader.str());
+                sink.Log(workerHeader.str());
+
+                std::vector<double> weights;
+                if (!maxWeights.empty()) weights.assign(maxWeights.begin(), maxWeights.begin() + nWorkers);
+                std::vector<uint32_t> nodes;
+                if (!maxNodes.empty()) nodes.assign(maxNodes.begin(), maxNodes.begin() + nWorkers);
+                std::vector<const uint32_t*> views;
+                if (!replicas.copies.empty()) views = Replication::WorkerViews(replicas, nodes, nWorkers, mf.data);
+
+                if (config.runStatic) {
+                    ParallelStatic::StaticOptions staticOpts;
+                    staticOpts.costs = config.costBalancedStatic ? &costs : nullptr;
+                    staticOpts.workerWeights = weights.empty() ? nullptr : &weights;
+                    staticOpts.workerData = views.empty() ? nullptr : &views;
+                    staticOpts.waitPolicy = config.waitPolicy;
+                    staticOpts.outputBufferBytes = config.outputBufferBytes;
+                    staticOpts.outputEncoding = config.outputEncoding;
+                    staticOpts.segmentMode = config.segmentMode;
+                    staticOpts.writerThreads = config.writerThreads;
+                    staticOpts.writerQueue = config.writerQueue;
+                    staticOpts.writerBackend = config.writerBackend;
+                    staticOpts.uncachedOutput = config.uncachedOutput;
+                    RunStaticPoint(sink, summary, mf, T, nWorkers, config.repetitions, staticOpts, seqResult);
+                }
 
-                LogToUI(hwnd, L"  Running Parallel Static...\r\n");
-                ParallelStatic::ParallelStaticResult staticResult =
-                    ParallelStatic::RunParallelStatic(mf.data, mf.count, T, nWorkers);
+                ParallelDynamic::DynamicOptions dynamicOpts;
+                dynamicOpts.workerWeights = weights.empty() ? nullptr : &weights;
+                dynamicOpts.workerNodes = (config.numaQueues && !nodes.empty()) ? &nodes : nullptr;
+                dynamicOpts.workerData = views.empty() ? nullptr : &views;
+                dynamicOpts.waitPolicy = config.waitPolicy;
+                dynamicOpts.outputBufferBytes = config.outputBufferBytes;
+                dynamicOpts.outputEncoding = config.outputEncoding;
+                dynamicOpts.segmentMode = config.segmentMode;
+                dynamicOpts.writerThreads = config.writerThreads;
+                dynamicOpts.writerQueue = config.writerQueue;
+                dynamicOpts.writerBackend = config.writerBackend;
+                dynamicOpts.uncachedOutput = config.uncachedOutput;
+                std::unique_ptr<Scheduling::ChunkPolicy> mainPolicy;
+                if (config.adaptiveChunks) {
+                    mainPolicy = Scheduling::CreatePolicy(Scheduling::PolicyKind::Adaptive);
+                    dynamicOpts.policy = mainPolicy.get();
+                }
 
-                std::wstringstream staticLog;
-                staticLog << L"    Time: " << Timing::FormatMicros(staticResult.time_us)
-                    << L" (Speedup: " << std::fixed << std::setprecision(2)
-                    << (seqResult.time_us / staticResult.time_us) << L"x)\r\n"
-                    << L"    Found: " << staticResult.totalCount << L" values\r\n";
-                LogToUI(hwnd, staticLog.str());
+                double dynamicTime_us = 0.0;   // paces the elastic script
+                if (config.runDynamic) {
+                    dynamicTime_us = RunDynamicPoint(sink, summary, mf, T, nWorkers, config.repetitions,
+                        dynamicOpts, seqResult, config.adaptiveChunks);
+                }
 
-                Validation::ValidationResult staticVal =
-                    Validation::ValidateResults(seqResult.found, staticResult.unionSet);
+                if (config.elasticDemo && dynamicTime_us > 0.0 && nWorkers == config.maxWorkers && nWorkers >= 2) {
+                    ParallelDynamic::WorkerControl control(nWorkers);
+                    ParallelDynamic::DynamicOptions elasticOpts = dynamicOpts;
+                    elasticOpts.control = &control;
+
+                    ElasticScript script{ &control, nWorkers, dynamicTime_us };
+                    std::wstring threadErr;
+                    Platform::ThreadHandle hScript = Platform::StartThread(ElasticScriptProc, &script, threadErr);
+                    if (hScript == nullptr) {
+                        // without the script the workers would never retire, so there is nothing to show
+                        sink.Log(L"  Elastic run skipped: " + threadErr + L"\r\n\r\n");
+                    }
+                    else {
+                        ParallelDynamic::ParallelDynamicResult er =
+                            ParallelDynamic::RunParallelDynamic(mf.data, mf.count, T, nWorkers, elasticOpts);
+
+                        Platform::JoinThread(hScript);
+
+                        std::wstringstream elasticLog;
+                        elasticLog << L"  Elastic run (" << nWorkers << L" -> " << (nWorkers / 2) << L" -> " << nWorkers << L" workers):\r\n"
+                            << L"    Time: " << Timing::FormatMicros(er.time_us)
+                            << L", retired " << er.telemetry.retireCount << L", rejoined " << er.telemetry.joinCount
+                            << (er.totalCount == seqResult.count ? L"" : L"  COUNT MISMATCH")
+                            << (er.io.error.empty() ? L"" : L"  OUTPUT ERROR: " + er.io.error) << L"\r\n"
+                            << FormatTimeline(er.telemetry.timeline, 40) << L"\r\n";
+                        sink.Log(elasticLog.str());
+
+                        summary.totalTests++;
+                        if (er.totalCount != seqResult.count || !er.io.error.empty()) summary.totalFailures++;
+                    }
+                }
 
-                summary.totalTests++;
-                UpdateMethodStats(summary.parallelStatic, staticResult.time_us, staticVal.passed);
+                if (config.runtimeBackends) {
+                    std::wstringstream rtLog;
+                    rtLog << L"  Runtime backends (" << nWorkers << L" workers):\r\n";
+                    sink.Log(rtLog.str());
+
+                    RunBackendPoint(sink, summary, L"std par_unseq",
+                        ParallelBackends::RunStdParallel(mf.data, mf.count, T, nWorkers, config.outputEncoding), seqResult);
+                    const ParallelBackends::OmpSchedule schedules[] = { ParallelBackends::OmpSchedule::Static,
+                        ParallelBackends::OmpSchedule::Dynamic, ParallelBackends::OmpSchedule::Guided };
+                    for (ParallelBackends::OmpSchedule sched : schedules) {
+                        RunBackendPoint(sink, summary, std::wstring(L"openmp ") + ParallelBackends::OmpScheduleName(sched),
+                            ParallelBackends::RunOpenMP(mf.data, mf.count, T, nWorkers, sched, config.outputEncoding), seqResult);
+                    }
 
-                if (staticVal.passed) {
-                    LogToUI(hwnd, L"    Validation: ✓ PASS\r\n\r\n");
-                }
-                else {
-                    summary.totalFailures++;
-                    std::wstringstream valErr;
-                    valErr << L"    Validation: ✗ FAIL (missing: " << staticVal.missingCount
-                        << L", extra: " << staticVal.extraCount << L")\r\n\r\n";
-                    LogToUI(hwnd, valErr.str());
+                    sink.Log(L"\r\n");
                 }
 
-                LogToUI(hwnd, L"  Running Parallel Dynamic...\r\n");
-                ParallelDynamic::ParallelDynamicResult dynamicResult =
-                    ParallelDynamic::RunParallelDynamic(mf.data, mf.count, T, nWorkers);
+                if (config.comparePolicies) {
+                    std::wstringstream polLog;
+                    polLog << L"  Scheduling policies (" << nWorkers << L" workers):\r\n";
 
-                std::wstringstream dynamicLog;
-                dynamicLog << L"    Time: " << Timing::FormatMicros(dynamicResult.time_us)
-                    << L" (Speedup: " << std::fixed << std::setprecision(2)
-                    << (seqResult.time_us / dynamicResult.time_us) << L"x)\r\n"
-                    << L"    Found: " << dynamicResult.totalCount << L" values\r\n";
-                LogToUI(hwnd, dynamicLog.str());
+                    for (Scheduling::PolicyKind kind : Scheduling::AllPolicyKinds()) {
+                        std::unique_ptr<Scheduling::ChunkPolicy> policy = Scheduling::CreatePolicy(kind);
+                        ParallelDynamic::DynamicOptions polOpts = dynamicOpts;
+                        polOpts.policy = policy.get();
 
-                Validation::ValidationResult dynamicVal =
-                    Validation::ValidateResults(seqResult.found, dynamicResult.unionSet);
+                        ParallelDynamic::ParallelDynamicResult pr =
+                            ParallelDynamic::RunParallelDynamic(mf.data, mf.count, T, nWorkers, polOpts);
 
-                summary.totalTests++;
-                UpdateMethodStats(summary.parallelDynamic, dynamicResult.time_us, dynamicVal.passed);
+                        polLog << L"    " << std::left << std::setw(20) << policy->Name() << std::right
+                            << L" makespan " << Timing::FormatMicros(pr.time_us)
+                            << L", dispatches " << pr.telemetry.dispatchCount
+                            << L", tail idle " << Timing::FormatMicros(pr.telemetry.tailIdle_us)
+                            << (pr.totalCount == seqResult.count ? L"" : L"  COUNT MISMATCH")
+                            << (pr.io.error.empty() ? L"" : L"  OUTPUT ERROR: " + pr.io.error) << L"\r\n";
 
-                if (dynamicVal.passed) {
-                    LogToUI(hwnd, L"    Validation: ✓ PASS\r\n\r\n");
-                }
-                else {
-                    summary.totalFailures++;
-                    std::wstringstream valErr;
-                    valErr << L"    Validation: ✗ FAIL (missing: " << dynamicVal.missingCount
-                        << L", extra: " << dynamicVal.extraCount << L")\r\n\r\n";
-                    LogToUI(hwnd, valErr.str());
+                        summary.totalTests++;
+                        if (pr.totalCount != seqResult.count || !pr.io.error.empty()) summary.totalFailures++;
+                    }
+                    polLog << L"\r\n";
+                    sink.Log(polLog.str());
                 }
 
-                Sleep(0);
+                Platform::YieldThread();
             }
 
-            LogToUI(hwnd, L"\r\n");
+            sink.Log(L"\r\n");
         }
 
-        std::wstringstream summaryLog;
-        summaryLog << L"========================================\r\nFINAL SUMMARY\r\n========================================\r\n\r\n"
-            << L"Total Tests Run: " << summary.totalTests << L"\r\n"
-            << L"Total Failures: " << summary.totalFailures << L"\r\n\r\n";
+        std::wstringstream notes;
+        if (!replicas.copies.empty()) {
+            // one-off cost, to set against the per-run gains of node-local reads
+            notes << L"Input replication (once, " << replicas.nodes.size() << L" node(s)): "
+                << Timing::FormatMicros(replicas.time_us) << L"\r\n\r\n";
+        }
+        LogFinalSummary(sink, summary, notes.str());
+        return true;
+    }
 
-        if (summary.sequential.minTime != DBL_MAX) {
-            summaryLog << L"Sequential:\r\n"
-                << L"  Min time: " << Timing::FormatMicros(summary.sequential.minTime) << L"\r\n"
-                << L"  Max time: " << Timing::FormatMicros(summary.sequential.maxTime) << L"\r\n\r\n";
+    static bool IsBackend(Experiment::Method method) {
+        return method == Experiment::Method::StdPar || method == Experiment::Method::OpenMP;
+    }
+
+    bool RunExperimentPlan(const Experiment::RunPlan& plan, ProgressSink& sink, TestSummary& summary) {
+        summary = TestSummary();
+        summary.totalTests = 0;
+        summary.totalFailures = 0;
+
+        sink.Log(L"========================================\r\nEXPERIMENT PLAN\r\n========================================\r\n\r\n");
+        sink.Log(Experiment::DescribePlan(plan) + L"Results folder: " + FileIO::GetResultsRootPath() + L"\r\n\r\n");
+        if (plan.points.empty()) {
+            sink.Log(L"ERROR: The plan has no runs\r\n");
+            return false;
         }
 
-        summaryLog << L"Parallel Static:\r\n"
-            << L"  Min time: " << Timing::FormatMicros(summary.parallelStatic.minTime) << L"\r\n"
-            << L"  Max time: " << Timing::FormatMicros(summary.parallelStatic.maxTime) << L"\r\n"
-            << L"  Validations passed: " << summary.parallelStatic.validationsPassed << L"\r\n"
-            << L"  Validations failed: " << summary.parallelStatic.validationsFailed << L"\r\n\r\n"
-            << L"Parallel Dynamic:\r\n"
-            << L"  Min time: " << Timing::FormatMicros(summary.parallelDynamic.minTime) << L"\r\n"
-            << L"  Max time: " << Timing::FormatMicros(summary.parallelDynamic.maxTime) << L"\r\n"
-            << L"  Validations passed: " << summary.parallelDynamic.validationsPassed << L"\r\n"
-            << L"  Validations failed: " << summary.parallelDynamic.validationsFailed << L"\r\n\r\n";
+        double estimate_us = 0.0;
+        std::wstring report, err;
+        if (!Experiment::EstimateRunTime(plan, estimate_us, report, err)) {
+            sink.Log(L"ERROR: " + err + L"\r\n");
+            return false;
+        }
+        sink.Log(report + L"\r\n");
 
-        summaryLog << (summary.totalFailures == 0 ? L"✓ ALL TESTS PASSED!\r\n" : L"✗ SOME TESTS FAILED - Review results above\r\n");
-        summaryLog << L"\r\n========================================\r\n";
-        LogToUI(hwnd, summaryLog.str());
+        if (!ThreadPool::Initialize(plan.maxWorkers + 1, err)) {
+            sink.Log(L"WARNING: Thread pool pre-start failed (" + err + L"), threads will be created on demand\r\n");
+        }
 
-        PostMessageW(hwnd, WM_ORCHESTRATION_COMPLETE, 0, 0);
-        return 0;
-    }
+        struct PoolGuard {
+            ~PoolGuard() { ThreadPool::Shutdown(); }
+        } poolGuard;
 
-    void StartOrchestration(HWND targetWindow, const TestConfig& config) {
-        OrchestrationThreadData* data = new OrchestrationThreadData();
-        data->targetWindow = targetWindow;
-        data->config = config;
+        FileIO::MappedFile mf;
+        struct FileGuard {
+            FileIO::MappedFile& mf;
+            explicit FileGuard(FileIO::MappedFile& file) : mf(file) {}
+            ~FileGuard() { FileIO::UnmapFile(mf); }
+        } fileGuard(mf);
 
-        HANDLE hThread = reinterpret_cast<HANDLE>(_beginthreadex(nullptr, 0, OrchestrationThread, data, 0, nullptr));
+        // Per-input caches: the reference count per T and, for cost-balanced static, the cost model
+        std::map<uint32_t, Sequential::SequentialResult> references;
+        std::map<uint32_t, CostModel::BlockCosts> costs;
 
-        if (hThread) {
-            CloseHandle(hThread);  // Thread continues running; we don't need the handle
-        }
-        else {
-            delete data;
-            MessageBoxW(targetWindow, L"Failed to create orchestration thread", L"Error", MB_OK | MB_ICONERROR);
+        const Experiment::RunPoint* prev = nullptr;
+        Timing::Ticks start = Timing::Now();
+
+        for (const Experiment::RunPoint& p : plan.points) {
+            bool newGroup = !prev || p.input != prev->input || p.pinPolicy != prev->pinPolicy
+                || p.waitPolicy != prev->waitPolicy || p.T != prev->T;
+            bool newWorkers = newGroup || prev->method == Experiment::Method::Sequential || p.nWorkers != prev->nWorkers;
+
+            // backend results are one line each; close their block before the next header or runner
+            if (prev && IsBackend(prev->method) && (newWorkers || !IsBackend(p.method))) sink.Log(L"\r\n");
+
+            if (!prev || p.input != prev->input) {
+                FileIO::UnmapFile(mf);
+                references.clear();
+                costs.clear();
+                if (!FileIO::MapBinaryUInt32File(plan.inputs[p.input], mf, err)) {
+                    sink.Log(L"ERROR: Failed to map input file: " + err + L"\r\n");
+                    return false;
+                }
+                sink.Log(L"Input File: " + plan.inputs[p.input] + L" (" + std::to_wstring(mf.count) + L" values)\r\n\r\n");
+            }
+
+            if (!prev || p.input != prev->input || p.pinPolicy != prev->pinPolicy) {
+                ThreadPool::SetPlacement(p.pinPolicy);
+                if (p.pinPolicy != Topology::PinPolicy::None && !Topology::PinControlThread(p.pinPolicy, err)) {
+                    sink.Log(L"WARNING: Could not pin orchestration thread: " + err + L"\r\n");
+                }
+            }
+
+            if (newGroup) {
+                std::wstringstream tHeader;
+                tHeader << L"========================================\r\nTesting with T = " << p.T
+                    << L" (pin " << Topology::PolicyName(p.pinPolicy) << L", wait " << Sync::WaitPolicyName(p.waitPolicy)
+                    << L")\r\n========================================\r\n\r\n";
+                sink.Log(tHeader.str());
+            }
+
+            // Sequential sorts first in its group, so its timed count becomes the reference
+            if (p.method == Experiment::Method::Sequential) {
+                references[p.T] = RunSequentialPoint(sink, summary, mf, p.T, p.repetitions,
+                    p.outputBufferBytes, p.outputEncoding, p.uncachedOutput);
+                prev = &p;
+                continue;
+            }
+            if (references.find(p.T) == references.end()) {
+                Sequential::SequentialResult ref{};
+                ref.count = Sequential::CountMatches(mf.data, mf.count, p.T);
+                references[p.T] = ref;
+                sink.Log(L"Reference count (not timed): " + std::to_wstring(ref.count) + L" values\r\n\r\n");
+            }
+            const Sequential::SequentialResult& seqResult = references[p.T];
+
+            if (newWorkers) {
+                std::wstringstream workerHeader;
+                workerHeader << L"Testing with " << p.nWorkers << L" workers:\r\n----------------------------------\r\n";
+                sink.Log(workerHeader.str());
+            }
+
+            switch (p.method) {
+            case Experiment::Method::Static: {
+                ParallelStatic::StaticOptions staticOpts;
+                staticOpts.waitPolicy = p.waitPolicy;
+                staticOpts.outputBufferBytes = p.outputBufferBytes;
+                staticOpts.outputEncoding = p.outputEncoding;
+                staticOpts.segmentMode = p.segmentMode;
+                staticOpts.writerThreads = p.writerThreads;
+                staticOpts.writerQueue = p.writerQueue;
+                staticOpts.writerBackend = p.writerBackend;
+                staticOpts.uncachedOutput = p.uncachedOutput;
+                if (p.split == Experiment::StaticSplit::Cost) {
+                    auto it = costs.find(p.T);
+                    if (it == costs.end()) it = costs.emplace(p.T, CostModel::EstimateBlockCosts(mf.data, mf.count, p.T, 0, 16)).first;
+                    staticOpts.costs = &it->second;
+                }
+                RunStaticPoint(sink, summary, mf, p.T, p.nWorkers, p.repetitions, staticOpts, seqResult);
+                break;
+            }
+            case Experiment::Method::Dynamic: {
+                std::unique_ptr<Scheduling::ChunkPolicy> policy = Scheduling::CreatePolicy(p.policy);
+                ParallelDynamic::DynamicOptions dynamicOpts;
+                dynamicOpts.policy = policy.get();
+                dynamicOpts.waitPolicy = p.waitPolicy;
+                dynamicOpts.outputBufferBytes = p.outputBufferBytes;
+                dynamicOpts.outputEncoding = p.outputEncoding;
+                dynamicOpts.segmentMode = p.segmentMode;
+                dynamicOpts.writerThreads = p.writerThreads;
+                dynamicOpts.writerQueue = p.writerQueue;
+                dynamicOpts.writerBackend = p.writerBackend;
+                dynamicOpts.uncachedOutput = p.uncachedOutput;
+                RunDynamicPoint(sink, summary, mf, p.T, p.nWorkers, p.repetitions, dynamicOpts, seqResult,
+                    p.policy == Scheduling::PolicyKind::Adaptive);
+                break;
+            }
+            case Experiment::Method::StdPar:
+                RunBackendPoint(sink, summary, L"std par_unseq", BestOf<ParallelBackends::BackendResult>(p.repetitions,
+                    [&] { return ParallelBackends::RunStdParallel(mf.data, mf.count, p.T, p.nWorkers, p.outputEncoding); }), seqResult);
+                break;
+            case Experiment::Method::OpenMP:
+                RunBackendPoint(sink, summary, std::wstring(L"openmp ") + ParallelBackends::OmpScheduleName(p.schedule),
+                    BestOf<ParallelBackends::BackendResult>(p.repetitions,
+                        [&] { return ParallelBackends::RunOpenMP(mf.data, mf.count, p.T, p.nWorkers, p.schedule, p.outputEncoding); }), seqResult);
+                break;
+            default:
+                break;
+            }
+
+            prev = &p;
+            Platform::YieldThread();
         }
+
+        if (prev && IsBackend(prev->method)) sink.Log(L"\r\n");
+
+        std::wstringstream notes;
+        notes << L"Plan time: " << Timing::FormatMicros(Timing::ElapsedMicros(start, Timing::Now()))
+            << L" (estimated " << Timing::FormatMicros(estimate_us) << L")\r\n\r\n";
+        LogFinalSummary(sink, summary, notes.str());
+        return true;
     }
 }
\ No newline at end of file
@@ -2,13 +2,49 @@
 #include <cstdint>
 #include <vector>
 #include <string>
-#include <windows.h>
+#include <cfloat>
+#include "topology.h"
+#include "sync_wait.h"
+#include "result_writer.h"
+
+namespace Experiment { struct RunPlan; }
 
 namespace Orchestration {
+    // Where per-worker throughput weights for hybrid P/E CPUs come from
+    enum class CoreWeighting {
+        None,       // Every worker counts the same
+        Declared,   // Topology throughput (efficiency class or topology file)
+        Measured    // Calibrated on the pinned pool threads before the sweep
+    };
+
     struct TestConfig {
         std::wstring inputFilePath;
         std::vector<uint32_t> tValues;
+        uint32_t minWorkers = 1;  // Worker counts minWorkers..maxWorkers are swept
         uint32_t maxWorkers;  // 2*P
+        bool runSequential = true;  // Methods in the sweep; the sequential count is the reference either way
+        bool runStatic = true;
+        bool runDynamic = true;
+        uint32_t repetitions = 1;  // Runs per method and point; the fastest is reported
+        std::wstring outputDir;  // Results root (static/, dinamic/, ...); empty = FileIO default
+        bool costBalancedStatic = false;  // Place static boundaries from a sampled cost model
+        Topology::PinPolicy pinPolicy = Topology::PinPolicy::None;  // Worker thread placement
+        CoreWeighting coreWeighting = CoreWeighting::None;  // Weighted static split / dynamic chunks
+        std::wstring topologyFile;  // Optional declared topology (see Topology::LoadFromFile)
+        bool adaptiveChunks = false;  // Feedback-driven dynamic chunk sizing
+        bool comparePolicies = false;  // Also run every Scheduling::PolicyKind per worker count
+        bool numaQueues = false;  // Per-NUMA-node dynamic queues with cross-node stealing
+        bool replicateInput = false;  // Workers read a copy of the input on their own NUMA node
+        Sync::WaitPolicy waitPolicy = Sync::WaitPolicy::Block;  // Start barrier and dynamic handshake waits
+        bool elasticDemo = false;  // At 2P workers, also run dynamic with the worker count halved mid-run
+        bool runtimeBackends = false;  // Also run std::execution::par_unseq and OpenMP per worker count
+        size_t outputBufferBytes = ResultWriter::kDefaultBufferBytes;  // Per-worker result buffer, 0 = one write per value
+        FileIO::ResultEncoding outputEncoding = FileIO::ResultEncoding::Utf16;  // Result files: UTF-16LE (original) or UTF-8
+        ResultWriter::SegmentMode segmentMode = ResultWriter::SegmentMode::TempFiles;  // Static/dynamic: temp files + merge, or in place
+        uint32_t writerThreads = 0;  // Static/dynamic: threads that write full worker buffers, 0 = workers write
+        uint32_t writerQueue = 0;  // Full buffers that may wait for those threads, 0 = one per worker
+        AsyncWriter::Backend writerBackend = AsyncWriter::Backend::Threads;  // Writer threads or one io_uring thread
+        bool uncachedOutput = false;  // Result writes skip the page cache in whole blocks; known sizes preallocated
     };
 
     struct MethodStats {
@@ -30,18 +66,21 @@ namespace Orchestration {
         uint32_t totalFailures;
     };
 
-    // Thread parameter structure
-    struct OrchestrationThreadData {
-        HWND targetWindow;
-        TestConfig config;
+    // Receives the engine's progress text; the GUI forwards it to its window
+    // (orchestration_gui.h), the CLI prints it. Called on the engine's thread.
+    class ProgressSink {
+    public:
+        virtual ~ProgressSink() = default;
+        virtual void Log(const std::wstring& message) = 0;
     };
 
-    // Custom message for UI updates
-#define WM_ORCHESTRATION_LOG (WM_USER + 100)
-#define WM_ORCHESTRATION_COMPLETE (WM_USER + 101)
+    // Run the whole sweep on the calling thread. False if it could not start
+    // (input not mappable, ...); validation failures show up in summary.totalFailures.
+    bool RunTestSuite(const TestConfig& config, ProgressSink& sink, TestSummary& summary);
 
-// Start orchestration in background thread
-    void StartOrchestration(HWND targetWindow, const TestConfig& config);
+    // Run an expanded experiment spec (experiment.h) point by point, in plan order,
+    // after logging the plan and its estimated run time. Same return convention.
+    bool RunExperimentPlan(const Experiment::RunPlan& plan, ProgressSink& sink, TestSummary& summary);
 
     // Get physical core count
     uint32_t GetPhysicalCoreCount();
@@ -0,0 +1,72 @@
+#include "orchestration_gui.h"
+#include "experiment.h"
+#include <process.h>
+
+namespace Orchestration {
+
+    // Posts every log line to the window; the UI thread frees the copy
+    class WindowSink : public ProgressSink {
+    public:
+        explicit WindowSink(HWND hwnd) : hwnd(hwnd) {}
+
+        void Log(const std::wstring& message) override {
+            wchar_t* msg = new wchar_t[message.length() + 1];
+            wcscpy_s(msg, message.length() + 1, message.c_str());
+            PostMessageW(hwnd, WM_ORCHESTRATION_LOG, 0, reinterpret_cast<LPARAM>(msg));
+        }
+
+    private:
+        HWND hwnd;
+    };
+
+    // Thread parameter structure
+    struct OrchestrationThreadData {
+        HWND targetWindow;
+        bool runPlan = false;   // plan instead of config
+        TestConfig config;
+        Experiment::RunPlan plan;
+    };
+
+    static unsigned int __stdcall OrchestrationThread(void* param) {
+        OrchestrationThreadData* data = static_cast<OrchestrationThreadData*>(param);
+        HWND hwnd = data->targetWindow;
+
+        WindowSink sink(hwnd);
+        TestSummary summary;
+        bool ran = data->runPlan
+            ? RunExperimentPlan(data->plan, sink, summary)
+            : RunTestSuite(data->config, sink, summary);
+        delete data;
+
+        PostMessageW(hwnd, WM_ORCHESTRATION_COMPLETE, 0, 0);
+        return ran ? 0 : 1;
+    }
+
+    static void LaunchThread(OrchestrationThreadData* data) {
+        HWND targetWindow = data->targetWindow;
+        HANDLE hThread = reinterpret_cast<HANDLE>(_beginthreadex(nullptr, 0, OrchestrationThread, data, 0, nullptr));
+
+        if (hThread) {
+            CloseHandle(hThread);  // Thread continues running; we don't need the handle
+        }
+        else {
+            delete data;
+            MessageBoxW(targetWindow, L"Failed to create orchestration thread", L"Error", MB_OK | MB_ICONERROR);
+        }
+    }
+
+    void StartOrchestration(HWND targetWindow, const TestConfig& config) {
+        OrchestrationThreadData* data = new OrchestrationThreadData();
+        data->targetWindow = targetWindow;
+        data->config = config;
+        LaunchThread(data);
+    }
+
+    void StartExperimentPlan(HWND targetWindow, const Experiment::RunPlan& plan) {
+        OrchestrationThreadData* data = new OrchestrationThreadData();
+        data->targetWindow = targetWindow;
+        data->runPlan = true;
+        data->plan = plan;
+        LaunchThread(data);
+    }
+}
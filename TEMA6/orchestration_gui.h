@@ -0,0 +1,17 @@
+#pragma once
+#include <windows.h>
+#include "orchestration.h"
+
+// GUI front end of the orchestration engine: runs RunTestSuite or RunExperimentPlan
+// on a background thread and forwards its progress to a window as messages.
+namespace Orchestration {
+    // Custom message for UI updates
+#define WM_ORCHESTRATION_LOG (WM_USER + 100)       // lParam: new[]'d wchar_t text, receiver deletes
+#define WM_ORCHESTRATION_COMPLETE (WM_USER + 101)
+
+// Start orchestration in background thread
+    void StartOrchestration(HWND targetWindow, const TestConfig& config);
+
+    // Same, for an expanded experiment spec
+    void StartExperimentPlan(HWND targetWindow, const Experiment::RunPlan& plan);
+}
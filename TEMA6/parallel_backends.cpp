@@ -0,0 +1,344 @@
+#include "parallel_backends.h"
+#include "collatz.h"
+#include "timing.h"
+#include "fileio.h"
+#include "result_writer.h"
+#include "result_bitmap.h"
+#include "sync_wait.h"
+#include "platform.h"
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <memory>
+#include <numeric>
+#include <algorithm>
+#include <execution>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace ParallelBackends {
+
+    static constexpr uint32_t kChunksPerLine = 8;     // std backend: chunk ranges per output line
+    static constexpr size_t kOmpBlock = 4096;         // OpenMP: values per loop iteration
+    static_assert(kOmpBlock % ResultBitmap::kWordBits == 0, "OpenMP blocks must be whole bitmap words");
+
+    // One output line: its temp file and counter, on a line of its own
+    struct alignas(Sync::kCacheLine) OutputLine {
+        std::wstring tempPath;
+        Platform::FileHandle hTmp = Platform::kInvalidFile;
+        uint64_t count = 0;
+        ResultWriter::BufferedWriter out;
+        ResultBitmap::RangeWriter bits;     // Bitmap: writes into SharedBitmap instead
+    };
+
+    // Bitmap encoding: the one result file all lines put their words into
+    struct SharedBitmap {
+        std::wstring path;
+        Platform::FileHandle file = Platform::kInvalidFile;
+    };
+
+    static void AppendValue(OutputLine& line, uint32_t x) {
+        if (line.out.AppendValue(x)) line.count++;
+    }
+
+    // temp files and buffers are set up before the timed section, like the runners' prepare step
+    static bool OpenLines(std::vector<OutputLine>& lines, const std::wstring& folder, uint32_t T, const wchar_t* tag,
+        FileIO::ResultEncoding encoding, SharedBitmap& bitmap, std::wstring& err) {
+        if (encoding == FileIO::ResultEncoding::Bitmap) {
+            bitmap.path = FileIO::MakeTempPath(folder, T, (uint32_t)lines.size(), 0, tag);
+            if (!FileIO::CreateResultsFileWithAcl(bitmap.path, bitmap.file, err)) return false;
+            for (OutputLine& line : lines) {
+                if (!line.bits.Open(bitmap.file, ResultWriter::kDefaultBufferBytes, err)) return false;
+            }
+            return true;
+        }
+        for (uint32_t i = 0; i < lines.size(); i++) {
+            lines[i].tempPath = FileIO::MakeTempPath(folder, T, (uint32_t)lines.size(), i, tag);
+            lines[i].hTmp = Platform::OpenFile(lines[i].tempPath, Platform::FileMode::Temp, err);
+            if (lines[i].hTmp == Platform::kInvalidFile) return false;
+            if (!lines[i].out.Open(lines[i].hTmp, ResultWriter::kDefaultBufferBytes, encoding, err)) return false;
+        }
+        return true;
+    }
+
+    // the final flush happens in the timed section (out.Flush() per line); this only releases handles
+    static void CloseLines(std::vector<OutputLine>& lines) {
+        for (OutputLine& line : lines) {
+            line.out.Close();
+            line.bits.Close();
+            if (line.hTmp != Platform::kInvalidFile) Platform::CloseFile(line.hTmp);
+            line.hTmp = Platform::kInvalidFile;
+        }
+    }
+
+    // setup failed: nothing was run, drop whatever OpenLines created
+    static void DiscardLines(std::vector<OutputLine>& lines, SharedBitmap& bitmap) {
+        CloseLines(lines);
+        for (const OutputLine& line : lines) {
+            if (!line.tempPath.empty()) Platform::RemoveFile(line.tempPath);
+        }
+        if (bitmap.file != Platform::kInvalidFile) Platform::CloseFile(bitmap.file);
+        if (!bitmap.path.empty()) Platform::RemoveFile(bitmap.path);
+    }
+
+    // Bitmap: the words are in place already; header, then the final name
+    static void FinishBitmap(const std::wstring& path, uint32_t T, size_t n, std::vector<OutputLine>& lines,
+        SharedBitmap& bitmap, BackendResult& result) {
+        result.lineCounts.resize(lines.size());
+        for (uint32_t i = 0; i < lines.size(); i++) {
+            result.io.Add(lines[i].bits.Stats());
+            result.lineCounts[i] = (size_t)lines[i].count;
+            result.totalCount += (size_t)lines[i].count;
+        }
+
+        ResultBitmap::Header header;
+        header.T = T;
+        header.n = n;
+        header.count = result.totalCount;
+        header.time_us = result.time_us;
+        std::wstring err;
+        if (!ResultBitmap::WriteHeader(bitmap.file, header, err)) {
+            Platform::DebugLog(L"Backend bitmap header failed: " + err);
+            result.io.Fail(L"Result header failed: " + err);
+        }
+        Platform::CloseFile(bitmap.file);
+        bitmap.file = Platform::kInvalidFile;
+        if (!Platform::RenameFile(bitmap.path, path)) {
+            std::wstring renameErr = Platform::LastErrorText();
+            Platform::DebugLog(L"Rename backend bitmap failed: " + renameErr);
+            result.io.Fail(L"Rename result file failed: " + renameErr);
+            Platform::RemoveFile(bitmap.path);
+        }
+    }
+
+    // ...\rezultate\<backend>\<T>_<nWorkers>_<time>.txt (.bin, .bits), same layout as static/dynamic
+    static void WriteOutput(const std::wstring& folder, uint32_t T, size_t n, std::vector<OutputLine>& lines,
+        FileIO::ResultEncoding encoding, SharedBitmap& bitmap, BackendResult& result) {
+        std::wstringstream name;
+        name << folder << Platform::kPathSep
+            << T << L"_"
+            << lines.size() << L"_"
+            << std::fixed << std::setprecision(0) << result.time_us
+            << FileIO::ResultExtension(encoding);
+        if (encoding == FileIO::ResultEncoding::Bitmap) {
+            FinishBitmap(name.str(), T, n, lines, bitmap, result);
+            return;
+        }
+
+        std::wstring err;
+        Platform::FileHandle hOut = Platform::kInvalidFile;
+        bool opened = FileIO::CreateResultsFileWithAcl(name.str(), hOut, err);
+        if (!opened) Platform::DebugLog(L"Create backend output failed: " + err);
+
+        result.lineCounts.resize(lines.size());
+        std::vector<ResultWriter::Segment> segments(lines.size());
+        for (uint32_t i = 0; i < lines.size(); i++) {
+            result.io.Add(lines[i].out.Stats());
+            result.lineCounts[i] = (size_t)lines[i].count;
+            result.totalCount += (size_t)lines[i].count;
+            segments[i] = { lines[i].tempPath, lines[i].count, lines[i].out.Stats().bytes, 0.0 };
+        }
+
+        if (!opened) {
+            result.io.Fail(L"Create result file failed: " + err);
+            for (const ResultWriter::Segment& s : segments) Platform::RemoveFile(s.path);
+            return;
+        }
+        if (!ResultWriter::MergeSegments(hOut, segments, encoding, T, result.time_us, false, err)) {
+            Platform::DebugLog(L"Backend merge failed: " + err);
+            result.io.Fail(L"Merge failed: " + err);
+        }
+        Platform::CloseFile(hOut);
+    }
+
+    const wchar_t* OmpScheduleName(OmpSchedule schedule) {
+        switch (schedule) {
+        case OmpSchedule::Static: return L"static";
+        case OmpSchedule::Dynamic: return L"dynamic";
+        case OmpSchedule::Guided: return L"guided";
+        default: return L"unknown";
+        }
+    }
+
+    BackendResult RunStdParallel(const uint32_t* v, size_t n, uint32_t T, uint32_t nWorkers, FileIO::ResultEncoding encoding) {
+        BackendResult result;
+        if (!v || n == 0 || nWorkers == 0) return result;
+        if (nWorkers > n) nWorkers = (uint32_t)n;
+
+        const std::wstring folder = FileIO::GetBackendResultsPath(L"stdpar");
+        std::vector<OutputLine> lines(nWorkers);
+        SharedBitmap bitmap;
+        std::wstring err;
+        if (!OpenLines(lines, folder, T, L"stdpar", encoding, bitmap, err)) {
+            result.io.Fail(L"Output setup failed: " + err);
+            DiscardLines(lines, bitmap);
+            return result;
+        }
+        const bool bitmapMode = encoding == FileIO::ResultEncoding::Bitmap;
+
+        const size_t nChunks = (size_t)nWorkers * kChunksPerLine < n ? (size_t)nWorkers * kChunksPerLine : n;
+        std::vector<size_t> chunkIds(nChunks);
+        std::iota(chunkIds.begin(), chunkIds.end(), (size_t)0);
+        std::vector<uint32_t> lineIds(nWorkers);
+        std::iota(lineIds.begin(), lineIds.end(), 0u);
+
+        // chunk c gathers its hits at the front of its own range of hits[]: no allocation,
+        // no locks, nothing shared, as par_unseq requires. Bitmap: chunk c builds its own
+        // words of words[] instead, so its edges sit on word boundaries
+        std::unique_ptr<uint32_t[]> hits(bitmapMode ? nullptr : new uint32_t[n]);
+        std::unique_ptr<uint64_t[]> words(bitmapMode ? new uint64_t[ResultBitmap::WordCount(n)] : nullptr);
+        std::vector<size_t> chunkHits(nChunks, 0);
+        auto chunkBegin = [n, nChunks, bitmapMode](size_t c) {
+            if (c == nChunks) return n;
+            size_t first = (size_t)((double)n * c / nChunks);
+            return bitmapMode ? ResultBitmap::AlignDown(first) : first;
+        };
+
+        Timing::Ticks start = Timing::Now();
+
+        std::for_each(std::execution::par_unseq, chunkIds.begin(), chunkIds.end(), [&](size_t c) {
+            size_t first = chunkBegin(c), last = chunkBegin(c + 1), k = first;
+            if (bitmapMode) {
+                for (size_t w = first; w < last; w += ResultBitmap::kWordBits) {
+                    size_t end = w + ResultBitmap::kWordBits < last ? w + ResultBitmap::kWordBits : last;
+                    uint64_t word = 0;
+                    for (size_t i = w; i < end; i++) {
+                        uint64_t hit = Collatz::CollatzAtLeastT(v[i], T) ? 1 : 0;
+                        word |= hit << (i - w);
+                        k += hit;
+                    }
+                    words[w / ResultBitmap::kWordBits] = ResultBitmap::ToFileOrder(word);
+                }
+            }
+            else {
+                for (size_t i = first; i < last; i++) {
+                    if (Collatz::CollatzAtLeastT(v[i], T)) hits[k++] = v[i];
+                }
+            }
+            chunkHits[c] = k - first;
+        });
+
+        // output is I/O: sequenced per line, parallel across lines
+        std::for_each(std::execution::par, lineIds.begin(), lineIds.end(), [&](uint32_t line) {
+            size_t c0 = (size_t)line * nChunks / nWorkers, c1 = (size_t)(line + 1) * nChunks / nWorkers;
+            if (bitmapMode) {
+                // the line's chunks are contiguous: one positional write of their words
+                size_t firstWord = chunkBegin(c0) / ResultBitmap::kWordBits;
+                for (size_t c = c0; c < c1; c++) lines[line].count += chunkHits[c];
+                lines[line].bits.PutWords(chunkBegin(c0), words.get() + firstWord,
+                    ResultBitmap::WordCount(chunkBegin(c1)) - firstWord);
+                return;
+            }
+            for (size_t c = c0; c < c1; c++) {
+                const uint32_t* h = hits.get() + chunkBegin(c);
+                for (size_t j = 0; j < chunkHits[c]; j++) AppendValue(lines[line], h[j]);
+            }
+            lines[line].out.Flush();
+        });
+
+        result.time_us = Timing::ElapsedMicros(start, Timing::Now());
+
+        CloseLines(lines);
+        WriteOutput(folder, T, n, lines, encoding, bitmap, result);
+        return result;
+    }
+
+#ifdef _OPENMP
+    static void ScanBlockValues(const uint32_t* v, size_t n, uint32_t T, long long block, OutputLine& line) {
+        size_t first = (size_t)block * kOmpBlock;
+        size_t last = first + kOmpBlock < n ? first + kOmpBlock : n;
+        for (size_t i = first; i < last; i++) {
+            if (Collatz::CollatzAtLeastT(v[i], T)) AppendValue(line, v[i]);
+        }
+    }
+
+    // Bitmap: blocks are whole words, so each is a run of the shared file; a thread's
+    // consecutive blocks (schedule(static)) keep filling the same buffer
+    static void ScanBlockBits(const uint32_t* v, size_t n, uint32_t T, long long block, OutputLine& line) {
+        size_t first = (size_t)block * kOmpBlock;
+        size_t last = first + kOmpBlock < n ? first + kOmpBlock : n;
+        uint64_t count = 0;
+        line.bits.Begin(first);
+        for (size_t i = first; i < last; i++) {
+            bool hit = Collatz::CollatzAtLeastT(v[i], T);
+            line.bits.Add(hit);
+            count += hit;
+        }
+        line.count += count;
+    }
+
+    static void ScanBlock(const uint32_t* v, size_t n, uint32_t T, long long block, OutputLine& line, bool bitmap) {
+        if (bitmap) ScanBlockBits(v, n, T, block, line);
+        else ScanBlockValues(v, n, T, block, line);
+    }
+#endif
+
+    BackendResult RunOpenMP(const uint32_t* v, size_t n, uint32_t T, uint32_t nWorkers, OmpSchedule schedule,
+        FileIO::ResultEncoding encoding) {
+        BackendResult result;
+#ifndef _OPENMP
+        (void)v; (void)n; (void)T; (void)nWorkers; (void)schedule; (void)encoding;
+        result.available = false;
+        return result;
+#else
+        if (!v || n == 0 || nWorkers == 0) return result;
+        if (nWorkers > n) nWorkers = (uint32_t)n;
+
+        const std::wstring folder = FileIO::GetBackendResultsPath(
+            (std::wstring(L"openmp_") + OmpScheduleName(schedule)).c_str());
+        std::vector<OutputLine> lines(nWorkers);
+        SharedBitmap bitmap;
+        std::wstring err;
+        if (!OpenLines(lines, folder, T, L"omp", encoding, bitmap, err)) {
+            result.io.Fail(L"Output setup failed: " + err);
+            DiscardLines(lines, bitmap);
+            return result;
+        }
+        const bool bitmapMode = encoding == FileIO::ResultEncoding::Bitmap;
+
+        const long long nBlocks = (long long)((n + kOmpBlock - 1) / kOmpBlock);
+
+        Timing::Ticks start = Timing::Now();
+
+        // schedule kinds are compile-time clauses (schedule(runtime) needs OpenMP 3.0,
+        // MSVC ships 2.0), hence one loop per kind; every thread takes the same branch
+#pragma omp parallel num_threads((int)nWorkers)
+        {
+            OutputLine& line = lines[omp_get_thread_num()];
+
+            switch (schedule) {
+            case OmpSchedule::Dynamic:
+#pragma omp for schedule(dynamic)
+                for (long long b = 0; b < nBlocks; b++) ScanBlock(v, n, T, b, line, bitmapMode);
+                break;
+            case OmpSchedule::Guided:
+#pragma omp for schedule(guided)
+                for (long long b = 0; b < nBlocks; b++) ScanBlock(v, n, T, b, line, bitmapMode);
+                break;
+            case OmpSchedule::Static:
+            default:
+#pragma omp for schedule(static)
+                for (long long b = 0; b < nBlocks; b++) ScanBlock(v, n, T, b, line, bitmapMode);
+                break;
+            }
+            if (bitmapMode) line.bits.End();
+            else line.out.Flush();
+        }
+
+        result.time_us = Timing::ElapsedMicros(start, Timing::Now());
+
+        CloseLines(lines);
+        WriteOutput(folder, T, n, lines, encoding, bitmap, result);
+        return result;
+#endif
+    }
+
+    bool OpenMpAvailable() {
+#ifdef _OPENMP
+        return true;
+#else
+        return false;
+#endif
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <cstddef>
+#include "result_writer.h"
+
+namespace ParallelBackends {
+    enum class OmpSchedule {
+        Static,   // schedule(static): contiguous block ranges, one per thread
+        Dynamic,  // schedule(dynamic): one block at a time from a shared counter
+        Guided    // schedule(guided): shrinking runs of blocks
+    };
+
+    const wchar_t* OmpScheduleName(OmpSchedule schedule);
+
+    struct BackendResult {
+        double time_us = 0.0;             // Compute + per-line temp output, as in the hand-written runners
+        size_t totalCount = 0;            // Total count across all lines
+        std::vector<size_t> lineCounts;   // Values on output line i (<i>_<count>:...)
+        bool available = true;            // false when the runtime was not compiled in
+        ResultWriter::WriteStats io;      // Per-line temp-file writes
+    };
+
+    // std::for_each(par_unseq) over nWorkers * 8 chunk ranges (gather into a per-chunk
+    // slice, no I/O in the unsequenced step), then std::for_each(par) over nWorkers
+    // output lines; line i holds slice i of the input. Written to rezultate\stdpar.
+    BackendResult RunStdParallel(const uint32_t* v, size_t n, uint32_t T, uint32_t nWorkers,
+        FileIO::ResultEncoding encoding = FileIO::ResultEncoding::Utf16);
+
+    // OpenMP team of nWorkers threads over 4096-value blocks; line i is what thread i
+    // found. Written to rezultate\openmp_<schedule>.
+    BackendResult RunOpenMP(const uint32_t* v, size_t n, uint32_t T, uint32_t nWorkers, OmpSchedule schedule,
+        FileIO::ResultEncoding encoding = FileIO::ResultEncoding::Utf16);
+
+    // Built with OpenMP (/openmp, -fopenmp)
+    bool OpenMpAvailable();
+}
@@ -2,24 +2,66 @@
 #include "collatz.h"
 #include "timing.h"
 #include "fileio.h"
-#include <windows.h>
-#include <process.h>
+#include "thread_pool.h"
+#include "result_writer.h"
+#include "result_bitmap.h"
+#include "async_writer.h"
+#include "scheduling_policy.h"
+#include "platform.h"
 #include <sstream>
 #include <iomanip>
 #include <vector>
+#include <algorithm>
 
 namespace ParallelDynamic {
 
+    // Worker-count samples at least this far apart, plus one at every change
+    static constexpr double kTimelineInterval_us = 2000.0;
+
     struct Task {
         size_t startIndex;
         size_t endIndex;   // [startIndex, endIndex)
         bool shutdown;
+        bool park;         // retire until the target rises or the work runs out
     };
 
-    struct WorkerSync {
-        HANDLE requestEvent;   // worker -> coordinator
-        HANDLE assignedEvent;  // coordinator -> worker
+    WorkerControl::WorkerControl(uint32_t targetWorkers)
+        : target((int32_t)(targetWorkers > 0x7FFFFFFFu ? 0x7FFFFFFFu : (targetWorkers < 1 ? 1 : targetWorkers))),
+        generation(0) {
+    }
+
+    void WorkerControl::SetTarget(uint32_t workers) {
+        if (workers < 1) workers = 1;
+        if (workers > 0x7FFFFFFFu) workers = 0x7FFFFFFFu;
+        target.exchange((int32_t)workers);
+        Sync::IncrementAndWake(&generation);
+    }
+
+    uint32_t WorkerControl::Target() const {
+        return (uint32_t)target.load();
+    }
+
+    // Written from both sides, so each direction gets its own cache line and
+    // neighbouring workers' slots never share one
+    struct alignas(Sync::kCacheLine) WorkerSync {
+        // coordinator -> worker
+        Sync::Word assigned;       // taskSlot is valid
         Task taskSlot;
+
+        // worker -> coordinator (then requestSeq is bumped); feedback for the
+        // chunk policy is published before requested is set
+        alignas(Sync::kCacheLine) Sync::Word requested;
+        size_t doneElems;          // cumulative elements of finished chunks
+        size_t lastChunkElems;
+        double lastChunkTime_us;
+        double lastWait_us;    // request -> assignment latency of the previous dispatch
+    };
+
+    // Unclaimed range of one NUMA node's slice: owners claim from the front,
+    // thieves from the back
+    struct NodeQueue {
+        size_t next;
+        size_t end;   // [next, end)
     };
 
     struct CoordinatorState {
@@ -27,127 +69,327 @@ namespace ParallelDynamic {
         size_t n;
         uint32_t T;
         uint32_t nWorkers;
-        size_t nextIndex;
+        size_t grain;      // chunk edges are multiples of this (Bitmap: one word), except n
 
-        CRITICAL_SECTION cs;
-        std::vector<WorkerSync>* sync;
+        std::vector<NodeQueue> queues;
+        std::vector<uint32_t> workerQueue;   // worker -> index into queues
+        size_t remainingTotal;
 
-        CoordinatorState() : data(nullptr), n(0), T(0), nWorkers(0), nextIndex(0), sync(nullptr) {
-            InitializeCriticalSection(&cs);
+        Sync::WaitPolicy waitPolicy;
+
+        Platform::Mutex lock;
+        std::vector<WorkerSync>* sync;
+        Scheduling::ChunkPolicy* policy;
+        DynamicTelemetry* telemetry;
+
+        // elastic runs
+        WorkerControl* control;
+        Sync::Word workExhausted;      // set once; parked workers then come back for their shutdown
+        std::vector<uint32_t> liveRank;   // worker -> index among the prepared workers, held against
+                                          // the target; set by the coordinator before its first reply
+        Timing::Ticks startedAt;
+
+        // bumped by every worker on every request: last, on a line of its own, away
+        // from the read-mostly fields above
+        alignas(Sync::kCacheLine) Sync::Word requestSeq;
+
+        CoordinatorState() : data(nullptr), n(0), T(0), nWorkers(0), grain(1), remainingTotal(0),
+            waitPolicy(Sync::WaitPolicy::Block), sync(nullptr), policy(nullptr), telemetry(nullptr),
+            control(nullptr), workExhausted(0), startedAt(0), requestSeq(0) {
         }
-        ~CoordinatorState() { DeleteCriticalSection(&cs); }
     };
 
-    struct WorkerData {
+    struct alignas(Sync::kCacheLine) WorkerData {
         uint32_t workerId;
         CoordinatorState* state;
+        const uint32_t* data;   // this worker's view of the input
 
         uint64_t count = 0;
+        Timing::Ticks finishedAt = 0;   // shutdown received: nothing left to claim
         std::wstring tempPath;
+        Platform::FileHandle hTmp = Platform::kInvalidFile;
+        size_t bufferBytes = ResultWriter::kDefaultBufferBytes;
+        FileIO::ResultEncoding encoding = FileIO::ResultEncoding::Utf16;
+        bool direct = false;                // SegmentMode::Direct: tempPath only takes a spill
+        AsyncWriter::Service* writer = nullptr;   // full buffers go to the run's writer threads
+        bool uncached = false;              // whole blocks of the temp file skip the page cache
+        bool prepared = false;
+        std::wstring prepareError;          // why PrepareWorker failed
+        ResultWriter::BufferedWriter out;
+        ResultBitmap::RangeWriter bits;     // Bitmap: hTmp is the shared result file
+
+        // SegmentMode::Direct, second step
+        uint64_t segmentBytes = 0;
+        Platform::FileHandle hOut = Platform::kInvalidFile;
+        ResultWriter::SegmentPlace place;
     };
 
-    static size_t CalculateChunkSize(size_t remaining, uint32_t nWorkers) {
-        if (remaining == 0) return 0;
-        size_t chunk = remaining / (2ull * nWorkers);
-        if (chunk < 1) chunk = 1;
-        return chunk;
+    // before the start barrier: file creation and the output buffer are not compute time
+    static unsigned int PLATFORM_CALL PrepareWorker(void* param) {
+        WorkerData* wd = static_cast<WorkerData*>(param);
+        std::wstring err;
+        if (wd->encoding == FileIO::ResultEncoding::Bitmap) {
+            wd->prepared = wd->bits.Open(wd->hTmp, wd->bufferBytes, err);
+            if (!wd->prepared) wd->prepareError = err;
+            return 0;
+        }
+        if (wd->direct) {
+            wd->prepared = wd->out.OpenInMemory(ResultWriter::kMaxInMemoryBytes, wd->tempPath, wd->encoding, err);
+            if (!wd->prepared) wd->prepareError = err;
+            return 0;
+        }
+        wd->hTmp = Platform::OpenFile(wd->tempPath, Platform::FileMode::Temp, err);
+        bool opened = wd->hTmp != Platform::kInvalidFile && (wd->writer
+            ? wd->out.OpenQueued(wd->hTmp, *wd->writer, wd->encoding, wd->uncached, err)
+            : wd->uncached ? wd->out.OpenUncached(wd->hTmp, 0, wd->bufferBytes, wd->encoding, err)
+            : wd->out.Open(wd->hTmp, wd->bufferBytes, wd->encoding, err));
+        if (wd->hTmp != Platform::kInvalidFile && !opened) {
+            Platform::CloseFile(wd->hTmp);
+            wd->hTmp = Platform::kInvalidFile;
+        }
+        wd->prepared = wd->hTmp != Platform::kInvalidFile;
+        if (!wd->prepared) wd->prepareError = err;
+        return 0;
     }
 
-    static unsigned int __stdcall WorkerThreadProc(void* param) {
+    static unsigned int PLATFORM_CALL WorkerThreadProc(void* param) {
         WorkerData* wd = static_cast<WorkerData*>(param);
         CoordinatorState* st = wd->state;
 
-        HANDLE hTmp = CreateFileW(wd->tempPath.c_str(), GENERIC_WRITE, FILE_SHARE_READ,
-            nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_TEMPORARY, nullptr);
-        if (hTmp == INVALID_HANDLE_VALUE) return 0;
-
-        bool first = true;
-        wchar_t buf[32];
+        // never asks for work; the coordinator counts it as shut down from the start
+        if (!wd->prepared) return 0;
 
         WorkerSync& ws = (*st->sync)[wd->workerId];
+        const bool bitmap = wd->encoding == FileIO::ResultEncoding::Bitmap;
 
         for (;;) {
-            SetEvent(ws.requestEvent);
+            Timing::Ticks requestedAt = Timing::Now();
+            ws.requested.exchange(1);
+            Sync::IncrementAndWake(&st->requestSeq);
 
-            DWORD w = WaitForSingleObject(ws.assignedEvent, INFINITE);
-            if (w != WAIT_OBJECT_0) break;
+            Sync::WaitWhileEqual(&ws.assigned, 0, st->waitPolicy);
 
+            Timing::Ticks assignedAt = Timing::Now();
             Task t = ws.taskSlot;
-            ResetEvent(ws.assignedEvent);
+            ws.assigned.exchange(0);
 
-            if (t.shutdown) break;
+            if (t.shutdown) {
+                wd->finishedAt = assignedAt;
+                break;
+            }
 
-            for (size_t i = t.startIndex; i < t.endIndex; i++) {
-                uint32_t x = st->data[i];
-                if (!Collatz::CollatzAtLeastT(x, st->T)) continue;
+            if (t.park) {
+                // retired between chunks, so everything written so far stays; wait for a
+                // higher target or for the end of the run, then ask again
+                for (;;) {
+                    int32_t gen = st->control->Generation()->load();
+                    if (st->workExhausted || st->liveRank[wd->workerId] < st->control->Target()) break;
+                    Sync::WaitWhileEqual(st->control->Generation(), gen, Sync::WaitPolicy::Block);
+                }
+                ws.lastChunkElems = 0;   // nothing measured while parked
+                ws.lastChunkTime_us = 0.0;
+                ws.lastWait_us = 0.0;
+                continue;
+            }
 
-                int len = first ? swprintf_s(buf, L"%u", x) : swprintf_s(buf, L",%u", x);
-                first = false;
+            if (bitmap) {
+                // each chunk is its own word-aligned run of the shared bitmap
+                wd->bits.Begin(t.startIndex);
+                uint64_t count = 0;
+                for (size_t i = t.startIndex; i < t.endIndex; i++) {
+                    bool hit = Collatz::CollatzAtLeastT(wd->data[i], st->T);
+                    wd->bits.Add(hit);
+                    count += hit;
+                }
+                wd->bits.End();
+                wd->count += count;
+            }
+            else {
+                for (size_t i = t.startIndex; i < t.endIndex; i++) {
+                    uint32_t x = wd->data[i];
+                    if (!Collatz::CollatzAtLeastT(x, st->T)) continue;
 
-                DWORD bw = 0;
-                if (!WriteFile(hTmp, buf, (DWORD)(len * sizeof(wchar_t)), &bw, nullptr)) {
-                    // disk fail: stop trying
-                    break;
+                    // a failed write latches in the writer; the run reports it through result.io
+                    if (!wd->out.AppendValue(x)) break;
+                    wd->count++;
                 }
-                wd->count++;
             }
+
+            // read by the coordinator on our next request
+            ws.doneElems += t.endIndex - t.startIndex;
+            ws.lastChunkElems = t.endIndex - t.startIndex;
+            ws.lastChunkTime_us = Timing::ElapsedMicros(assignedAt, Timing::Now());
+            ws.lastWait_us = Timing::ElapsedMicros(requestedAt, assignedAt);
         }
 
-        CloseHandle(hTmp);
+        if (bitmap) {
+            wd->bits.Close();   // the file is shared; the run closes it
+            return 0;
+        }
+        if (wd->direct) {
+            wd->segmentBytes = wd->out.SegmentBytes();   // written once every size is known
+            return 0;
+        }
+        wd->out.Close();
+        Platform::CloseFile(wd->hTmp);
+        return 0;
+    }
+
+    // SegmentMode::Direct: the worker's segment and framing at its final offset
+    static unsigned int PLATFORM_CALL PlaceSegment(void* param) {
+        WorkerData* wd = static_cast<WorkerData*>(param);
+        if (wd->prepared) wd->out.WritePlaced(wd->hOut, wd->place);
         return 0;
     }
 
     struct CoordinatorThreadData {
         CoordinatorState* st;
-        std::vector<HANDLE> requestEvents;
+        const std::vector<WorkerData>* workers;   // prepared flags, final after the start barrier
     };
 
-    static unsigned int __stdcall CoordinatorThreadProc(void* param) {
+    // Queue with the most unclaimed work (only called while remainingTotal > 0)
+    static NodeQueue& FullestQueue(CoordinatorState* st) {
+        size_t best = 0;
+        for (size_t q = 1; q < st->queues.size(); q++) {
+            if (st->queues[q].end - st->queues[q].next > st->queues[best].end - st->queues[best].next) best = q;
+        }
+        return st->queues[best];
+    }
+
+    static void SampleTimeline(CoordinatorState* st, uint32_t activeWorkers, size_t elementsDone, bool force) {
+        double t = Timing::ElapsedMicros(st->startedAt, Timing::Now());
+        std::vector<ElasticSample>& tl = st->telemetry->timeline;
+        if (!force && !tl.empty() && t - tl.back().t_us < kTimelineInterval_us) return;
+        tl.push_back({ t, activeWorkers, st->control->Target(), elementsDone });
+    }
+
+    static unsigned int PLATFORM_CALL CoordinatorThreadProc(void* param) {
         CoordinatorThreadData* cd = static_cast<CoordinatorThreadData*>(param);
         CoordinatorState* st = cd->st;
 
+        // a worker whose output could not be prepared never requests, so it never takes a
+        // shutdown either: count it as done, or the loop below would wait for it forever.
+        // Nor does it fill a slot of the elastic target: the target counts live workers
         uint32_t shutdownIssued = 0;
+        for (uint32_t i = 0; i < st->nWorkers; i++) {
+            st->liveRank[i] = i - shutdownIssued;
+            if (!(*cd->workers)[i].prepared) shutdownIssued++;
+        }
+        uint32_t scanFrom = 0;
+
+        // elastic bookkeeping (coordinator-only)
+        std::vector<bool> parked(st->nWorkers, false);
+        std::vector<size_t> seenDone(st->nWorkers, 0);
+        uint32_t parkedCount = 0;
+        size_t elementsDone = 0;
+        if (st->control) {
+            st->startedAt = Timing::Now();
+            SampleTimeline(st, st->nWorkers, 0, true);
+        }
 
         for (;;) {
             if (shutdownIssued >= st->nWorkers) break;
 
-            DWORD idx = WaitForMultipleObjects(st->nWorkers, cd->requestEvents.data(), FALSE, INFINITE);
-            if (idx < WAIT_OBJECT_0 || idx >= WAIT_OBJECT_0 + st->nWorkers) break;
-
-            uint32_t workerId = (uint32_t)(idx - WAIT_OBJECT_0);
-            ResetEvent((*st->sync)[workerId].requestEvent);
+            // read the sequence before scanning, so a request landing mid-scan still wakes us
+            int32_t seq = st->requestSeq.load();
+            uint32_t workerId = st->nWorkers;
+            for (uint32_t k = 0; k < st->nWorkers; k++) {
+                uint32_t w = (scanFrom + k) % st->nWorkers;
+                if ((*st->sync)[w].requested) { workerId = w; break; }
+            }
+            if (workerId == st->nWorkers) {
+                Sync::WaitWhileEqual(&st->requestSeq, seq, st->waitPolicy);
+                continue;
+            }
+            scanFrom = workerId + 1;   // round-robin, no worker starves
+            (*st->sync)[workerId].requested.exchange(0);
 
             Task task{};
             task.shutdown = false;
 
-            EnterCriticalSection(&st->cs);
+            st->lock.Lock();
 
-            size_t remaining = (st->nextIndex < st->n) ? (st->n - st->nextIndex) : 0;
-            if (remaining == 0) {
+            const uint32_t activeBefore = st->nWorkers - shutdownIssued - parkedCount;
+            if (parked[workerId]) {
+                // back from parking: rejoining, or collecting its shutdown
+                parked[workerId] = false;
+                parkedCount--;
+                if (st->remainingTotal > 0) st->telemetry->joinCount++;
+            }
+            elementsDone += (*st->sync)[workerId].doneElems - seenDone[workerId];
+            seenDone[workerId] = (*st->sync)[workerId].doneElems;
+
+            if (st->remainingTotal == 0) {
                 task.shutdown = true;
                 shutdownIssued++;
+
+                if (st->control && !st->workExhausted) {
+                    st->workExhausted.exchange(1);
+                    Sync::IncrementAndWake(st->control->Generation());
+                }
+            }
+            else if (st->control && st->liveRank[workerId] >= st->control->Target()) {
+                task.park = true;
+                parked[workerId] = true;
+                parkedCount++;
+                st->telemetry->retireCount++;
             }
             else {
-                size_t chunk = CalculateChunkSize(remaining, st->nWorkers);
-                task.startIndex = st->nextIndex;
-                size_t end = st->nextIndex + chunk;
-                if (end > st->n) end = st->n;
-                task.endIndex = end;
-                st->nextIndex = end;
+                // policy sizes against the global remainder, the queue clamps it
+                const WorkerSync& ws = (*st->sync)[workerId];
+                Scheduling::ChunkRequest req{ workerId, st->remainingTotal, ws.lastChunkElems, ws.lastChunkTime_us, ws.lastWait_us };
+                size_t chunk = st->policy->NextChunk(req);
+                if (chunk < 1) chunk = 1;
+                chunk = (chunk + st->grain - 1) / st->grain * st->grain;
+
+                NodeQueue& local = st->queues[st->workerQueue[workerId]];
+                if (local.next < local.end) {
+                    if (chunk > local.end - local.next) chunk = local.end - local.next;
+                    task.startIndex = local.next;
+                    local.next += chunk;
+                }
+                else {
+                    // local slice drained: take the far end of the fullest remote slice,
+                    // away from where its owners are claiming
+                    NodeQueue& victim = FullestQueue(st);
+                    if (chunk > victim.end - victim.next) chunk = victim.end - victim.next;
+                    size_t edge = victim.end - chunk;
+                    edge -= edge % st->grain;   // the stolen range starts on a grain edge
+                    if (edge < victim.next) edge = victim.next;
+                    chunk = victim.end - edge;
+                    victim.end = edge;
+                    task.startIndex = victim.end;
+                    st->telemetry->stealCount++;
+                }
+                task.endIndex = task.startIndex + chunk;
+                st->remainingTotal -= chunk;
+
+                st->telemetry->chunks.push_back({ workerId, task.startIndex, chunk });
+            }
+
+            if (st->control) {
+                const uint32_t activeAfter = st->nWorkers - shutdownIssued - parkedCount;
+                SampleTimeline(st, activeAfter, elementsDone, activeAfter != activeBefore);
             }
 
             (*st->sync)[workerId].taskSlot = task;
-            SetEvent((*st->sync)[workerId].assignedEvent);
+            Sync::PublishOne(&(*st->sync)[workerId].assigned, 1);
 
-            LeaveCriticalSection(&st->cs);
+            st->lock.Unlock();
         }
 
         return 0;
     }
 
     ParallelDynamicResult RunParallelDynamic(const uint32_t* v, size_t n, uint32_t T, uint32_t nWorkers) {
+        return RunParallelDynamic(v, n, T, nWorkers, DynamicOptions());
+    }
+
+    ParallelDynamicResult RunParallelDynamic(const uint32_t* v, size_t n, uint32_t T, uint32_t nWorkers,
+        const DynamicOptions& options) {
         ParallelDynamicResult result{};
         result.time_us = 0.0;
+        result.startup_us = 0.0;
         result.totalCount = 0;
 
         if (!v || n == 0 || nWorkers == 0) return result;
@@ -158,84 +400,269 @@ namespace ParallelDynamic {
         st.n = n;
         st.T = T;
         st.nWorkers = nWorkers;
-        st.nextIndex = 0;
+        st.remainingTotal = n;
+        st.waitPolicy = options.waitPolicy;
+        st.control = options.control;
+        st.liveRank.assign(nWorkers, 0);
+        const bool bitmap = options.outputEncoding == FileIO::ResultEncoding::Bitmap;
+        const bool direct = options.segmentMode == ResultWriter::SegmentMode::Direct && !bitmap;
+        st.grain = bitmap ? ResultBitmap::kWordBits : 1;
+
+        st.telemetry = &result.telemetry;
+
+        // caller's policy, or the built-in halving rule
+        std::unique_ptr<Scheduling::ChunkPolicy> defaultPolicy;
+        st.policy = options.policy;
+        if (!st.policy) {
+            defaultPolicy = Scheduling::CreatePolicy(Scheduling::PolicyKind::Halving);
+            st.policy = defaultPolicy.get();
+        }
+
+        std::vector<double> weights(nWorkers, 1.0);
+        if (options.workerWeights) {
+            for (uint32_t i = 0; i < nWorkers && i < options.workerWeights->size(); i++) weights[i] = (*options.workerWeights)[i];
+        }
+        st.policy->Reset(n, nWorkers, weights);
+
+        // one queue per node in use (ascending node id), each over a contiguous slice
+        // proportional to the node's worker count
+        std::vector<uint32_t> nodes;
+        if (options.workerNodes) {
+            for (uint32_t i = 0; i < nWorkers; i++) {
+                uint32_t node = i < options.workerNodes->size() ? (*options.workerNodes)[i] : 0;
+                if (std::find(nodes.begin(), nodes.end(), node) == nodes.end()) nodes.push_back(node);
+            }
+            std::sort(nodes.begin(), nodes.end());
+        }
+        if (nodes.empty()) nodes.push_back(0);
+
+        st.workerQueue.assign(nWorkers, 0);
+        std::vector<uint32_t> workersPerQueue(nodes.size(), 0);
+        for (uint32_t i = 0; i < nWorkers; i++) {
+            if (options.workerNodes && i < options.workerNodes->size()) {
+                st.workerQueue[i] = (uint32_t)(std::find(nodes.begin(), nodes.end(), (*options.workerNodes)[i]) - nodes.begin());
+            }
+            workersPerQueue[st.workerQueue[i]]++;
+        }
+
+        st.queues.resize(nodes.size());
+        uint32_t workersBefore = 0;
+        for (size_t q = 0; q < nodes.size(); q++) {
+            st.queues[q].next = (size_t)((double)n * workersBefore / nWorkers);
+            workersBefore += workersPerQueue[q];
+            st.queues[q].end = (q + 1 == nodes.size()) ? n : (size_t)((double)n * workersBefore / nWorkers);
+        }
+        for (size_t q = 1; q < st.queues.size(); q++) {
+            size_t edge = st.queues[q].next - st.queues[q].next % st.grain;
+            if (edge < st.queues[q - 1].next) edge = st.queues[q - 1].next;
+            st.queues[q - 1].end = edge;
+            st.queues[q].next = edge;
+        }
+        result.telemetry.queueCount = (uint32_t)st.queues.size();
 
         std::vector<WorkerSync> sync(nWorkers);
         for (uint32_t i = 0; i < nWorkers; i++) {
-            sync[i].requestEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
-            sync[i].assignedEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
-            sync[i].taskSlot = { 0,0,false };
+            sync[i].requested = 0;
+            sync[i].assigned = 0;
+            sync[i].taskSlot = { 0,0,false,false };
+            sync[i].doneElems = 0;
+            sync[i].lastChunkElems = 0;
+            sync[i].lastChunkTime_us = 0.0;
+            sync[i].lastWait_us = 0.0;
         }
         st.sync = &sync;
 
         std::vector<WorkerData> wd(nWorkers);
-        std::vector<HANDLE> workerHandles(nWorkers);
 
         for (uint32_t i = 0; i < nWorkers; i++) {
             wd[i].workerId = i;
             wd[i].state = &st;
+            wd[i].data = (options.workerData && i < options.workerData->size()) ? (*options.workerData)[i] : v;
             wd[i].tempPath = FileIO::MakeTempPath(FileIO::GetDynamicResultsPath(), T, nWorkers, i, L"dyn");
+            wd[i].bufferBytes = options.outputBufferBytes;
+            wd[i].encoding = options.outputEncoding;
+            wd[i].direct = direct;
+            wd[i].uncached = options.uncachedOutput;
+        }
+
+        // Bitmap (every chunk written in place by the worker that ran it) and Direct write
+        // straight into the result file: created up front under a temp name, renamed at the end
+        std::wstring sharedPath;
+        Platform::FileHandle hShared = Platform::kInvalidFile;
+        if (bitmap || direct) {
+            std::wstring err;
+            sharedPath = FileIO::MakeTempPath(FileIO::GetDynamicResultsPath(), T, nWorkers, 0, bitmap ? L"bitmap" : L"direct");
+            if (!FileIO::CreateResultsFileWithAcl(sharedPath, hShared, err)) {
+                Platform::DebugLog(L"Create dynamic output failed: " + err);
+                result.io.Fail(L"Create result file failed: " + err);
+                return result;
+            }
+            for (uint32_t i = 0; i < nWorkers; i++) {
+                if (bitmap) wd[i].hTmp = hShared;
+                else wd[i].hOut = hShared;
+            }
+            // a bitmap's size follows from n alone, so it is laid out before the run
+            if (bitmap && options.uncachedOutput
+                && !Platform::Preallocate(hShared, ResultBitmap::kHeaderBytes + (uint64_t)ResultBitmap::WordCount(n) * sizeof(uint64_t), err)) {
+                Platform::DebugLog(L"Dynamic bitmap preallocation failed: " + err);
+            }
+        }
+
+        // writer threads start (and their buffers are allocated) before the timed job; declared
+        // after wd so the service is stopped before the writers it serves are destroyed
+        AsyncWriter::Service writer;
+        if (options.writerThreads > 0 && !bitmap && !direct && options.outputBufferBytes > 0) {
+            std::wstring err;
+            uint32_t depth = options.writerQueue ? options.writerQueue : nWorkers;
+            if (writer.Start(options.writerBackend, options.writerThreads, nWorkers, depth, ResultWriter::BufferCapacity(options.outputBufferBytes, options.uncachedOutput), err)) {
+                for (uint32_t i = 0; i < nWorkers; i++) wd[i].writer = &writer;
+            }
+            else {
+                Platform::DebugLog(L"Dynamic writer threads not started, workers write themselves: " + err);
+            }
         }
 
         CoordinatorThreadData cd;
         cd.st = &st;
-        cd.requestEvents.reserve(nWorkers);
-        for (uint32_t i = 0; i < nWorkers; i++) cd.requestEvents.push_back(sync[i].requestEvent);
+        cd.workers = &wd;
+
+        // nWorkers workers + 1 coordinator, all taken from the persistent pool and
+        // released together from a start barrier
+        std::vector<ThreadPool::Task> tasks;
+        tasks.reserve(nWorkers + 1);
+        for (uint32_t i = 0; i < nWorkers; i++) tasks.push_back({ WorkerThreadProc, &wd[i], PrepareWorker });
+        tasks.push_back({ CoordinatorThreadProc, &cd });
+
+        ThreadPool::JobOptions jobOpts;
+        jobOpts.startBarrier = true;
+        jobOpts.startWait = options.waitPolicy;
+        ThreadPool::JobTiming timing;
+
+        Timing::Ticks submitted = Timing::Now();
+
+        bool ran = ThreadPool::RunJob(tasks, jobOpts, timing);
+        if (!ran) {
+            if (hShared != Platform::kInvalidFile) {
+                Platform::CloseFile(hShared);
+                Platform::RemoveFile(sharedPath);
+            }
+            return result;
+        }
 
-        LARGE_INTEGER start = Timing::NowQpc();
+        result.startup_us = Timing::ElapsedMicros(submitted, timing.releasedAt);
+        result.time_us = Timing::ElapsedMicros(timing.releasedAt, timing.finishedAt);
+        writer.Stop();   // every worker has drained its blocks in Close
 
+        // tail idle: how long, on average, workers waited for the last one to finish
+        Timing::Ticks lastFinish = 0;
         for (uint32_t i = 0; i < nWorkers; i++) {
-            workerHandles[i] = (HANDLE)_beginthreadex(nullptr, 0, WorkerThreadProc, &wd[i], 0, nullptr);
-            if (!workerHandles[i]) return result;
+            if (wd[i].finishedAt > lastFinish) lastFinish = wd[i].finishedAt;
         }
+        double idleSum = 0.0;
+        for (uint32_t i = 0; i < nWorkers; i++) {
+            if (wd[i].finishedAt != 0) idleSum += Timing::ElapsedMicros(wd[i].finishedAt, lastFinish);
+        }
+        result.telemetry.tailIdle_us = idleSum / nWorkers;
 
-        HANDLE coordHandle = (HANDLE)_beginthreadex(nullptr, 0, CoordinatorThreadProc, &cd, 0, nullptr);
-        if (!coordHandle) return result;
+        result.telemetry.policyName = st.policy->Name();
+        result.telemetry.dispatchCount = result.telemetry.chunks.size();
+        result.telemetry.perElement_us = st.policy->PerElementEstimate_us();
+        result.telemetry.dispatchOverhead_us = st.policy->OverheadEstimate_us();
 
-        WaitForSingleObject(coordHandle, INFINITE);
-        CloseHandle(coordHandle);
+        // the others took its share of the input, but the run is still reported as failed
+        for (uint32_t i = 0; i < nWorkers; i++) {
+            if (!wd[i].prepared) result.io.Fail(L"Worker " + std::to_wstring(i) + L" output not prepared: " + wd[i].prepareError);
+        }
 
-        WaitForMultipleObjects(nWorkers, workerHandles.data(), TRUE, INFINITE);
+        std::vector<ResultWriter::Segment> segments(nWorkers);
+        for (uint32_t i = 0; i < nWorkers; i++) {
+            result.totalCount += (size_t)wd[i].count;
+            double worker_us = wd[i].finishedAt ? Timing::ElapsedMicros(timing.releasedAt, wd[i].finishedAt) : 0.0;
+            uint64_t bytes = direct ? wd[i].segmentBytes : wd[i].out.Stats().bytes;
+            segments[i] = { direct ? std::wstring() : wd[i].tempPath, wd[i].count, bytes, worker_us };
+        }
 
-        LARGE_INTEGER end = Timing::NowQpc();
-        result.time_us = Timing::ElapsedMicros(start, end);
+        if (direct) {
+            // every size is known now, so is the layout: each worker writes its own segment
+            // at its offset, all at once; this step counts towards the run time
+            std::vector<ResultWriter::SegmentPlace> places = ResultWriter::PlaceSegments(segments, options.outputEncoding);
+            std::wstring err;
+            if (options.uncachedOutput && !Platform::Preallocate(hShared, ResultWriter::PlacedBytes(segments, places), err)) {
+                Platform::DebugLog(L"Dynamic output preallocation failed: " + err);
+            }
+            std::vector<ThreadPool::Task> placeTasks(nWorkers);
+            for (uint32_t i = 0; i < nWorkers; i++) {
+                wd[i].place = places[i];
+                placeTasks[i] = { PlaceSegment, &wd[i] };
+            }
+            ThreadPool::JobTiming placeTiming;
+            if (ThreadPool::RunJob(placeTasks, jobOpts, placeTiming)) {
+                result.time_us += Timing::ElapsedMicros(placeTiming.releasedAt, placeTiming.finishedAt);
+            }
+            else {
+                Platform::DebugLog(L"Dynamic placement did not run");
+                result.io.Fail(L"Segment placement did not run");
+                for (uint32_t i = 0; i < nWorkers; i++) wd[i].out.Close();
+            }
+        }
 
-        for (uint32_t i = 0; i < nWorkers; i++) CloseHandle(workerHandles[i]);
-        for (uint32_t i = 0; i < nWorkers; i++) { CloseHandle(sync[i].requestEvent); CloseHandle(sync[i].assignedEvent); }
+        for (uint32_t i = 0; i < nWorkers; i++) result.io.Add(bitmap ? wd[i].bits.Stats() : wd[i].out.Stats());
+        if (!result.io.error.empty()) Platform::DebugLog(L"Dynamic worker output failed: " + result.io.error);
 
         // output file required:
-        // ...\rezultate\dinamic\<T>_<nWorker>_<timp>.txt
+        // ...\rezultate\dinamic\<T>_<nWorker>_<timp>.txt (.bin for the binary encodings, .bits for Bitmap)
         std::wstringstream name;
-        name << FileIO::GetDynamicResultsPath() << L"\\"
+        name << FileIO::GetDynamicResultsPath() << Platform::kPathSep
             << T << L"_"
             << nWorkers << L"_"
             << std::fixed << std::setprecision(0) << result.time_us
-            << L".txt";
+            << FileIO::ResultExtension(options.outputEncoding);
         std::wstring path = name.str();
 
         std::wstring err;
-        HANDLE hOut = INVALID_HANDLE_VALUE;
-        if (!FileIO::CreateResultsFileWithAcl(path, hOut, err)) {
-            OutputDebugStringW((L"Create dynamic output failed: " + err).c_str());
-            for (uint32_t i = 0; i < nWorkers; i++) DeleteFileW(wd[i].tempPath.c_str());
-            return result;
+        if (bitmap || direct) {
+            // the data is already in place: header, then the final name
+            bool ok = true;
+            if (bitmap) {
+                ResultBitmap::Header header;
+                header.T = T;
+                header.n = n;
+                header.count = result.totalCount;
+                header.time_us = result.time_us;
+                ok = ResultBitmap::WriteHeader(hShared, header, err);
+            }
+            else {
+                ok = ResultWriter::WritePlacedHeader(hShared, segments, options.outputEncoding, T, result.time_us, err);
+            }
+            if (!ok) {
+                Platform::DebugLog(L"Dynamic result header failed: " + err);
+                result.io.Fail(L"Result header failed: " + err);
+            }
+            Platform::CloseFile(hShared);
+            if (!Platform::RenameFile(sharedPath, path)) {
+                std::wstring renameErr = Platform::LastErrorText();
+                Platform::DebugLog(L"Rename dynamic result failed: " + renameErr);
+                result.io.Fail(L"Rename result file failed: " + renameErr);
+                Platform::RemoveFile(sharedPath);
+            }
         }
+        else {
+            Platform::FileHandle hOut = Platform::kInvalidFile;
+            if (!FileIO::CreateResultsFileWithAcl(path, hOut, err)) {
+                Platform::DebugLog(L"Create dynamic output failed: " + err);
+                result.io.Fail(L"Create result file failed: " + err);
+                for (uint32_t i = 0; i < nWorkers; i++) Platform::RemoveFile(wd[i].tempPath);
+                return result;
+            }
 
-        for (uint32_t i = 0; i < nWorkers; i++) {
-            result.totalCount += (size_t)wd[i].count;
-
-            wchar_t header[64];
-            int hlen = swprintf_s(header, L"%u_%llu:", i, (unsigned long long)wd[i].count);
-            FileIO::WriteW(hOut, header, (size_t)hlen, err);
-
-            FileIO::AppendFileToHandle(hOut, wd[i].tempPath, err);
-            FileIO::WriteW(hOut, L"\r\n", 2, err);
+            if (!ResultWriter::MergeSegments(hOut, segments, options.outputEncoding, T, result.time_us, options.uncachedOutput, err)) {
+                Platform::DebugLog(L"Dynamic merge failed: " + err);
+                result.io.Fail(L"Merge failed: " + err);
+            }
 
-            DeleteFileW(wd[i].tempPath.c_str());
+            Platform::CloseFile(hOut);
         }
 
-        CloseHandle(hOut);
-
         result.workerResults.clear();
         result.unionSet.clear();
         return result;
@@ -2,6 +2,9 @@
 #include <cstdint>
 #include <vector>
 #include <string>
+#include "scheduling_policy.h"
+#include "sync_wait.h"
+#include "result_writer.h"
 
 namespace ParallelDynamic {
     struct WorkerResult {
@@ -10,11 +13,41 @@ namespace ParallelDynamic {
         std::vector<uint32_t> found;  // Values that meet the criteria
     };
 
+    struct ChunkRecord {
+        uint32_t workerId;        // Worker the chunk was handed to
+        size_t startIndex;        // First element of the chunk
+        size_t size;              // Elements in the chunk
+    };
+
+    struct ElasticSample {
+        double t_us;              // Since the start barrier release
+        uint32_t activeWorkers;   // Workers neither retired (parked) nor finished
+        uint32_t targetWorkers;   // WorkerControl target at that moment
+        size_t elementsDone;      // Elements of completed chunks so far
+    };
+
+    struct DynamicTelemetry {
+        const wchar_t* policyName = L"";  // Scheduling::ChunkPolicy::Name() of the run
+        size_t dispatchCount = 0;         // Chunks handed out (shutdown replies excluded)
+        double tailIdle_us = 0.0;         // Mean time a worker sat idle waiting for the last one
+        double perElement_us = 0.0;       // Final per-element cost estimate (adaptive policy)
+        double dispatchOverhead_us = 0.0; // Final request->assignment latency estimate (adaptive policy)
+        uint32_t queueCount = 0;          // Work queues (one per NUMA node in use, else 1)
+        size_t stealCount = 0;            // Chunks taken from another node's queue
+        size_t retireCount = 0;           // Workers parked because the target dropped below them
+        size_t joinCount = 0;             // Parked workers that came back because the target rose
+        std::vector<ElasticSample> timeline;  // Worker count vs progress (runs with a WorkerControl)
+        std::vector<ChunkRecord> chunks;  // Every dispatch, in order
+    };
+
     struct ParallelDynamicResult {
-        double time_us;           // Computation time in microseconds
+        double time_us;           // Computation time in microseconds (start barrier release -> last worker done)
+        double startup_us;        // Job submit -> release: thread wakeup, pinning, temp file setup
         size_t totalCount;        // Total count across all workers
         std::vector<WorkerResult> workerResults;  // Per-worker results
         std::vector<uint32_t> unionSet;  // Combined unique values
+        DynamicTelemetry telemetry;      // Scheduling decisions of this run
+        ResultWriter::WriteStats io;     // Worker temp-file writes (merge not included)
     };
 
     ParallelDynamicResult RunParallelDynamic(
@@ -23,4 +56,76 @@ namespace ParallelDynamic {
         uint32_t T,
         uint32_t nWorkers
     );
+
+    // Target worker count of a running RunParallelDynamic; may be changed from any
+    // thread while the run is in progress. Workers at index >= target retire after
+    // their current chunk (their output so far is kept) and park; when the target
+    // rises again they rejoin by requesting chunks.
+    class WorkerControl {
+    public:
+        explicit WorkerControl(uint32_t targetWorkers = 0xFFFFFFFFu);
+
+        void SetTarget(uint32_t workers);   // clamped to >= 1; above nWorkers means all
+        uint32_t Target() const;
+
+        // Bumped on every SetTarget (and by the runner when the work runs out);
+        // parked workers wait on it
+        Sync::Word* Generation() { return &generation; }
+
+    private:
+        Sync::Word target;
+        Sync::Word generation;
+    };
+
+    struct DynamicOptions {
+        // Relative throughput of worker i (hybrid P/E cores); slower workers get smaller chunks
+        const std::vector<double>* workerWeights = nullptr;
+
+        // Self-scheduling rule; nullptr = built-in halving rule (remaining / 2P).
+        // Reset() is called on it at the start of the run.
+        Scheduling::ChunkPolicy* policy = nullptr;
+
+        // NUMA node of worker i. Each node in use gets a queue over a contiguous slice
+        // of the input (sized by its worker count); workers drain their node's queue and
+        // only then steal from the back of the fullest remote one. nullptr = one queue.
+        const std::vector<uint32_t>* workerNodes = nullptr;
+
+        // Input worker i reads (e.g. its node's replica, same layout as v); nullptr = v.
+        // Stolen chunks are read from the thief's own copy.
+        const std::vector<const uint32_t*>* workerData = nullptr;
+
+        // How workers wait at the start barrier and for chunk assignments, and how the
+        // coordinator waits for requests. Spin policies need a free core per waiter.
+        Sync::WaitPolicy waitPolicy = Sync::WaitPolicy::Block;
+
+        // Elastic run: nWorkers is the capacity, control decides how many of them work.
+        // Fills telemetry.timeline.
+        WorkerControl* control = nullptr;
+
+        // Per-worker output buffer; 0 = one write per value
+        size_t outputBufferBytes = ResultWriter::kDefaultBufferBytes;
+        // Result file encoding (worker segments, headers and the merged file)
+        FileIO::ResultEncoding outputEncoding = FileIO::ResultEncoding::Utf16;
+        // Temp files + merge, or segments in memory written in place (not used for Bitmap)
+        ResultWriter::SegmentMode segmentMode = ResultWriter::SegmentMode::TempFiles;
+        // Threads that write full worker buffers while the workers compute (TempFiles
+        // segments with a buffer only); 0 = every worker writes its own
+        uint32_t writerThreads = 0;
+        // Full buffers that may wait for the writer threads; 0 = one per worker
+        uint32_t writerQueue = 0;
+        // IoUring: one thread hands the blocks to the kernel in batches instead
+        AsyncWriter::Backend writerBackend = AsyncWriter::Backend::Threads;
+        // Temp segments write their whole blocks around the page cache (O_DIRECT /
+        // FILE_FLAG_NO_BUFFERING) and so does the merge; result files whose size is known
+        // before they are filled (merge, Direct segments, Bitmap) are preallocated
+        bool uncachedOutput = false;
+    };
+
+    ParallelDynamicResult RunParallelDynamic(
+        const uint32_t* v,
+        size_t n,
+        uint32_t T,
+        uint32_t nWorkers,
+        const DynamicOptions& options
+    );
 }
\ No newline at end of file
@@ -2,15 +2,19 @@
 #include "collatz.h"
 #include "timing.h"
 #include "fileio.h"
-#include <windows.h>
-#include <process.h>
+#include "thread_pool.h"
+#include "result_writer.h"
+#include "result_bitmap.h"
+#include "async_writer.h"
+#include "platform.h"
 #include <sstream>
 #include <iomanip>
 #include <vector>
 
 namespace ParallelStatic {
 
-    struct ThreadData {
+    // One cache line (or more) per worker: count is bumped on every hit
+    struct alignas(Sync::kCacheLine) ThreadData {
         uint32_t workerId;
         const uint32_t* data;
         size_t startIndex;
@@ -18,125 +22,343 @@ namespace ParallelStatic {
         uint32_t threshold;
 
         uint64_t count = 0;
+        double time_us = 0.0;
         std::wstring tempPath;
+        Platform::FileHandle hTmp = Platform::kInvalidFile;
+        size_t bufferBytes = ResultWriter::kDefaultBufferBytes;
+        FileIO::ResultEncoding encoding = FileIO::ResultEncoding::Utf16;
+        bool direct = false;                // SegmentMode::Direct: tempPath only takes a spill
+        AsyncWriter::Service* writer = nullptr;   // full buffers go to the run's writer threads
+        bool uncached = false;              // whole blocks of the temp file skip the page cache
+        bool prepared = false;
+        std::wstring prepareError;          // why PrepareWorker failed
+        ResultWriter::BufferedWriter out;
+        ResultBitmap::RangeWriter bits;     // Bitmap: hTmp is the shared result file
+
+        // SegmentMode::Direct, second step
+        uint64_t segmentBytes = 0;
+        Platform::FileHandle hOut = Platform::kInvalidFile;
+        ResultWriter::SegmentPlace place;
     };
 
-    static unsigned int __stdcall WorkerThread(void* param) {
+    // before the start barrier: file creation and the output buffer are not compute time
+    static unsigned int PLATFORM_CALL PrepareWorker(void* param) {
         ThreadData* td = static_cast<ThreadData*>(param);
+        std::wstring err;
+        if (td->encoding == FileIO::ResultEncoding::Bitmap) {
+            td->prepared = td->bits.Open(td->hTmp, td->bufferBytes, err);
+            if (!td->prepared) td->prepareError = err;
+            return 0;
+        }
+        if (td->direct) {
+            td->prepared = td->out.OpenInMemory(ResultWriter::kMaxInMemoryBytes, td->tempPath, td->encoding, err);
+            if (!td->prepared) td->prepareError = err;
+            return 0;
+        }
+        td->hTmp = Platform::OpenFile(td->tempPath, Platform::FileMode::Temp, err);
+        bool opened = td->hTmp != Platform::kInvalidFile && (td->writer
+            ? td->out.OpenQueued(td->hTmp, *td->writer, td->encoding, td->uncached, err)
+            : td->uncached ? td->out.OpenUncached(td->hTmp, 0, td->bufferBytes, td->encoding, err)
+            : td->out.Open(td->hTmp, td->bufferBytes, td->encoding, err));
+        if (td->hTmp != Platform::kInvalidFile && !opened) {
+            Platform::CloseFile(td->hTmp);
+            td->hTmp = Platform::kInvalidFile;
+        }
+        td->prepared = td->hTmp != Platform::kInvalidFile;
+        if (!td->prepared) td->prepareError = err;
+        return 0;
+    }
+
+    static unsigned int PLATFORM_CALL WorkerThread(void* param) {
+        ThreadData* td = static_cast<ThreadData*>(param);
+
+        if (!td->prepared) return 0;
 
-        HANDLE hTmp = CreateFileW(td->tempPath.c_str(), GENERIC_WRITE, FILE_SHARE_READ,
-            nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_TEMPORARY, nullptr);
-        if (hTmp == INVALID_HANDLE_VALUE) return 0;
+        Timing::Ticks start = Timing::Now();
 
-        bool first = true;
-        wchar_t buf[32];
+        if (td->encoding == FileIO::ResultEncoding::Bitmap) {
+            // every element is a bit, so no branch on the hit; the range starts on a word
+            td->bits.Begin(td->startIndex);
+            uint64_t count = 0;
+            for (size_t i = td->startIndex; i < td->endIndex; i++) {
+                bool hit = Collatz::CollatzAtLeastT(td->data[i], td->threshold);
+                td->bits.Add(hit);
+                count += hit;
+            }
+            td->count = count;
+            td->bits.Close();
+            td->time_us = Timing::ElapsedMicros(start, Timing::Now());
+            return 0;   // the file is shared; the run closes it
+        }
 
         for (size_t i = td->startIndex; i < td->endIndex; i++) {
             uint32_t x = td->data[i];
 
             if (!Collatz::CollatzAtLeastT(x, td->threshold)) continue;
 
-            int len = first ? swprintf_s(buf, L"%u", x) : swprintf_s(buf, L",%u", x);
-            first = false;
-
-            DWORD bw = 0;
-            if (!WriteFile(hTmp, buf, (DWORD)(len * sizeof(wchar_t)), &bw, nullptr)) {
-                // ignore, but stop writing further if disk fails
-                break;
-            }
+            // a failed write latches in the writer; the run reports it through result.io
+            if (!td->out.AppendValue(x)) break;
             td->count++;
         }
+        if (td->direct) {
+            td->segmentBytes = td->out.SegmentBytes();   // written once every size is known
+        }
+        else {
+            td->out.Close();   // final flush (and with writer threads, the drain) is part of the worker's time
+        }
+
+        td->time_us = Timing::ElapsedMicros(start, Timing::Now());
+
+        if (td->hTmp != Platform::kInvalidFile) Platform::CloseFile(td->hTmp);
+        return 0;
+    }
 
-        CloseHandle(hTmp);
+    // SegmentMode::Direct: the worker's segment and framing at its final offset
+    static unsigned int PLATFORM_CALL PlaceSegment(void* param) {
+        ThreadData* td = static_cast<ThreadData*>(param);
+        if (td->prepared) td->out.WritePlaced(td->hOut, td->place);
         return 0;
     }
 
     ParallelStaticResult RunParallelStatic(const uint32_t* v, size_t n, uint32_t T, uint32_t nWorkers) {
+        return RunParallelStatic(v, n, T, nWorkers, StaticOptions());
+    }
+
+    ParallelStaticResult RunParallelStatic(const uint32_t* v, size_t n, uint32_t T, uint32_t nWorkers,
+        const StaticOptions& options) {
         ParallelStaticResult result{};
         result.time_us = 0.0;
+        result.startup_us = 0.0;
         result.totalCount = 0;
+        result.imbalance = 0.0;
 
         if (!v || n == 0 || nWorkers == 0) return result;
         if (nWorkers > n) nWorkers = (uint32_t)n;
 
         std::vector<ThreadData> td(nWorkers);
-        std::vector<HANDLE> th(nWorkers);
+        std::vector<ThreadPool::Task> tasks(nWorkers);
+        const bool bitmap = options.outputEncoding == FileIO::ResultEncoding::Bitmap;
+        const bool direct = options.segmentMode == ResultWriter::SegmentMode::Direct && !bitmap;
+
+        // static distribution (as required); with a cost model and/or worker weights the
+        // boundaries move so each slice carries work proportional to its worker's speed
+        const bool weighted = options.costs || options.workerWeights;
+        std::vector<size_t> bounds;
+        if (weighted) {
+            bounds = CostModel::BalancedBoundaries(options.costs ? *options.costs : CostModel::BlockCosts(),
+                n, nWorkers, options.workerWeights);
+        }
 
-        // static distribution (as required)
         size_t base = n / nWorkers;
         size_t rem = n % nWorkers;
 
         size_t cur = 0;
         for (uint32_t i = 0; i < nWorkers; i++) {
             td[i].workerId = i;
-            td[i].data = v;
+            td[i].data = (options.workerData && i < options.workerData->size()) ? (*options.workerData)[i] : v;
             td[i].threshold = T;
-            td[i].startIndex = cur;
 
-            size_t chunk = base + (i < rem ? 1 : 0);
-            td[i].endIndex = cur + chunk;
-            cur = td[i].endIndex;
+            if (weighted) {
+                td[i].startIndex = bounds[i];
+                td[i].endIndex = bounds[i + 1];
+            }
+            else {
+                td[i].startIndex = cur;
+                size_t chunk = base + (i < rem ? 1 : 0);
+                td[i].endIndex = cur + chunk;
+                cur = td[i].endIndex;
+            }
 
             td[i].tempPath = FileIO::MakeTempPath(FileIO::GetStaticResultsPath(), T, nWorkers, i, L"static");
+            td[i].bufferBytes = options.outputBufferBytes;
+            td[i].encoding = options.outputEncoding;
+            td[i].direct = direct;
+            td[i].uncached = options.uncachedOutput;
+
+            tasks[i] = { WorkerThread, &td[i], PrepareWorker };
         }
 
-        LARGE_INTEGER start = Timing::NowQpc();
+        // Bitmap: all workers write their words in place into one file, so every
+        // boundary moves down to a word (the last range still ends at n)
+        if (bitmap) {
+            for (uint32_t i = 1; i < nWorkers; i++) {
+                size_t edge = ResultBitmap::AlignDown(td[i].startIndex);
+                if (edge < td[i - 1].startIndex) edge = td[i - 1].startIndex;
+                td[i - 1].endIndex = edge;
+                td[i].startIndex = edge;
+            }
+        }
 
-        for (uint32_t i = 0; i < nWorkers; i++) {
-            th[i] = (HANDLE)_beginthreadex(nullptr, 0, WorkerThread, &td[i], 0, nullptr);
-            if (!th[i]) {
-                for (uint32_t j = 0; j < i; j++) { WaitForSingleObject(th[j], INFINITE); CloseHandle(th[j]); }
+        // Bitmap and Direct write straight into the result file: it is created up front
+        // under a temp name and renamed once the run time is known
+        std::wstring sharedPath;
+        Platform::FileHandle hShared = Platform::kInvalidFile;
+        if (bitmap || direct) {
+            std::wstring err;
+            sharedPath = FileIO::MakeTempPath(FileIO::GetStaticResultsPath(), T, nWorkers, 0, bitmap ? L"bitmap" : L"direct");
+            if (!FileIO::CreateResultsFileWithAcl(sharedPath, hShared, err)) {
+                Platform::DebugLog(L"Create static output failed: " + err);
+                result.io.Fail(L"Create result file failed: " + err);
                 return result;
             }
+            for (uint32_t i = 0; i < nWorkers; i++) {
+                if (bitmap) td[i].hTmp = hShared;
+                else td[i].hOut = hShared;
+            }
+            // a bitmap's size follows from n alone, so it is laid out before the run
+            if (bitmap && options.uncachedOutput
+                && !Platform::Preallocate(hShared, ResultBitmap::kHeaderBytes + (uint64_t)ResultBitmap::WordCount(n) * sizeof(uint64_t), err)) {
+                Platform::DebugLog(L"Static bitmap preallocation failed: " + err);
+            }
+        }
+
+        // writer threads start (and their buffers are allocated) before the timed job; declared
+        // after td so the service is stopped before the writers it serves are destroyed
+        AsyncWriter::Service writer;
+        if (options.writerThreads > 0 && !bitmap && !direct && options.outputBufferBytes > 0) {
+            std::wstring err;
+            uint32_t depth = options.writerQueue ? options.writerQueue : nWorkers;
+            if (writer.Start(options.writerBackend, options.writerThreads, nWorkers, depth, ResultWriter::BufferCapacity(options.outputBufferBytes, options.uncachedOutput), err)) {
+                for (uint32_t i = 0; i < nWorkers; i++) td[i].writer = &writer;
+            }
+            else {
+                Platform::DebugLog(L"Static writer threads not started, workers write themselves: " + err);
+            }
+        }
+
+        // workers come from the persistent pool and are released together from a barrier:
+        // neither thread creation nor wakeup skew is inside the timed section
+        ThreadPool::JobOptions jobOpts;
+        jobOpts.startBarrier = true;
+        jobOpts.startWait = options.waitPolicy;
+        ThreadPool::JobTiming timing;
+
+        Timing::Ticks submitted = Timing::Now();
+
+        if (!ThreadPool::RunJob(tasks, jobOpts, timing)) {
+            if (hShared != Platform::kInvalidFile) {
+                Platform::CloseFile(hShared);
+                Platform::RemoveFile(sharedPath);
+            }
+            return result;
+        }
+
+        result.startup_us = Timing::ElapsedMicros(submitted, timing.releasedAt);
+        result.time_us = Timing::ElapsedMicros(timing.releasedAt, timing.finishedAt);
+        writer.Stop();   // every worker has drained its blocks in Close
+
+        double sumWorker = 0.0, maxWorker = 0.0;
+        for (uint32_t i = 0; i < nWorkers; i++) {
+            sumWorker += td[i].time_us;
+            if (td[i].time_us > maxWorker) maxWorker = td[i].time_us;
         }
+        if (sumWorker > 0.0) result.imbalance = maxWorker / (sumWorker / nWorkers) - 1.0;
 
-        WaitForMultipleObjects(nWorkers, th.data(), TRUE, INFINITE);
+        // its slice was never scanned: the count may still happen to match, the run fails anyway
+        for (uint32_t i = 0; i < nWorkers; i++) {
+            if (!td[i].prepared) result.io.Fail(L"Worker " + std::to_wstring(i) + L" output not prepared: " + td[i].prepareError);
+        }
 
-        LARGE_INTEGER end = Timing::NowQpc();
-        result.time_us = Timing::ElapsedMicros(start, end);
+        std::vector<ResultWriter::Segment> segments(nWorkers);
+        for (uint32_t i = 0; i < nWorkers; i++) {
+            result.totalCount += (size_t)td[i].count;
+            uint64_t bytes = direct ? td[i].segmentBytes : td[i].out.Stats().bytes;
+            segments[i] = { direct ? std::wstring() : td[i].tempPath, td[i].count, bytes, td[i].time_us };
+        }
+
+        if (direct) {
+            // every size is known now, so is the layout: each worker writes its own segment
+            // at its offset, all at once; this step counts towards the run time
+            std::vector<ResultWriter::SegmentPlace> places = ResultWriter::PlaceSegments(segments, options.outputEncoding);
+            std::wstring err;
+            if (options.uncachedOutput && !Platform::Preallocate(hShared, ResultWriter::PlacedBytes(segments, places), err)) {
+                Platform::DebugLog(L"Static output preallocation failed: " + err);
+            }
+            std::vector<ThreadPool::Task> placeTasks(nWorkers);
+            for (uint32_t i = 0; i < nWorkers; i++) {
+                td[i].place = places[i];
+                placeTasks[i] = { PlaceSegment, &td[i] };
+            }
+            ThreadPool::JobTiming placeTiming;
+            if (ThreadPool::RunJob(placeTasks, jobOpts, placeTiming)) {
+                result.time_us += Timing::ElapsedMicros(placeTiming.releasedAt, placeTiming.finishedAt);
+            }
+            else {
+                Platform::DebugLog(L"Static placement did not run");
+                result.io.Fail(L"Segment placement did not run");
+                for (uint32_t i = 0; i < nWorkers; i++) td[i].out.Close();
+            }
+        }
 
-        for (uint32_t i = 0; i < nWorkers; i++) CloseHandle(th[i]);
+        for (uint32_t i = 0; i < nWorkers; i++) result.io.Add(bitmap ? td[i].bits.Stats() : td[i].out.Stats());
+        if (!result.io.error.empty()) Platform::DebugLog(L"Static worker output failed: " + result.io.error);
 
         // output file required:
-        // ...\rezultate\static\<T>_<nWorker>_<timp>.txt
+        // ...\rezultate\static\<T>_<nWorker>_<timp>.txt (.bin for the binary encodings, .bits for Bitmap)
         std::wstringstream name;
-        name << FileIO::GetStaticResultsPath() << L"\\"
+        name << FileIO::GetStaticResultsPath() << Platform::kPathSep
             << T << L"_"
             << nWorkers << L"_"
             << std::fixed << std::setprecision(0) << result.time_us
-            << L".txt";
+            << FileIO::ResultExtension(options.outputEncoding);
         std::wstring path = name.str();
 
         std::wstring err;
-        HANDLE hOut = INVALID_HANDLE_VALUE;
-        if (!FileIO::CreateResultsFileWithAcl(path, hOut, err)) {
-            OutputDebugStringW((L"Create static output failed: " + err).c_str());
-            // cleanup temp
-            for (uint32_t i = 0; i < nWorkers; i++) DeleteFileW(td[i].tempPath.c_str());
-            return result;
+        if (bitmap || direct) {
+            // the data is already in place: header, then the final name
+            bool ok = true;
+            if (bitmap) {
+                ResultBitmap::Header header;
+                header.T = T;
+                header.n = n;
+                header.count = result.totalCount;
+                header.time_us = result.time_us;
+                ok = ResultBitmap::WriteHeader(hShared, header, err);
+            }
+            else {
+                ok = ResultWriter::WritePlacedHeader(hShared, segments, options.outputEncoding, T, result.time_us, err);
+            }
+            if (!ok) {
+                Platform::DebugLog(L"Static result header failed: " + err);
+                result.io.Fail(L"Result header failed: " + err);
+            }
+            Platform::CloseFile(hShared);
+            if (!Platform::RenameFile(sharedPath, path)) {
+                std::wstring renameErr = Platform::LastErrorText();
+                Platform::DebugLog(L"Rename static result failed: " + renameErr);
+                result.io.Fail(L"Rename result file failed: " + renameErr);
+                Platform::RemoveFile(sharedPath);
+            }
         }
+        else {
+            Platform::FileHandle hOut = Platform::kInvalidFile;
+            if (!FileIO::CreateResultsFileWithAcl(path, hOut, err)) {
+                Platform::DebugLog(L"Create static output failed: " + err);
+                result.io.Fail(L"Create result file failed: " + err);
+                // cleanup temp
+                for (uint32_t i = 0; i < nWorkers; i++) Platform::RemoveFile(td[i].tempPath);
+                return result;
+            }
 
-        for (uint32_t i = 0; i < nWorkers; i++) {
-            result.totalCount += (size_t)td[i].count;
-
-            wchar_t header[64];
-            int hlen = swprintf_s(header, L"%u_%llu:", i, (unsigned long long)td[i].count);
-            FileIO::WriteW(hOut, header, (size_t)hlen, err);
-
-            // append list
-            FileIO::AppendFileToHandle(hOut, td[i].tempPath, err);
-
-            // newline
-            FileIO::WriteW(hOut, L"\r\n", 2, err);
+            if (!ResultWriter::MergeSegments(hOut, segments, options.outputEncoding, T, result.time_us, options.uncachedOutput, err)) {
+                Platform::DebugLog(L"Static merge failed: " + err);
+                result.io.Fail(L"Merge failed: " + err);
+            }
 
-            DeleteFileW(td[i].tempPath.c_str());
+            Platform::CloseFile(hOut);
         }
 
-        CloseHandle(hOut);
-
-        // NOTE: result.workerResults / unionSet are no longer meaningful for huge outputs.
+        // NOTE: found / unionSet are no longer meaningful for huge outputs.
         // Keep them empty; validation will use external compare (see validation changes section).
-        result.workerResults.clear();
+        // workerResults only carries per-worker counters and timing.
+        result.workerResults.resize(nWorkers);
+        for (uint32_t i = 0; i < nWorkers; i++) {
+            result.workerResults[i].workerId = i;
+            result.workerResults[i].count = (size_t)td[i].count;
+            result.workerResults[i].time_us = td[i].time_us;
+            result.workerResults[i].startIndex = td[i].startIndex;
+            result.workerResults[i].endIndex = td[i].endIndex;
+        }
         result.unionSet.clear();
 
         return result;
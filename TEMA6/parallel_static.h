@@ -2,19 +2,28 @@
 #include <cstdint>
 #include <vector>
 #include <string>
+#include "cost_model.h"
+#include "sync_wait.h"
+#include "result_writer.h"
 
 namespace ParallelStatic {
     struct WorkerResult {
         uint32_t workerId;        // Worker index (0-based)
         size_t count;             // Number of values found by this worker
+        double time_us;           // Time this worker spent on its slice
+        size_t startIndex;        // Slice [startIndex, endIndex) of the input
+        size_t endIndex;
         std::vector<uint32_t> found;  // Values that meet the criteria
     };
 
     struct ParallelStaticResult {
-        double time_us;           // Computation time in microseconds
+        double time_us;           // Computation time in microseconds (start barrier release -> last worker done)
+        double startup_us;        // Job submit -> release: thread wakeup, pinning, temp file setup
         size_t totalCount;        // Total count across all workers
+        double imbalance;         // Slowest worker time / mean worker time - 1
         std::vector<WorkerResult> workerResults;  // Per-worker results
         std::vector<uint32_t> unionSet;  // Combined unique values
+        ResultWriter::WriteStats io;     // Worker temp-file writes (merge not included)
     };
 
     ParallelStaticResult RunParallelStatic(
@@ -23,4 +32,41 @@ namespace ParallelStatic {
         uint32_t T,
         uint32_t nWorkers
     );
+
+    struct StaticOptions {
+        // Place boundaries so every worker gets an equal share of the estimated cost
+        const CostModel::BlockCosts* costs = nullptr;
+        // Relative throughput of worker i (hybrid P/E cores); shares scale with it
+        const std::vector<double>* workerWeights = nullptr;
+        // Input worker i reads (e.g. its node's replica, same layout as v); nullptr = v
+        const std::vector<const uint32_t*>* workerData = nullptr;
+        // How workers wait at the start barrier
+        Sync::WaitPolicy waitPolicy = Sync::WaitPolicy::Block;
+        // Per-worker output buffer; 0 = one write per value
+        size_t outputBufferBytes = ResultWriter::kDefaultBufferBytes;
+        // Result file encoding (worker segments, headers and the merged file)
+        FileIO::ResultEncoding outputEncoding = FileIO::ResultEncoding::Utf16;
+        // Temp files + merge, or segments in memory written in place (not used for Bitmap)
+        ResultWriter::SegmentMode segmentMode = ResultWriter::SegmentMode::TempFiles;
+        // Threads that write full worker buffers while the workers compute (TempFiles
+        // segments with a buffer only); 0 = every worker writes its own
+        uint32_t writerThreads = 0;
+        // Full buffers that may wait for the writer threads; 0 = one per worker
+        uint32_t writerQueue = 0;
+        // IoUring: one thread hands the blocks to the kernel in batches instead
+        AsyncWriter::Backend writerBackend = AsyncWriter::Backend::Threads;
+        // Temp segments write their whole blocks around the page cache (O_DIRECT /
+        // FILE_FLAG_NO_BUFFERING) and so does the merge; result files whose size is known
+        // before they are filled (merge, Direct segments, Bitmap) are preallocated
+        bool uncachedOutput = false;
+    };
+
+    // Same as above; with neither costs nor weights the split is equal element counts
+    ParallelStaticResult RunParallelStatic(
+        const uint32_t* v,
+        size_t n,
+        uint32_t T,
+        uint32_t nWorkers,
+        const StaticOptions& options
+    );
 }
\ No newline at end of file
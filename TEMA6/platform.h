@@ -0,0 +1,190 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <atomic>
+#ifndef _WIN32
+#include <pthread.h>
+#include <cwchar>
+#include <cstdarg>
+#endif
+
+// Thread procs keep the _beginthreadex calling convention on Windows
+#ifdef _WIN32
+#define PLATFORM_CALL __stdcall
+#else
+#define PLATFORM_CALL
+#endif
+
+// Thin OS layer for the compute core: threads, futex-style waits, a mutex, the
+// monotonic clock, mapped input files and file output.
+// Backends: platform_win32.cpp (Win32) and platform_posix.cpp (pthreads, futex,
+// clock_gettime, mmap, pwrite, io_uring on Linux). Paths stay std::wstring; the POSIX
+// backend hands them to the OS as UTF-8.
+namespace Platform {
+#ifdef _WIN32
+    constexpr wchar_t kPathSep = L'\\';
+#else
+    constexpr wchar_t kPathSep = L'/';
+#endif
+
+    // ---- clock
+    int64_t NowTicks();          // QueryPerformanceCounter / clock_gettime(CLOCK_MONOTONIC)
+    int64_t TicksPerSecond();
+
+    // ---- threads
+    typedef unsigned int(PLATFORM_CALL* ThreadProc)(void* param);
+    typedef void* ThreadHandle;
+
+    // nullptr on failure (err set)
+    ThreadHandle StartThread(ThreadProc proc, void* param, std::wstring& err);
+    // Wait for the thread to return and release the handle
+    void JoinThread(ThreadHandle thread);
+
+    void CpuRelax();             // pause instruction inside spin loops
+    void YieldThread();          // give the rest of the time slice away
+    void SleepMillis(uint32_t ms);
+    uint32_t ProcessId();
+
+    // ---- futex-style waits on a 32-bit word (WaitOnAddress / futex)
+    // Blocks while word == value; may return spuriously, callers re-check
+    void WaitOnWord(std::atomic<int32_t>& word, int32_t value);
+    void WakeOneOnWord(std::atomic<int32_t>& word);
+    void WakeAllOnWord(std::atomic<int32_t>& word);
+
+    // ---- mutex (SRWLOCK / pthread_mutex_t)
+    class Mutex {
+    public:
+        Mutex();
+        ~Mutex();
+        Mutex(const Mutex&) = delete;
+        Mutex& operator=(const Mutex&) = delete;
+
+        void Lock();
+        void Unlock();
+
+    private:
+#ifdef _WIN32
+        void* native;   // SRWLOCK is one pointer
+#else
+        pthread_mutex_t native;
+#endif
+    };
+
+    // ---- files
+    typedef intptr_t FileHandle;   // HANDLE / file descriptor
+    constexpr FileHandle kInvalidFile = -1;
+
+    enum class FileMode {
+        Read,        // existing file, read-only
+        Write,       // create or truncate, write-only
+        ReadWrite,   // create or truncate, read + write
+        Temp         // like Write, hinted as short-lived (FILE_ATTRIBUTE_TEMPORARY)
+    };
+
+    FileHandle OpenFile(const std::wstring& path, FileMode mode, std::wstring& err);
+    void CloseFile(FileHandle file);
+
+    // Whole buffer at the current position
+    bool WriteAll(FileHandle file, const void* data, size_t bytes, std::wstring& err);
+    // Whole buffer at offset (pwrite); the current position afterwards is unspecified
+    bool WriteAt(FileHandle file, const void* data, size_t bytes, uint64_t offset, std::wstring& err);
+    // Up to capacity bytes; got == 0 at end of file
+    bool ReadSome(FileHandle file, void* buffer, size_t capacity, size_t& got, std::wstring& err);
+    // Up to capacity bytes at offset (pread); got == 0 at end of file
+    bool ReadAt(FileHandle file, void* buffer, size_t capacity, uint64_t offset, size_t& got, std::wstring& err);
+    bool GetFileSize(FileHandle file, uint64_t& bytes, std::wstring& err);
+    // Extends (or cuts) the file to bytes; a grown tail reads as zeros
+    bool SetFileSize(FileHandle file, uint64_t bytes, std::wstring& err);
+    // bytes of in at inOffset to out at outOffset, leaving both file positions alone, so
+    // disjoint ranges of one target can be filled from several threads. Cheapest first:
+    // shared extents (FICLONERANGE / FSCTL_DUPLICATE_EXTENTS_TO_FILE) when the filesystem
+    // and alignment allow, an in-kernel copy (copy_file_range), then ReadAt / WriteAt.
+    bool CopyRange(FileHandle in, uint64_t inOffset, FileHandle out, uint64_t outOffset, uint64_t bytes, std::wstring& err);
+    // Reserves disk space for the first bytes of file without changing its size
+    // (fallocate KEEP_SIZE / FileAllocationInfo), so it is laid out in one go instead of
+    // extent by extent as writes arrive. False where the filesystem cannot.
+    bool Preallocate(FileHandle file, uint64_t bytes, std::wstring& err);
+
+    // ---- uncached output (O_DIRECT / FILE_FLAG_NO_BUFFERING): writes skip the page
+    // cache, so a large result does not push the mapped input out of memory. Offset,
+    // length and buffer address of every write must be multiples of kUncachedAlign
+    // (4 KiB covers 512-byte and 4K-sector disks).
+    constexpr size_t kUncachedAlign = 4096;
+    // A second, write-only handle to file's file that bypasses the cache; file itself
+    // stays buffered for the unaligned parts. Close it with CloseFile.
+    FileHandle ReopenUncached(FileHandle file, std::wstring& err);
+
+    bool RemoveFile(const std::wstring& path);
+    bool RenameFile(const std::wstring& from, const std::wstring& to);   // replaces an existing target
+    bool IsDirectory(const std::wstring& path, bool& exists);
+    // Single level; an existing directory is not an error
+    bool CreateDir(const std::wstring& path, std::wstring& err);
+
+    // ---- write ring (io_uring): positional writes queued in batches from registered
+    // buffers to registered files, completions reaped in batches. Linux only; Open fails
+    // elsewhere (or when the kernel refuses it) and callers fall back to WriteAt.
+    struct RingCompletion {
+        uint64_t tag;
+        int64_t result;     // bytes written, or -errno
+    };
+
+    class WriteRing {
+    public:
+        WriteRing() = default;
+        ~WriteRing();
+        WriteRing(const WriteRing&) = delete;
+        WriteRing& operator=(const WriteRing&) = delete;
+
+        // Room for entries writes in flight; bufferCount buffers of bufferBytes from buffers
+        // (one region) and fileSlots files are registered with the kernel
+        bool Open(uint32_t entries, void* buffers, size_t bufferBytes, uint32_t bufferCount, uint32_t fileSlots, std::wstring& err);
+        void Close();
+        bool IsOpen() const { return state != nullptr; }
+
+        // Registers file in slot; kInvalidFile empties it
+        bool SetFile(uint32_t slot, FileHandle file, std::wstring& err);
+        // Queues bytes at data (inside registered buffer) for the file in slot at offset;
+        // false when the submission queue is full
+        bool QueueWrite(uint32_t slot, uint32_t buffer, const void* data, size_t bytes, uint64_t offset, uint64_t tag);
+        // Submits everything queued and waits for at least waitFor completions; up to
+        // capacity of them go to done. Returns how many, or -1 (err set).
+        int Submit(uint32_t waitFor, RingCompletion* done, uint32_t capacity, std::wstring& err);
+
+    private:
+        struct State;
+        State* state = nullptr;
+    };
+
+    // ---- read-only file mapping (CreateFileMappingW / mmap)
+    struct MappedRegion {
+        const void* data = nullptr;
+        size_t bytes = 0;
+        FileHandle file = kInvalidFile;
+        void* mapping = nullptr;   // Win32 section handle; unused on POSIX
+    };
+
+    bool MapReadOnly(const std::wstring& path, MappedRegion& out, std::wstring& err);
+    void Unmap(MappedRegion& region);
+
+    // ---- text
+    std::string ToUtf8(const std::wstring& s);
+    std::wstring FromUtf8(const std::string& s);
+    std::wstring ErrorText(uint32_t code);   // system message for an error code, with the code
+    std::wstring LastErrorText();            // ErrorText(GetLastError() / errno)
+
+    // Diagnostics that are not worth failing a run for (OutputDebugStringW / stderr)
+    void DebugLog(const std::wstring& message);
+}
+
+#ifndef _WIN32
+// CRT's bounded swprintf for the array overload the runners use
+template <size_t N>
+inline int swprintf_s(wchar_t(&buffer)[N], const wchar_t* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int len = vswprintf(buffer, N, format, args);
+    va_end(args);
+    return len;
+}
+#endif
@@ -0,0 +1,668 @@
+#ifndef _WIN32
+#include "platform.h"
+#include <cerrno>
+#include <cstring>
+#include <cstdio>
+#include <ctime>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#if defined(__linux__)
+#include <linux/fs.h>
+#include <linux/futex.h>
+#include <linux/io_uring.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+namespace Platform {
+
+    static std::wstring ErrnoError(const wchar_t* what) {
+        return std::wstring(what) + L" failed: " + LastErrorText();
+    }
+
+    int64_t NowTicks() {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+    }
+
+    int64_t TicksPerSecond() {
+        return 1000000000LL;
+    }
+
+    struct ThreadStart {
+        ThreadProc proc;
+        void* param;
+    };
+
+    static void* ThreadTrampoline(void* raw) {
+        ThreadStart start = *static_cast<ThreadStart*>(raw);
+        delete static_cast<ThreadStart*>(raw);
+        start.proc(start.param);
+        return nullptr;
+    }
+
+    ThreadHandle StartThread(ThreadProc proc, void* param, std::wstring& err) {
+        pthread_t* thread = new pthread_t;
+        ThreadStart* start = new ThreadStart{ proc, param };
+        int rc = pthread_create(thread, nullptr, ThreadTrampoline, start);
+        if (rc != 0) {
+            errno = rc;
+            err = ErrnoError(L"pthread_create");
+            delete start;
+            delete thread;
+            return nullptr;
+        }
+        return thread;
+    }
+
+    void JoinThread(ThreadHandle thread) {
+        if (!thread) return;
+        pthread_t* t = static_cast<pthread_t*>(thread);
+        pthread_join(*t, nullptr);
+        delete t;
+    }
+
+    void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+
+    void YieldThread() {
+        sched_yield();
+    }
+
+    void SleepMillis(uint32_t ms) {
+        timespec ts{ (time_t)(ms / 1000), (long)(ms % 1000) * 1000000L };
+        while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {}
+    }
+
+    uint32_t ProcessId() {
+        return (uint32_t)getpid();
+    }
+
+    // std::atomic<int32_t> is a plain 32-bit word on every target we build for
+    static_assert(sizeof(std::atomic<int32_t>) == sizeof(int32_t), "futex word must be 32 bits");
+
+    void WaitOnWord(std::atomic<int32_t>& word, int32_t value) {
+#if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<int32_t*>(&word), FUTEX_WAIT_PRIVATE, value, nullptr, nullptr, 0);
+#else
+        word.wait(value);
+#endif
+    }
+
+    void WakeOneOnWord(std::atomic<int32_t>& word) {
+#if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<int32_t*>(&word), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#else
+        word.notify_one();
+#endif
+    }
+
+    void WakeAllOnWord(std::atomic<int32_t>& word) {
+#if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<int32_t*>(&word), FUTEX_WAKE_PRIVATE, 0x7FFFFFFF, nullptr, nullptr, 0);
+#else
+        word.notify_all();
+#endif
+    }
+
+    Mutex::Mutex() {
+        pthread_mutex_init(&native, nullptr);
+    }
+
+    Mutex::~Mutex() {
+        pthread_mutex_destroy(&native);
+    }
+
+    void Mutex::Lock() {
+        pthread_mutex_lock(&native);
+    }
+
+    void Mutex::Unlock() {
+        pthread_mutex_unlock(&native);
+    }
+
+    FileHandle OpenFile(const std::wstring& path, FileMode mode, std::wstring& err) {
+        int flags = O_WRONLY | O_CREAT | O_TRUNC;
+        switch (mode) {
+        case FileMode::Read: flags = O_RDONLY; break;
+        case FileMode::ReadWrite: flags = O_RDWR | O_CREAT | O_TRUNC; break;
+        case FileMode::Write: case FileMode::Temp: default: break;
+        }
+
+        int fd = open(ToUtf8(path).c_str(), flags | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            err = ErrnoError(L"open");
+            return kInvalidFile;
+        }
+        return fd;
+    }
+
+    void CloseFile(FileHandle file) {
+        if (file != kInvalidFile) close((int)file);
+    }
+
+    bool WriteAll(FileHandle file, const void* data, size_t bytes, std::wstring& err) {
+        const char* p = static_cast<const char*>(data);
+        while (bytes > 0) {
+            ssize_t n = write((int)file, p, bytes);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                err = ErrnoError(L"write");
+                return false;
+            }
+            p += n;
+            bytes -= (size_t)n;
+        }
+        return true;
+    }
+
+    bool WriteAt(FileHandle file, const void* data, size_t bytes, uint64_t offset, std::wstring& err) {
+        const char* p = static_cast<const char*>(data);
+        while (bytes > 0) {
+            ssize_t n = pwrite((int)file, p, bytes, (off_t)offset);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                err = ErrnoError(L"pwrite");
+                return false;
+            }
+            p += n;
+            bytes -= (size_t)n;
+            offset += (uint64_t)n;
+        }
+        return true;
+    }
+
+    bool ReadSome(FileHandle file, void* buffer, size_t capacity, size_t& got, std::wstring& err) {
+        for (;;) {
+            ssize_t n = read((int)file, buffer, capacity);
+            if (n >= 0) {
+                got = (size_t)n;
+                return true;
+            }
+            if (errno != EINTR) break;
+        }
+        err = ErrnoError(L"read");
+        got = 0;
+        return false;
+    }
+
+    bool ReadAt(FileHandle file, void* buffer, size_t capacity, uint64_t offset, size_t& got, std::wstring& err) {
+        for (;;) {
+            ssize_t n = pread((int)file, buffer, capacity, (off_t)offset);
+            if (n >= 0) {
+                got = (size_t)n;
+                return true;
+            }
+            if (errno != EINTR) break;
+        }
+        err = ErrnoError(L"pread");
+        got = 0;
+        return false;
+    }
+
+    bool GetFileSize(FileHandle file, uint64_t& bytes, std::wstring& err) {
+        struct stat st;
+        if (fstat((int)file, &st) != 0) {
+            err = ErrnoError(L"fstat");
+            return false;
+        }
+        bytes = (uint64_t)st.st_size;
+        return true;
+    }
+
+    bool SetFileSize(FileHandle file, uint64_t bytes, std::wstring& err) {
+        while (ftruncate((int)file, (off_t)bytes) != 0) {
+            if (errno == EINTR) continue;
+            err = ErrnoError(L"ftruncate");
+            return false;
+        }
+        return true;
+    }
+
+    bool Preallocate(FileHandle file, uint64_t bytes, std::wstring& err) {
+        if (bytes == 0) return true;
+#if defined(__linux__)
+        while (fallocate((int)file, FALLOC_FL_KEEP_SIZE, 0, (off_t)bytes) != 0) {
+            if (errno == EINTR) continue;
+            err = ErrnoError(L"fallocate");
+            return false;
+        }
+        return true;
+#else
+        (void)file;
+        err = L"No fallocate on this system";
+        return false;
+#endif
+    }
+
+    FileHandle ReopenUncached(FileHandle file, std::wstring& err) {
+#if defined(__linux__)
+        // a fresh open of the same file: O_DIRECT on a dup would switch the shared
+        // description, and with it the caller's handle, to direct I/O too
+        char path[64];
+        snprintf(path, sizeof(path), "/proc/self/fd/%d", (int)file);
+        int fd = open(path, O_WRONLY | O_DIRECT | O_CLOEXEC);
+        if (fd < 0) {
+            err = ErrnoError(L"open(O_DIRECT)");
+            return kInvalidFile;
+        }
+        return fd;
+#else
+        (void)file;
+        err = L"No O_DIRECT on this system";
+        return kInvalidFile;
+#endif
+    }
+
+    // the fallback every filesystem takes: through user space, 1 MiB at a time
+    static bool CopyBuffered(int in, uint64_t inOffset, int out, uint64_t outOffset, uint64_t bytes, std::wstring& err) {
+        const size_t kBlock = (size_t)1 << 20;
+        std::vector<char> buf((size_t)(bytes < kBlock ? bytes : kBlock));
+        while (bytes > 0) {
+            size_t got = 0;
+            if (!ReadAt(in, buf.data(), (size_t)(bytes < buf.size() ? bytes : buf.size()), inOffset, got, err)) return false;
+            if (got == 0) { err = L"Copy source ended early"; return false; }
+            if (!WriteAt(out, buf.data(), got, outOffset, err)) return false;
+            inOffset += got;
+            outOffset += got;
+            bytes -= got;
+        }
+        return true;
+    }
+
+    bool CopyRange(FileHandle in, uint64_t inOffset, FileHandle out, uint64_t outOffset, uint64_t bytes, std::wstring& err) {
+        if (bytes == 0) return true;
+#if defined(__linux__)
+        // reflink (Btrfs, XFS, ...): block-aligned offsets, the range running to the end of
+        // the source so its length may be ragged
+        struct stat st;
+        if (fstat((int)in, &st) == 0 && st.st_blksize > 0 && (uint64_t)st.st_size == inOffset + bytes
+            && inOffset % (uint64_t)st.st_blksize == 0 && outOffset % (uint64_t)st.st_blksize == 0) {
+            file_clone_range range{ (int64_t)in, inOffset, bytes, outOffset };
+            if (ioctl((int)out, FICLONERANGE, &range) == 0) return true;
+        }
+
+        // copy_file_range keeps the data in the kernel (and may reflink on its own); older
+        // kernels and some filesystem pairs refuse it, which leaves the buffered copy
+        while (bytes > 0) {
+            loff_t from = (loff_t)inOffset, to = (loff_t)outOffset;
+            ssize_t n = copy_file_range((int)in, &from, (int)out, &to, (size_t)bytes, 0);
+            if (n > 0) {
+                inOffset += (uint64_t)n;
+                outOffset += (uint64_t)n;
+                bytes -= (uint64_t)n;
+                continue;
+            }
+            if (n == 0) { err = L"Copy source ended early"; return false; }
+            if (errno == EINTR) continue;
+            if (errno == ENOSYS || errno == EXDEV || errno == EINVAL || errno == EOPNOTSUPP || errno == EPERM) break;
+            err = ErrnoError(L"copy_file_range");
+            return false;
+        }
+        if (bytes == 0) return true;
+#endif
+        return CopyBuffered((int)in, inOffset, (int)out, outOffset, bytes, err);
+    }
+
+    bool RemoveFile(const std::wstring& path) {
+        return unlink(ToUtf8(path).c_str()) == 0;
+    }
+
+    bool RenameFile(const std::wstring& from, const std::wstring& to) {
+        return rename(ToUtf8(from).c_str(), ToUtf8(to).c_str()) == 0;
+    }
+
+    bool IsDirectory(const std::wstring& path, bool& exists) {
+        struct stat st;
+        exists = stat(ToUtf8(path).c_str(), &st) == 0;
+        return exists && S_ISDIR(st.st_mode);
+    }
+
+    bool CreateDir(const std::wstring& path, std::wstring& err) {
+        if (mkdir(ToUtf8(path).c_str(), 0755) == 0 || errno == EEXIST) return true;
+        err = L"Failed to create directory '" + path + L"': " + LastErrorText();
+        return false;
+    }
+
+#if defined(__linux__)
+    // Raw io_uring: no liburing dependency, just the three syscalls and the shared rings
+    struct WriteRing::State {
+        int fd = -1;
+        void* sqRing = nullptr;
+        size_t sqRingBytes = 0;
+        void* cqRing = nullptr;         // == sqRing with IORING_FEAT_SINGLE_MMAP
+        size_t cqRingBytes = 0;
+        io_uring_sqe* sqes = nullptr;
+        size_t sqesBytes = 0;
+
+        unsigned* sqHead = nullptr;
+        unsigned* sqTail = nullptr;
+        unsigned* sqArray = nullptr;
+        unsigned sqMask = 0;
+        unsigned sqEntries = 0;
+        unsigned* cqHead = nullptr;
+        unsigned* cqTail = nullptr;
+        io_uring_cqe* cqes = nullptr;
+        unsigned cqMask = 0;
+
+        unsigned tail = 0;              // next SQE; the kernel sees it at Submit
+        unsigned submitted = 0;         // tail the kernel was last given
+    };
+
+    static int RingEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+        return (int)syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0);
+    }
+
+    static int RingRegister(int fd, unsigned op, const void* arg, unsigned count) {
+        return (int)syscall(__NR_io_uring_register, fd, op, arg, count);
+    }
+
+    WriteRing::~WriteRing() {
+        Close();
+    }
+
+    bool WriteRing::Open(uint32_t entries, void* buffers, size_t bufferBytes, uint32_t bufferCount, uint32_t fileSlots, std::wstring& err) {
+        Close();
+        State* st = new State;
+        state = st;
+
+        io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        st->fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+        if (st->fd < 0) {
+            err = ErrnoError(L"io_uring_setup");
+            Close();
+            return false;
+        }
+
+        st->sqRingBytes = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        st->cqRingBytes = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single && st->cqRingBytes > st->sqRingBytes) st->sqRingBytes = st->cqRingBytes;
+
+        st->sqRing = mmap(nullptr, st->sqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, st->fd, IORING_OFF_SQ_RING);
+        if (st->sqRing == MAP_FAILED) {
+            st->sqRing = nullptr;
+            err = ErrnoError(L"mmap(io_uring SQ)");
+            Close();
+            return false;
+        }
+        if (single) {
+            st->cqRing = st->sqRing;
+        }
+        else {
+            st->cqRing = mmap(nullptr, st->cqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, st->fd, IORING_OFF_CQ_RING);
+            if (st->cqRing == MAP_FAILED) {
+                st->cqRing = nullptr;
+                err = ErrnoError(L"mmap(io_uring CQ)");
+                Close();
+                return false;
+            }
+        }
+        st->sqesBytes = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = mmap(nullptr, st->sqesBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, st->fd, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) {
+            err = ErrnoError(L"mmap(io_uring SQEs)");
+            Close();
+            return false;
+        }
+        st->sqes = static_cast<io_uring_sqe*>(sqes);
+
+        char* sq = static_cast<char*>(st->sqRing);
+        char* cq = static_cast<char*>(st->cqRing);
+        st->sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        st->sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        st->sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        st->sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        st->sqEntries = params.sq_entries;
+        st->cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        st->cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        st->cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        st->cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        st->tail = st->submitted = *st->sqTail;
+
+        // registered buffers are pinned once instead of on every write; registered files
+        // skip the fd table lookup and reference counting per write
+        std::vector<iovec> iov(bufferCount);
+        for (uint32_t i = 0; i < bufferCount; i++) iov[i] = { static_cast<char*>(buffers) + i * bufferBytes, bufferBytes };
+        if (RingRegister(st->fd, IORING_REGISTER_BUFFERS, iov.data(), bufferCount) < 0) {
+            err = ErrnoError(L"io_uring_register(buffers)");
+            Close();
+            return false;
+        }
+        std::vector<int> fds(fileSlots, -1);
+        if (RingRegister(st->fd, IORING_REGISTER_FILES, fds.data(), fileSlots) < 0) {
+            err = ErrnoError(L"io_uring_register(files)");
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    void WriteRing::Close() {
+        State* st = state;
+        if (!st) return;
+        if (st->sqes) munmap(st->sqes, st->sqesBytes);
+        if (st->cqRing && st->cqRing != st->sqRing) munmap(st->cqRing, st->cqRingBytes);
+        if (st->sqRing) munmap(st->sqRing, st->sqRingBytes);
+        if (st->fd >= 0) close(st->fd);   // also drops the registrations
+        delete st;
+        state = nullptr;
+    }
+
+    bool WriteRing::SetFile(uint32_t slot, FileHandle file, std::wstring& err) {
+        int fd = file == kInvalidFile ? -1 : (int)file;
+        io_uring_files_update update;
+        memset(&update, 0, sizeof(update));
+        update.offset = slot;
+        update.fds = (uint64_t)(uintptr_t)&fd;
+        if (RingRegister(state->fd, IORING_REGISTER_FILES_UPDATE, &update, 1) < 0) {
+            err = ErrnoError(L"io_uring_register(files update)");
+            return false;
+        }
+        return true;
+    }
+
+    bool WriteRing::QueueWrite(uint32_t slot, uint32_t buffer, const void* data, size_t bytes, uint64_t offset, uint64_t tag) {
+        State* st = state;
+        unsigned head = __atomic_load_n(st->sqHead, __ATOMIC_ACQUIRE);
+        if (st->tail - head >= st->sqEntries) return false;
+
+        unsigned index = st->tail & st->sqMask;
+        io_uring_sqe* sqe = &st->sqes[index];
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = IORING_OP_WRITE_FIXED;
+        sqe->flags = IOSQE_FIXED_FILE;
+        sqe->fd = (int)slot;
+        sqe->addr = (uint64_t)(uintptr_t)data;
+        sqe->len = (uint32_t)bytes;
+        sqe->off = offset;
+        sqe->buf_index = (uint16_t)buffer;
+        sqe->user_data = tag;
+        st->sqArray[index] = index;
+        st->tail++;
+        return true;
+    }
+
+    int WriteRing::Submit(uint32_t waitFor, RingCompletion* done, uint32_t capacity, std::wstring& err) {
+        State* st = state;
+        __atomic_store_n(st->sqTail, st->tail, __ATOMIC_RELEASE);
+        unsigned toSubmit = st->tail - st->submitted;
+
+        // one syscall hands over the whole batch and, if asked, waits for completions
+        if (toSubmit > 0 || waitFor > 0) {
+            for (;;) {
+                int rc = RingEnter(st->fd, toSubmit, waitFor, waitFor ? IORING_ENTER_GETEVENTS : 0);
+                if (rc >= 0) {
+                    st->submitted += (unsigned)rc;
+                    break;
+                }
+                if (errno == EINTR) continue;
+                if (errno == EAGAIN || errno == EBUSY) {
+                    // completions must be reaped first: take what is there and come back
+                    if (waitFor == 0) break;
+                    waitFor = 0;
+                    continue;
+                }
+                err = ErrnoError(L"io_uring_enter");
+                return -1;
+            }
+        }
+
+        unsigned head = *st->cqHead;
+        unsigned tail = __atomic_load_n(st->cqTail, __ATOMIC_ACQUIRE);
+        int count = 0;
+        while (head != tail && (uint32_t)count < capacity) {
+            const io_uring_cqe& cqe = st->cqes[head & st->cqMask];
+            done[count++] = { cqe.user_data, (int64_t)cqe.res };
+            head++;
+        }
+        __atomic_store_n(st->cqHead, head, __ATOMIC_RELEASE);
+        return count;
+    }
+#else
+    WriteRing::~WriteRing() {
+        Close();
+    }
+
+    bool WriteRing::Open(uint32_t, void*, size_t, uint32_t, uint32_t, std::wstring& err) {
+        err = L"No io_uring on this system";
+        return false;
+    }
+
+    void WriteRing::Close() {
+    }
+
+    bool WriteRing::SetFile(uint32_t, FileHandle, std::wstring& err) {
+        err = L"No io_uring on this system";
+        return false;
+    }
+
+    bool WriteRing::QueueWrite(uint32_t, uint32_t, const void*, size_t, uint64_t, uint64_t) {
+        return false;
+    }
+
+    int WriteRing::Submit(uint32_t, RingCompletion*, uint32_t, std::wstring& err) {
+        err = L"No io_uring on this system";
+        return -1;
+    }
+#endif
+
+    bool MapReadOnly(const std::wstring& path, MappedRegion& out, std::wstring& err) {
+        out = MappedRegion();
+        err.clear();
+
+        out.file = OpenFile(path, FileMode::Read, err);
+        if (out.file == kInvalidFile) {
+            err = L"Failed to open file: " + err;
+            return false;
+        }
+
+        uint64_t size = 0;
+        if (!GetFileSize(out.file, size, err) || size == 0 || size > SIZE_MAX) {
+            if (err.empty()) err = size == 0 ? L"File is empty" : L"File is too large";
+            Unmap(out);
+            return false;
+        }
+
+        void* view = mmap(nullptr, (size_t)size, PROT_READ, MAP_PRIVATE, (int)out.file, 0);
+        if (view == MAP_FAILED) {
+            err = L"Failed to map view: " + LastErrorText();
+            Unmap(out);
+            return false;
+        }
+
+        out.data = view;
+        out.bytes = (size_t)size;
+        return true;
+    }
+
+    void Unmap(MappedRegion& region) {
+        if (region.data) munmap(const_cast<void*>(region.data), region.bytes);
+        CloseFile(region.file);
+        region = MappedRegion();
+    }
+
+    std::string ToUtf8(const std::wstring& s) {
+        // wchar_t is UTF-32 here
+        std::string out;
+        out.reserve(s.size());
+        for (wchar_t wc : s) {
+            uint32_t c = (uint32_t)wc;
+            if (c < 0x80) {
+                out += (char)c;
+            } else if (c < 0x800) {
+                out += (char)(0xC0 | (c >> 6));
+                out += (char)(0x80 | (c & 0x3F));
+            } else if (c < 0x10000) {
+                out += (char)(0xE0 | (c >> 12));
+                out += (char)(0x80 | ((c >> 6) & 0x3F));
+                out += (char)(0x80 | (c & 0x3F));
+            } else {
+                out += (char)(0xF0 | (c >> 18));
+                out += (char)(0x80 | ((c >> 12) & 0x3F));
+                out += (char)(0x80 | ((c >> 6) & 0x3F));
+                out += (char)(0x80 | (c & 0x3F));
+            }
+        }
+        return out;
+    }
+
+    std::wstring FromUtf8(const std::string& s) {
+        // invalid sequences come through as U+FFFD
+        std::wstring out;
+        out.reserve(s.size());
+        size_t i = 0;
+        while (i < s.size()) {
+            unsigned char c = (unsigned char)s[i];
+            uint32_t cp;
+            int extra;
+            if (c < 0x80) { cp = c; extra = 0; }
+            else if ((c & 0xE0) == 0xC0) { cp = c & 0x1F; extra = 1; }
+            else if ((c & 0xF0) == 0xE0) { cp = c & 0x0F; extra = 2; }
+            else if ((c & 0xF8) == 0xF0) { cp = c & 0x07; extra = 3; }
+            else { out += (wchar_t)0xFFFD; i++; continue; }
+
+            if (i + extra >= s.size() && extra > 0) {   // truncated sequence
+                out += (wchar_t)0xFFFD;
+                break;
+            }
+            bool ok = true;
+            for (int k = 1; k <= extra; k++) {
+                unsigned char cc = (unsigned char)s[i + k];
+                if ((cc & 0xC0) != 0x80) { ok = false; break; }
+                cp = (cp << 6) | (cc & 0x3F);
+            }
+            if (!ok) { out += (wchar_t)0xFFFD; i++; continue; }
+            out += (wchar_t)cp;
+            i += 1 + extra;
+        }
+        return out;
+    }
+
+    std::wstring ErrorText(uint32_t code) {
+        const char* msg = strerror((int)code);
+        std::wstring text(msg, msg + strlen(msg));
+        return text + L" (" + std::to_wstring(code) + L")";
+    }
+
+    std::wstring LastErrorText() {
+        return ErrorText((uint32_t)errno);
+    }
+
+    void DebugLog(const std::wstring& message) {
+        fprintf(stderr, "%s\n", ToUtf8(message).c_str());
+    }
+}
+#endif
@@ -0,0 +1,376 @@
+#ifdef _WIN32
+#include "platform.h"
+#include <windows.h>
+#include <winioctl.h>
+#include <process.h>
+#include <vector>
+#pragma comment(lib, "Synchronization.lib")
+
+namespace Platform {
+
+    static std::wstring Win32Error(const wchar_t* what) {
+        return std::wstring(what) + L" failed: " + std::to_wstring(GetLastError());
+    }
+
+    int64_t NowTicks() {
+        LARGE_INTEGER now;
+        QueryPerformanceCounter(&now);
+        return now.QuadPart;
+    }
+
+    int64_t TicksPerSecond() {
+        static const int64_t freq = [] {
+            LARGE_INTEGER f;
+            QueryPerformanceFrequency(&f);
+            return f.QuadPart;
+        }();
+        return freq;
+    }
+
+    ThreadHandle StartThread(ThreadProc proc, void* param, std::wstring& err) {
+        HANDLE h = (HANDLE)_beginthreadex(nullptr, 0, proc, param, 0, nullptr);
+        if (!h) {
+            err = Win32Error(L"_beginthreadex");
+            return nullptr;
+        }
+        return h;
+    }
+
+    void JoinThread(ThreadHandle thread) {
+        if (!thread) return;
+        WaitForSingleObject((HANDLE)thread, INFINITE);
+        CloseHandle((HANDLE)thread);
+    }
+
+    void CpuRelax() {
+        YieldProcessor();
+    }
+
+    void YieldThread() {
+        if (!SwitchToThread()) Sleep(0);
+    }
+
+    void SleepMillis(uint32_t ms) {
+        Sleep(ms);
+    }
+
+    uint32_t ProcessId() {
+        return GetCurrentProcessId();
+    }
+
+    void WaitOnWord(std::atomic<int32_t>& word, int32_t value) {
+        WaitOnAddress(&word, &value, sizeof(int32_t), INFINITE);
+    }
+
+    void WakeOneOnWord(std::atomic<int32_t>& word) {
+        WakeByAddressSingle(&word);
+    }
+
+    void WakeAllOnWord(std::atomic<int32_t>& word) {
+        WakeByAddressAll(&word);
+    }
+
+    Mutex::Mutex() : native(nullptr) {
+        InitializeSRWLock(reinterpret_cast<PSRWLOCK>(&native));
+    }
+
+    Mutex::~Mutex() {}
+
+    void Mutex::Lock() {
+        AcquireSRWLockExclusive(reinterpret_cast<PSRWLOCK>(&native));
+    }
+
+    void Mutex::Unlock() {
+        ReleaseSRWLockExclusive(reinterpret_cast<PSRWLOCK>(&native));
+    }
+
+    FileHandle OpenFile(const std::wstring& path, FileMode mode, std::wstring& err) {
+        DWORD access = GENERIC_WRITE, disposition = CREATE_ALWAYS, attrs = FILE_ATTRIBUTE_NORMAL;
+        switch (mode) {
+        case FileMode::Read: access = GENERIC_READ; disposition = OPEN_EXISTING; break;
+        case FileMode::ReadWrite: access = GENERIC_READ | GENERIC_WRITE; break;
+        case FileMode::Temp: attrs = FILE_ATTRIBUTE_TEMPORARY; break;
+        case FileMode::Write: default: break;
+        }
+
+        // write sharing lets ReopenUncached open a second, uncached handle to it
+        HANDLE h = CreateFileW(path.c_str(), access, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, disposition, attrs, nullptr);
+        if (h == INVALID_HANDLE_VALUE) {
+            err = Win32Error(L"CreateFileW");
+            return kInvalidFile;
+        }
+        return (FileHandle)h;
+    }
+
+    void CloseFile(FileHandle file) {
+        if (file != kInvalidFile) CloseHandle((HANDLE)file);
+    }
+
+    bool WriteAll(FileHandle file, const void* data, size_t bytes, std::wstring& err) {
+        const char* p = static_cast<const char*>(data);
+        while (bytes > 0) {
+            DWORD part = bytes > 0x40000000 ? 0x40000000 : (DWORD)bytes;
+            DWORD bw = 0;
+            if (!WriteFile((HANDLE)file, p, part, &bw, nullptr) || bw != part) {
+                err = Win32Error(L"WriteFile");
+                return false;
+            }
+            p += part;
+            bytes -= part;
+        }
+        return true;
+    }
+
+    bool WriteAt(FileHandle file, const void* data, size_t bytes, uint64_t offset, std::wstring& err) {
+        const char* p = static_cast<const char*>(data);
+        while (bytes > 0) {
+            DWORD part = bytes > 0x40000000 ? 0x40000000 : (DWORD)bytes;
+            OVERLAPPED ov{};
+            ov.Offset = (DWORD)offset;
+            ov.OffsetHigh = (DWORD)(offset >> 32);
+            DWORD bw = 0;
+            if (!WriteFile((HANDLE)file, p, part, &bw, &ov) || bw != part) {
+                err = Win32Error(L"WriteFile(offset)");
+                return false;
+            }
+            p += part;
+            bytes -= part;
+            offset += part;
+        }
+        return true;
+    }
+
+    bool ReadSome(FileHandle file, void* buffer, size_t capacity, size_t& got, std::wstring& err) {
+        DWORD br = 0;
+        DWORD want = capacity > 0x40000000 ? 0x40000000 : (DWORD)capacity;
+        if (!ReadFile((HANDLE)file, buffer, want, &br, nullptr)) {
+            err = Win32Error(L"ReadFile");
+            got = 0;
+            return false;
+        }
+        got = br;
+        return true;
+    }
+
+    bool ReadAt(FileHandle file, void* buffer, size_t capacity, uint64_t offset, size_t& got, std::wstring& err) {
+        DWORD br = 0;
+        DWORD want = capacity > 0x40000000 ? 0x40000000 : (DWORD)capacity;
+        OVERLAPPED ov{};
+        ov.Offset = (DWORD)offset;
+        ov.OffsetHigh = (DWORD)(offset >> 32);
+        if (!ReadFile((HANDLE)file, buffer, want, &br, &ov)) {
+            if (GetLastError() == ERROR_HANDLE_EOF) { got = 0; return true; }
+            err = Win32Error(L"ReadFile(offset)");
+            got = 0;
+            return false;
+        }
+        got = br;
+        return true;
+    }
+
+    bool GetFileSize(FileHandle file, uint64_t& bytes, std::wstring& err) {
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx((HANDLE)file, &size)) {
+            err = Win32Error(L"GetFileSizeEx");
+            return false;
+        }
+        bytes = (uint64_t)size.QuadPart;
+        return true;
+    }
+
+    bool SetFileSize(FileHandle file, uint64_t bytes, std::wstring& err) {
+        FILE_END_OF_FILE_INFO eof{};
+        eof.EndOfFile.QuadPart = (LONGLONG)bytes;
+        if (!SetFileInformationByHandle((HANDLE)file, FileEndOfFileInfo, &eof, sizeof(eof))) {
+            err = Win32Error(L"SetFileInformationByHandle(EndOfFile)");
+            return false;
+        }
+        return true;
+    }
+
+    bool Preallocate(FileHandle file, uint64_t bytes, std::wstring& err) {
+        if (bytes == 0) return true;
+        FILE_ALLOCATION_INFO alloc{};
+        alloc.AllocationSize.QuadPart = (LONGLONG)bytes;
+        if (!SetFileInformationByHandle((HANDLE)file, FileAllocationInfo, &alloc, sizeof(alloc))) {
+            err = Win32Error(L"SetFileInformationByHandle(Allocation)");
+            return false;
+        }
+        return true;
+    }
+
+    FileHandle ReopenUncached(FileHandle file, std::wstring& err) {
+        HANDLE h = ReOpenFile((HANDLE)file, GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, FILE_FLAG_NO_BUFFERING);
+        if (h == INVALID_HANDLE_VALUE) {
+            err = Win32Error(L"ReOpenFile(NO_BUFFERING)");
+            return kInvalidFile;
+        }
+        return (FileHandle)h;
+    }
+
+    bool CopyRange(FileHandle in, uint64_t inOffset, FileHandle out, uint64_t outOffset, uint64_t bytes, std::wstring& err) {
+        if (bytes == 0) return true;
+
+        // ReFS block cloning: cluster-aligned (64 KiB covers every cluster size) and inside
+        // the target's current size, which the caller sets up front with SetFileSize
+        const uint64_t kCloneAlign = 64 * 1024;
+        uint64_t outSize = 0;
+        std::wstring sizeErr;
+        if (inOffset % kCloneAlign == 0 && outOffset % kCloneAlign == 0 && bytes % kCloneAlign == 0
+            && GetFileSize(out, outSize, sizeErr) && outSize >= outOffset + bytes) {
+            DUPLICATE_EXTENTS_DATA dup{};
+            dup.FileHandle = (HANDLE)in;
+            dup.SourceFileOffset.QuadPart = (LONGLONG)inOffset;
+            dup.TargetFileOffset.QuadPart = (LONGLONG)outOffset;
+            dup.ByteCount.QuadPart = (LONGLONG)bytes;
+            DWORD returned = 0;
+            if (DeviceIoControl((HANDLE)out, FSCTL_DUPLICATE_EXTENTS_TO_FILE, &dup, sizeof(dup),
+                    nullptr, 0, &returned, nullptr)) {
+                return true;
+            }
+        }
+
+        // NTFS has no in-kernel range copy: through user space, 1 MiB at a time
+        const size_t kBlock = (size_t)1 << 20;
+        std::vector<char> buf((size_t)(bytes < kBlock ? bytes : kBlock));
+        while (bytes > 0) {
+            size_t got = 0;
+            if (!ReadAt(in, buf.data(), (size_t)(bytes < buf.size() ? bytes : buf.size()), inOffset, got, err)) return false;
+            if (got == 0) { err = L"Copy source ended early"; return false; }
+            if (!WriteAt(out, buf.data(), got, outOffset, err)) return false;
+            inOffset += got;
+            outOffset += got;
+            bytes -= got;
+        }
+        return true;
+    }
+
+    bool RemoveFile(const std::wstring& path) {
+        return DeleteFileW(path.c_str()) != FALSE;
+    }
+
+    bool RenameFile(const std::wstring& from, const std::wstring& to) {
+        return MoveFileExW(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING) != FALSE;
+    }
+
+    bool IsDirectory(const std::wstring& path, bool& exists) {
+        DWORD attrs = GetFileAttributesW(path.c_str());
+        exists = attrs != INVALID_FILE_ATTRIBUTES;
+        return exists && (attrs & FILE_ATTRIBUTE_DIRECTORY);
+    }
+
+    bool CreateDir(const std::wstring& path, std::wstring& err) {
+        if (CreateDirectoryW(path.c_str(), NULL)) return true;
+        if (GetLastError() == ERROR_ALREADY_EXISTS) return true;
+        err = L"Failed to create directory '" + path + L"': " + LastErrorText();
+        return false;
+    }
+
+    // No io_uring here: Open fails and the callers keep their WriteAt path
+    WriteRing::~WriteRing() {
+        Close();
+    }
+
+    bool WriteRing::Open(uint32_t, void*, size_t, uint32_t, uint32_t, std::wstring& err) {
+        err = L"No io_uring on Windows";
+        return false;
+    }
+
+    void WriteRing::Close() {
+    }
+
+    bool WriteRing::SetFile(uint32_t, FileHandle, std::wstring& err) {
+        err = L"No io_uring on Windows";
+        return false;
+    }
+
+    bool WriteRing::QueueWrite(uint32_t, uint32_t, const void*, size_t, uint64_t, uint64_t) {
+        return false;
+    }
+
+    int WriteRing::Submit(uint32_t, RingCompletion*, uint32_t, std::wstring& err) {
+        err = L"No io_uring on Windows";
+        return -1;
+    }
+
+    bool MapReadOnly(const std::wstring& path, MappedRegion& out, std::wstring& err) {
+        out = MappedRegion();
+        err.clear();
+
+        out.file = OpenFile(path, FileMode::Read, err);
+        if (out.file == kInvalidFile) {
+            err = L"Failed to open file: " + err;
+            return false;
+        }
+
+        uint64_t size = 0;
+        if (!GetFileSize(out.file, size, err) || size == 0 || size > SIZE_MAX) {
+            if (err.empty()) err = size == 0 ? L"File is empty" : L"File is too large";
+            Unmap(out);
+            return false;
+        }
+
+        HANDLE hMap = CreateFileMappingW((HANDLE)out.file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (hMap == NULL) {
+            err = L"Failed to create file mapping: " + LastErrorText();
+            Unmap(out);
+            return false;
+        }
+        out.mapping = hMap;
+
+        out.data = MapViewOfFile(hMap, FILE_MAP_READ, 0, 0, (size_t)size);
+        if (!out.data) {
+            err = L"Failed to map view: " + LastErrorText();
+            Unmap(out);
+            return false;
+        }
+
+        out.bytes = (size_t)size;
+        return true;
+    }
+
+    void Unmap(MappedRegion& region) {
+        if (region.data) UnmapViewOfFile(region.data);
+        if (region.mapping) CloseHandle((HANDLE)region.mapping);
+        CloseFile(region.file);
+        region = MappedRegion();
+    }
+
+    std::string ToUtf8(const std::wstring& s) {
+        if (s.empty()) return std::string();
+        int size = WideCharToMultiByte(CP_UTF8, 0, s.c_str(), (int)s.size(), NULL, 0, NULL, NULL);
+        std::string out(size > 0 ? size : 0, '\0');
+        if (size > 0) WideCharToMultiByte(CP_UTF8, 0, s.c_str(), (int)s.size(), &out[0], size, NULL, NULL);
+        return out;
+    }
+
+    std::wstring FromUtf8(const std::string& s) {
+        if (s.empty()) return std::wstring();
+        int size = MultiByteToWideChar(CP_UTF8, 0, s.c_str(), (int)s.size(), NULL, 0);
+        std::wstring out(size > 0 ? size : 0, L'\0');
+        if (size > 0) MultiByteToWideChar(CP_UTF8, 0, s.c_str(), (int)s.size(), &out[0], size);
+        return out;
+    }
+
+    std::wstring ErrorText(uint32_t code) {
+        wchar_t* msg = nullptr;
+        DWORD len = FormatMessageW(FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
+            NULL, code, 0, (LPWSTR)&msg, 0, NULL);
+        std::wstring text;
+        if (len && msg) {
+            text.assign(msg, len);
+            while (!text.empty() && (text.back() == L'\r' || text.back() == L'\n')) text.pop_back();
+        }
+        if (msg) LocalFree(msg);
+        return text + L" (" + std::to_wstring(code) + L")";
+    }
+
+    std::wstring LastErrorText() {
+        return ErrorText(GetLastError());
+    }
+
+    void DebugLog(const std::wstring& message) {
+        OutputDebugStringW(message.c_str());
+    }
+}
+#endif
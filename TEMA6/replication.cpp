@@ -0,0 +1,87 @@
+#include "replication.h"
+#include "thread_pool.h"
+#include "topology.h"
+#include "timing.h"
+#include "platform.h"
+#include <algorithm>
+#include <cstring>
+
+namespace Replication {
+
+    struct CopyJob {
+        const uint32_t* src;
+        size_t bytes;
+        uint32_t node;
+        uint32_t* dst = nullptr;
+    };
+
+    static unsigned int PLATFORM_CALL CopyProc(void* param) {
+        CopyJob* job = static_cast<CopyJob*>(param);
+        job->dst = static_cast<uint32_t*>(Topology::AllocOnNode(job->bytes, job->node));
+        if (job->dst) memcpy(job->dst, job->src, job->bytes);
+        return 0;
+    }
+
+    // Pool threads that sit before the first thread of a node still get a task
+    static unsigned int PLATFORM_CALL IdleProc(void*) {
+        return 0;
+    }
+
+    bool ReplicateInput(const FileIO::MappedFile& mf, const std::vector<uint32_t>& workerNodes,
+        InputReplicas& out, std::wstring& err) {
+        err.clear();
+        ReleaseReplicas(out);
+        if (!mf.data || mf.count == 0) {
+            err = L"No input mapped";
+            return false;
+        }
+
+        // first worker (= pool thread) of each node does that node's copy
+        std::vector<CopyJob> jobs;
+        std::vector<uint32_t> jobThread;
+        for (uint32_t i = 0; i < (uint32_t)workerNodes.size(); i++) {
+            if (std::find(out.nodes.begin(), out.nodes.end(), workerNodes[i]) != out.nodes.end()) continue;
+            out.nodes.push_back(workerNodes[i]);
+            jobs.push_back({ mf.data, mf.count * sizeof(uint32_t), workerNodes[i] });
+            jobThread.push_back(i);
+        }
+        if (jobs.empty()) {
+            err = L"No worker nodes";
+            return false;
+        }
+
+        std::vector<ThreadPool::Task> tasks(jobThread.back() + 1, ThreadPool::Task{ IdleProc, nullptr });
+        for (size_t j = 0; j < jobs.size(); j++) tasks[jobThread[j]] = { CopyProc, &jobs[j] };
+
+        Timing::Ticks start = Timing::Now();
+        bool ran = ThreadPool::RunJob(tasks);
+        out.time_us = Timing::ElapsedMicros(start, Timing::Now());
+
+        out.count = mf.count;
+        out.bytes = mf.count * sizeof(uint32_t);
+        for (const CopyJob& job : jobs) out.copies.push_back(job.dst);
+
+        if (!ran || std::find(out.copies.begin(), out.copies.end(), nullptr) != out.copies.end()) {
+            err = L"Replica allocation failed";
+            ReleaseReplicas(out);
+            return false;
+        }
+        return true;
+    }
+
+    void ReleaseReplicas(InputReplicas& r) {
+        for (uint32_t* p : r.copies) Topology::FreeOnNode(p, r.bytes);
+        r = InputReplicas();
+    }
+
+    std::vector<const uint32_t*> WorkerViews(const InputReplicas& r, const std::vector<uint32_t>& workerNodes,
+        uint32_t nWorkers, const uint32_t* fallback) {
+        std::vector<const uint32_t*> views(nWorkers, fallback);
+        for (uint32_t i = 0; i < nWorkers && i < workerNodes.size(); i++) {
+            for (size_t c = 0; c < r.nodes.size(); c++) {
+                if (r.nodes[c] == workerNodes[i]) { views[i] = r.copies[c]; break; }
+            }
+        }
+        return views;
+    }
+}
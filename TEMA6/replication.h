@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <string>
+#include "fileio.h"
+
+namespace Replication {
+    // Node-local copies of a mapped input, one per NUMA node in use
+    struct InputReplicas {
+        std::vector<uint32_t> nodes;          // NUMA node of copies[r]
+        std::vector<uint32_t*> copies;        // count values each, pages on nodes[r]
+        size_t count = 0;
+        size_t bytes = 0;
+        double time_us = 0.0;                 // Allocate + copy, all nodes in parallel
+    };
+
+    // Copy mf into memory on every node that appears in workerNodes. Each copy is
+    // made by the first pool thread placed on that node, so pages are first-touched
+    // locally; run it after ThreadPool::SetPlacement and outside any timed section.
+    bool ReplicateInput(const FileIO::MappedFile& mf, const std::vector<uint32_t>& workerNodes,
+        InputReplicas& out, std::wstring& err);
+
+    void ReleaseReplicas(InputReplicas& r);
+
+    // Input pointer for workers 0..nWorkers-1: the copy on the worker's node,
+    // or fallback when that node has none
+    std::vector<const uint32_t*> WorkerViews(const InputReplicas& r, const std::vector<uint32_t>& workerNodes,
+        uint32_t nWorkers, const uint32_t* fallback);
+}
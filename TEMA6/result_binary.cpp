@@ -0,0 +1,246 @@
+#include "result_binary.h"
+#include "result_writer.h"
+#include <cstring>
+#include <cwchar>
+
+namespace ResultBinary {
+
+    // encoding codes in the file; 0 is never written
+    static uint16_t EncodingCode(FileIO::ResultEncoding encoding) {
+        switch (encoding) {
+        case FileIO::ResultEncoding::Packed32: return 1;
+        case FileIO::ResultEncoding::DeltaVarint: return 2;
+        default: return 0;
+        }
+    }
+
+    static void Put16(uint8_t* p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+    static void Put32(uint8_t* p, uint32_t v) { for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i)); }
+    static void Put64(uint8_t* p, uint64_t v) { for (int i = 0; i < 8; i++) p[i] = (uint8_t)(v >> (8 * i)); }
+    static void PutDouble(uint8_t* p, double d) { uint64_t v; memcpy(&v, &d, sizeof(v)); Put64(p, v); }
+
+    static uint16_t Get16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+    static uint32_t Get32(const uint8_t* p) { uint32_t v = 0; for (int i = 3; i >= 0; i--) v = (v << 8) | p[i]; return v; }
+    static uint64_t Get64(const uint8_t* p) { uint64_t v = 0; for (int i = 7; i >= 0; i--) v = (v << 8) | p[i]; return v; }
+    static double GetDouble(const uint8_t* p) { uint64_t v = Get64(p); double d; memcpy(&d, &v, sizeof(d)); return d; }
+
+    uint64_t Header::TotalCount() const {
+        uint64_t total = 0;
+        for (const WorkerEntry& w : workers) total += w.count;
+        return total;
+    }
+
+    static std::vector<uint8_t> Serialize(const Header& header) {
+        std::vector<uint8_t> bytes(header.Bytes(), 0);
+        uint8_t* p = bytes.data();
+        Put32(p, kMagic);
+        Put16(p + 4, kVersion);
+        Put16(p + 6, EncodingCode(header.encoding));
+        Put16(p + 8, (uint16_t)header.layout);
+        Put32(p + 12, header.T);
+        Put32(p + 16, (uint32_t)header.workers.size());
+        PutDouble(p + 24, header.time_us);
+
+        p += kFixedBytes;
+        for (const WorkerEntry& w : header.workers) {
+            Put64(p, w.count);
+            Put64(p + 8, w.bytes);
+            PutDouble(p + 16, w.time_us);
+            p += kWorkerBytes;
+        }
+        return bytes;
+    }
+
+    bool WriteHeader(Platform::FileHandle file, const Header& header, std::wstring& err) {
+        std::vector<uint8_t> bytes = Serialize(header);
+        return Platform::WriteAll(file, bytes.data(), bytes.size(), err);
+    }
+
+    bool WriteHeaderAt(Platform::FileHandle file, const Header& header, uint64_t offset, std::wstring& err) {
+        std::vector<uint8_t> bytes = Serialize(header);
+        return Platform::WriteAt(file, bytes.data(), bytes.size(), offset, err);
+    }
+
+    // exactly `bytes` bytes or an error
+    static bool ReadExact(Platform::FileHandle file, uint8_t* out, size_t bytes, std::wstring& err) {
+        size_t done = 0;
+        while (done < bytes) {
+            size_t got = 0;
+            if (!Platform::ReadSome(file, out + done, bytes - done, got, err)) return false;
+            if (got == 0) { err = L"Binary result is truncated"; return false; }
+            done += got;
+        }
+        return true;
+    }
+
+    bool ReadHeader(Platform::FileHandle file, Header& header, std::wstring& err) {
+        header = Header();
+        uint8_t fixed[kFixedBytes];
+        if (!ReadExact(file, fixed, sizeof(fixed), err)) return false;
+
+        if (Get32(fixed) != kMagic) { err = L"Not a binary result file"; return false; }
+        if (Get16(fixed + 4) != kVersion) { err = L"Unsupported binary result version " + std::to_wstring(Get16(fixed + 4)); return false; }
+
+        uint16_t encoding = Get16(fixed + 6);
+        if (encoding == EncodingCode(FileIO::ResultEncoding::Packed32)) header.encoding = FileIO::ResultEncoding::Packed32;
+        else if (encoding == EncodingCode(FileIO::ResultEncoding::DeltaVarint)) header.encoding = FileIO::ResultEncoding::DeltaVarint;
+        else { err = L"Unknown value encoding " + std::to_wstring(encoding); return false; }
+
+        uint16_t layout = Get16(fixed + 8);
+        if (layout > (uint16_t)Layout::CountList) { err = L"Unknown result layout " + std::to_wstring(layout); return false; }
+        header.layout = (Layout)layout;
+        header.T = Get32(fixed + 12);
+        header.time_us = GetDouble(fixed + 24);
+
+        uint32_t nWorkers = Get32(fixed + 16);
+        std::vector<uint8_t> table((size_t)nWorkers * kWorkerBytes);
+        if (!ReadExact(file, table.data(), table.size(), err)) return false;
+
+        header.workers.resize(nWorkers);
+        for (uint32_t i = 0; i < nWorkers; i++) {
+            const uint8_t* p = table.data() + (size_t)i * kWorkerBytes;
+            header.workers[i].count = Get64(p);
+            header.workers[i].bytes = Get64(p + 8);
+            header.workers[i].time_us = GetDouble(p + 16);
+        }
+        return true;
+    }
+
+    size_t EncodeValues(const uint32_t* values, size_t n, FileIO::ResultEncoding encoding, uint32_t& previous, uint8_t* out) {
+        uint8_t* p = out;
+        if (encoding == FileIO::ResultEncoding::Packed32) {
+            for (size_t i = 0; i < n; i++, p += 4) Put32(p, values[i]);
+            return (size_t)(p - out);
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            int64_t delta = (int64_t)values[i] - (int64_t)previous;
+            uint64_t zigzag = ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63);
+            previous = values[i];
+            while (zigzag >= 0x80) {
+                *p++ = (uint8_t)(zigzag | 0x80);
+                zigzag >>= 7;
+            }
+            *p++ = (uint8_t)zigzag;
+        }
+        return (size_t)(p - out);
+    }
+
+    // Sequential byte source over one file, refilled 1 MiB at a time
+    class ByteReader {
+    public:
+        explicit ByteReader(Platform::FileHandle f) : file(f), buffer(kBufferBytes) {}
+
+        bool Next(uint8_t& b, std::wstring& err) {
+            if (pos == len) {
+                pos = 0;
+                if (!Platform::ReadSome(file, buffer.data(), buffer.size(), len, err)) return false;
+                if (len == 0) { err = L"Binary result is truncated"; return false; }
+            }
+            b = buffer[pos++];
+            return true;
+        }
+
+    private:
+        static constexpr size_t kBufferBytes = (size_t)1 << 20;
+        Platform::FileHandle file;
+        std::vector<uint8_t> buffer;
+        size_t pos = 0;
+        size_t len = 0;
+    };
+
+    // One worker's segment into out; false on a malformed segment
+    static bool ConvertSegment(ByteReader& in, const WorkerEntry& worker, FileIO::ResultEncoding encoding,
+        ResultWriter::BufferedWriter& out, std::wstring& err) {
+        uint64_t bytesLeft = worker.bytes;
+        uint32_t previous = 0;
+        for (uint64_t k = 0; k < worker.count; k++) {
+            uint64_t raw = 0;
+            int shift = 0;
+            for (;;) {
+                uint8_t b = 0;
+                if (bytesLeft == 0) { err = L"Segment ends before its last value"; return false; }
+                if (!in.Next(b, err)) return false;
+                bytesLeft--;
+
+                if (encoding == FileIO::ResultEncoding::Packed32) {
+                    raw |= (uint64_t)b << shift;
+                    shift += 8;
+                    if (shift == 32) break;
+                    continue;
+                }
+                raw |= (uint64_t)(b & 0x7F) << shift;
+                if ((b & 0x80) == 0) break;
+                shift += 7;
+                if (shift > 35) { err = L"Varint longer than 5 bytes"; return false; }
+            }
+
+            uint32_t x = (uint32_t)raw;
+            if (encoding == FileIO::ResultEncoding::DeltaVarint) {
+                int64_t value = (int64_t)previous + (int64_t)((raw >> 1) ^ (0 - (raw & 1)));
+                if (value < 0 || value > 0xFFFFFFFFll) { err = L"Delta leaves the uint32 range"; return false; }
+                x = (uint32_t)value;
+                previous = x;
+            }
+            if (!out.AppendValue(x)) { err = out.Stats().error; return false; }
+        }
+        if (bytesLeft != 0) { err = L"Segment has bytes after its last value"; return false; }
+        return true;
+    }
+
+    bool ConvertToText(const std::wstring& binPath, std::wstring& textPath,
+        FileIO::ResultEncoding textEncoding, uint64_t& values, std::wstring& err) {
+        values = 0;
+        err.clear();
+        if (FileIO::IsBinary(textEncoding)) { err = L"Conversion target must be a text encoding"; return false; }
+
+        Platform::FileHandle hIn = Platform::OpenFile(binPath, Platform::FileMode::Read, err);
+        if (hIn == Platform::kInvalidFile) return false;
+
+        Header header;
+        if (!ReadHeader(hIn, header, err)) { Platform::CloseFile(hIn); return false; }
+        if (header.layout == Layout::CountList && header.workers.size() != 1) {
+            err = L"Sequential layout with " + std::to_wstring(header.workers.size()) + L" segments";
+            Platform::CloseFile(hIn);
+            return false;
+        }
+
+        if (textPath.empty()) textPath = TextPathFor(binPath, header.layout);
+        Platform::FileHandle hOut = Platform::kInvalidFile;
+        if (!FileIO::CreateResultsFileWithAcl(textPath, hOut, err)) { Platform::CloseFile(hIn); return false; }
+
+        ResultWriter::BufferedWriter out;
+        bool ok = out.Open(hOut, ResultWriter::kDefaultBufferBytes, textEncoding, err);
+        ByteReader in(hIn);
+
+        for (uint32_t i = 0; ok && i < header.workers.size(); i++) {
+            const WorkerEntry& worker = header.workers[i];
+            wchar_t prefix[64];
+            int len = header.layout == Layout::CountList
+                ? swprintf_s(prefix, L"%010llu:", (unsigned long long)worker.count)
+                : swprintf_s(prefix, L"%u_%llu:", i, (unsigned long long)worker.count);
+
+            ok = out.AppendText(prefix, (size_t)len);
+            out.StartList();
+            ok = ok && ConvertSegment(in, worker, header.encoding, out, err);
+            if (ok && header.layout == Layout::WorkerLines) ok = out.AppendText(L"\r\n", 2);
+            if (ok) values += worker.count;
+        }
+
+        bool closed = out.Close();
+        if (ok && !closed) { ok = false; err = out.Stats().error; }
+        Platform::CloseFile(hOut);
+        Platform::CloseFile(hIn);
+        if (!ok && err.empty()) err = out.Stats().error;
+        return ok;
+    }
+
+    std::wstring TextPathFor(const std::wstring& binPath, Layout layout) {
+        std::wstring base = binPath;
+        const std::wstring ext = L".bin";
+        if (base.size() > ext.size() && base.compare(base.size() - ext.size(), ext.size(), ext) == 0) {
+            base.erase(base.size() - ext.size());
+        }
+        return layout == Layout::CountList ? base : base + L".txt";
+    }
+}
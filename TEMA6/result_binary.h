@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "platform.h"
+#include "fileio.h"
+
+// Binary result files (FileIO::ResultEncoding::Packed32 / DeltaVarint), little-endian:
+//   fixed header (32 bytes)  magic "CZRB", version, encoding, layout, T, worker count, run time
+//   worker table (24 bytes each)  count, segment bytes, worker time
+//   segments  each worker's values back to back, in worker order
+// DeltaVarint stores zigzag(x - previous) as LEB128, previous starting at 0 per segment:
+// 1-2 bytes per value when a worker's hits are ascending, at most 5 otherwise.
+namespace ResultBinary {
+    constexpr uint32_t kMagic = 0x42525A43;         // "CZRB"
+    constexpr uint16_t kVersion = 1;
+    constexpr size_t kFixedBytes = 32;
+    constexpr size_t kWorkerBytes = 24;
+    constexpr size_t kMaxBytesPerValue = 5;
+
+    // Which text layout the file converts back to
+    enum class Layout : uint16_t {
+        WorkerLines = 0,    // "<id>_<count>:a,b,c\r\n" per worker (static, dynamic, backends)
+        CountList = 1       // "<count>:a,b,c", count zero-padded to 10 digits (sequential)
+    };
+
+    struct WorkerEntry {
+        uint64_t count = 0;
+        uint64_t bytes = 0;         // segment length
+        double time_us = 0.0;       // 0 when the runner does not time workers
+    };
+
+    struct Header {
+        FileIO::ResultEncoding encoding = FileIO::ResultEncoding::Packed32;
+        Layout layout = Layout::WorkerLines;
+        uint32_t T = 0;
+        double time_us = 0.0;       // the time in the file name
+        std::vector<WorkerEntry> workers;
+
+        size_t Bytes() const { return kFixedBytes + workers.size() * kWorkerBytes; }
+        uint64_t TotalCount() const;
+    };
+
+    bool WriteHeader(Platform::FileHandle file, const Header& header, std::wstring& err);
+    // Rewrites a header of the same worker count in place (sequential count patch)
+    bool WriteHeaderAt(Platform::FileHandle file, const Header& header, uint64_t offset, std::wstring& err);
+    // Reads and checks the header at the current position
+    bool ReadHeader(Platform::FileHandle file, Header& header, std::wstring& err);
+
+    // Appends n values to out (room for n * kMaxBytesPerValue); returns the bytes written.
+    // previous carries the delta base between calls for DeltaVarint.
+    size_t EncodeValues(const uint32_t* values, size_t n, FileIO::ResultEncoding encoding, uint32_t& previous, uint8_t* out);
+
+    // Streams a binary result file into the text layout it was written for, in
+    // textEncoding (Utf16 or Utf8). An empty textPath becomes TextPathFor(binPath).
+    // values gets the number of values converted.
+    bool ConvertToText(const std::wstring& binPath, std::wstring& textPath,
+        FileIO::ResultEncoding textEncoding, uint64_t& values, std::wstring& err);
+
+    // "x.bin" -> "x.txt"; a sequential "<T>_<time>_secvential.bin" loses the extension
+    std::wstring TextPathFor(const std::wstring& binPath, Layout layout);
+}
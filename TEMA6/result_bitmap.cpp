@@ -0,0 +1,246 @@
+#include "result_bitmap.h"
+#include <bit>
+#include <cstring>
+#include <cwchar>
+#include <new>
+#include <vector>
+
+namespace ResultBitmap {
+
+    static void Put16(uint8_t* p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+    static void Put32(uint8_t* p, uint32_t v) { for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i)); }
+    static void Put64(uint8_t* p, uint64_t v) { for (int i = 0; i < 8; i++) p[i] = (uint8_t)(v >> (8 * i)); }
+
+    static uint16_t Get16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+    static uint32_t Get32(const uint8_t* p) { uint32_t v = 0; for (int i = 3; i >= 0; i--) v = (v << 8) | p[i]; return v; }
+    static uint64_t Get64(const uint8_t* p) { uint64_t v = 0; for (int i = 7; i >= 0; i--) v = (v << 8) | p[i]; return v; }
+
+    uint64_t ToFileOrder(uint64_t w) {
+        if constexpr (std::endian::native == std::endian::little) return w;
+        uint64_t r = 0;
+        for (int i = 0; i < 8; i++) r = (r << 8) | ((w >> (8 * i)) & 0xFF);
+        return r;
+    }
+
+    bool WriteHeader(Platform::FileHandle file, const Header& header, std::wstring& err) {
+        uint8_t bytes[kHeaderBytes] = {};
+        Put32(bytes, kMagic);
+        Put16(bytes + 4, kVersion);
+        Put32(bytes + 8, header.T);
+        Put64(bytes + 16, header.n);
+        Put64(bytes + 24, header.count);
+        uint64_t time;
+        memcpy(&time, &header.time_us, sizeof(time));
+        Put64(bytes + 32, time);
+        return Platform::WriteAt(file, bytes, sizeof(bytes), 0, err);
+    }
+
+    // exactly `bytes` bytes or an error
+    static bool ReadExact(Platform::FileHandle file, void* out, size_t bytes, std::wstring& err) {
+        size_t done = 0;
+        while (done < bytes) {
+            size_t got = 0;
+            if (!Platform::ReadSome(file, static_cast<uint8_t*>(out) + done, bytes - done, got, err)) return false;
+            if (got == 0) { err = L"Bitmap result is truncated"; return false; }
+            done += got;
+        }
+        return true;
+    }
+
+    bool ReadHeader(Platform::FileHandle file, Header& header, std::wstring& err) {
+        header = Header();
+        uint8_t bytes[kHeaderBytes];
+        if (!ReadExact(file, bytes, sizeof(bytes), err)) return false;
+
+        if (Get32(bytes) != kMagic) { err = L"Not a bitmap result file"; return false; }
+        if (Get16(bytes + 4) != kVersion) { err = L"Unsupported bitmap result version " + std::to_wstring(Get16(bytes + 4)); return false; }
+
+        header.T = Get32(bytes + 8);
+        header.n = Get64(bytes + 16);
+        header.count = Get64(bytes + 24);
+        uint64_t time = Get64(bytes + 32);
+        memcpy(&header.time_us, &time, sizeof(time));
+        return true;
+    }
+
+    RangeWriter::~RangeWriter() {
+        Close();
+    }
+
+    bool RangeWriter::Open(Platform::FileHandle f, size_t bufferBytes, std::wstring& err) {
+        Close();
+        stats = ResultWriter::WriteStats();
+        if (bufferBytes > ResultWriter::kMaxBufferBytes) bufferBytes = ResultWriter::kMaxBufferBytes;
+        capacity = bufferBytes / sizeof(uint64_t);
+        if (capacity == 0) capacity = 1;
+
+        words = static_cast<uint64_t*>(::operator new(capacity * sizeof(uint64_t), std::nothrow));
+        if (!words) {
+            capacity = 0;
+            err = L"Out of memory for a " + std::to_wstring(bufferBytes) + L" byte bitmap buffer";
+            return false;
+        }
+        file = f;
+        return true;
+    }
+
+    bool RangeWriter::Begin(size_t firstIndex) {
+        size_t word = firstIndex / kWordBits;
+        if (bits == 0 && word == firstWord + used) return !Failed();   // same run, keep buffering
+        bool ok = End();
+        firstWord = word;
+        return ok;
+    }
+
+    bool RangeWriter::PutWords(size_t firstIndex, const uint64_t* fileWords, size_t count) {
+        if (!End()) return false;
+        firstWord = firstIndex / kWordBits;
+        if (count == 0) return true;
+
+        std::wstring err;
+        size_t bytes = count * sizeof(uint64_t);
+        stats.writeCalls++;
+        if (!Platform::WriteAt(file, fileWords, bytes, kHeaderBytes + (uint64_t)firstWord * sizeof(uint64_t), err)) {
+            stats.error = err;
+            return false;
+        }
+        stats.bytes += bytes;
+        firstWord += count;
+        return true;
+    }
+
+    void RangeWriter::PushWord() {
+        words[used++] = ToFileOrder(current);
+        current = 0;
+        bits = 0;
+        if (used == capacity) FlushWords();
+    }
+
+    bool RangeWriter::FlushWords() {
+        if (Failed() || !words) { used = 0; return false; }
+        if (used == 0) return true;
+
+        std::wstring err;
+        size_t bytes = used * sizeof(uint64_t);
+        stats.writeCalls++;
+        if (!Platform::WriteAt(file, words, bytes, kHeaderBytes + (uint64_t)firstWord * sizeof(uint64_t), err)) {
+            stats.error = err;
+            used = 0;
+            return false;
+        }
+        stats.bytes += bytes;
+        firstWord += used;
+        used = 0;
+        return true;
+    }
+
+    bool RangeWriter::End() {
+        if (!words) return !Failed();
+        if (bits > 0) PushWord();   // the last word of the input may be partial
+        return FlushWords();
+    }
+
+    bool RangeWriter::Close() {
+        if (words) {
+            End();
+            ::operator delete(words);
+        }
+        words = nullptr;
+        capacity = 0;
+        used = 0;
+        current = 0;
+        bits = 0;
+        file = Platform::kInvalidFile;
+        return !Failed();
+    }
+
+    bool ExpandToText(const std::wstring& bitmapPath, const std::wstring& inputPath, std::wstring& textPath,
+        FileIO::ResultEncoding textEncoding, uint64_t& values, std::wstring& err) {
+        values = 0;
+        err.clear();
+        if (FileIO::IsBinary(textEncoding) || textEncoding == FileIO::ResultEncoding::Bitmap) {
+            err = L"Conversion target must be a text encoding";
+            return false;
+        }
+
+        Platform::FileHandle hIn = Platform::OpenFile(bitmapPath, Platform::FileMode::Read, err);
+        if (hIn == Platform::kInvalidFile) return false;
+
+        Header header;
+        uint64_t fileBytes = 0;
+        if (!ReadHeader(hIn, header, err) || !Platform::GetFileSize(hIn, fileBytes, err)) {
+            Platform::CloseFile(hIn);
+            return false;
+        }
+        if (fileBytes != kHeaderBytes + (uint64_t)WordCount((size_t)header.n) * sizeof(uint64_t)) {
+            err = L"Bitmap size does not match its " + std::to_wstring(header.n) + L" elements";
+            Platform::CloseFile(hIn);
+            return false;
+        }
+
+        FileIO::MappedFile input;
+        if (!FileIO::MapBinaryUInt32File(inputPath, input, err)) { Platform::CloseFile(hIn); return false; }
+        if (input.count != header.n) {
+            err = L"Input has " + std::to_wstring(input.count) + L" values, the bitmap " + std::to_wstring(header.n);
+            FileIO::UnmapFile(input);
+            Platform::CloseFile(hIn);
+            return false;
+        }
+
+        if (textPath.empty()) textPath = TextPathFor(bitmapPath);
+        Platform::FileHandle hOut = Platform::kInvalidFile;
+        if (!FileIO::CreateResultsFileWithAcl(textPath, hOut, err)) {
+            FileIO::UnmapFile(input);
+            Platform::CloseFile(hIn);
+            return false;
+        }
+
+        // same layout as the sequential text result
+        ResultWriter::BufferedWriter out;
+        bool ok = out.Open(hOut, ResultWriter::kDefaultBufferBytes, textEncoding, err);
+        wchar_t prefix[32];
+        int len = swprintf_s(prefix, L"%010llu:", (unsigned long long)header.count);
+        ok = ok && out.AppendText(prefix, (size_t)len);
+        out.StartList();
+
+        constexpr size_t kChunkWords = ((size_t)1 << 20) / sizeof(uint64_t);
+        std::vector<uint64_t> chunk(kChunkWords);
+        const size_t nWords = WordCount((size_t)header.n);
+        for (size_t w = 0; ok && w < nWords; w += chunk.size()) {
+            size_t count = nWords - w < chunk.size() ? nWords - w : chunk.size();
+            ok = ReadExact(hIn, chunk.data(), count * sizeof(uint64_t), err);
+            for (size_t k = 0; ok && k < count; k++) {
+                uint64_t word = ToFileOrder(chunk[k]);
+                size_t base = (w + k) * kWordBits;
+                while (ok && word) {
+                    size_t index = base + (size_t)std::countr_zero(word);
+                    if (index >= header.n) { ok = false; err = L"Bitmap has bits past its last element"; break; }
+                    ok = out.AppendValue(input.data[index]);
+                    values++;
+                    word &= word - 1;
+                }
+            }
+        }
+        if (ok && values != header.count) {
+            ok = false;
+            err = L"Bitmap has " + std::to_wstring(values) + L" set bits, its header " + std::to_wstring(header.count);
+        }
+
+        bool closed = out.Close();
+        if (ok && !closed) { ok = false; err = out.Stats().error; }
+        Platform::CloseFile(hOut);
+        FileIO::UnmapFile(input);
+        Platform::CloseFile(hIn);
+        if (!ok && err.empty()) err = out.Stats().error;
+        return ok;
+    }
+
+    std::wstring TextPathFor(const std::wstring& bitmapPath) {
+        std::wstring base = bitmapPath;
+        const std::wstring ext = L".bits";
+        if (base.size() > ext.size() && base.compare(base.size() - ext.size(), ext.size(), ext) == 0) {
+            base.erase(base.size() - ext.size());
+        }
+        return base + L".txt";
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include "platform.h"
+#include "fileio.h"
+#include "result_writer.h"
+
+// Bitmap result files (FileIO::ResultEncoding::Bitmap): one bit per input element,
+// bit i set when v[i] qualifies, so the file is n/8 bytes however many values match.
+//   header (40 bytes)  magic "CZBM", version, T, n, matching count, run time
+//   words              ceil(n / 64) little-endian uint64; bit i % 64 of word i / 64
+// Writers own disjoint ranges that start on a word boundary and put their words in
+// place with positional writes: no merge and no coordination between workers.
+namespace ResultBitmap {
+    constexpr uint32_t kMagic = 0x4D425A43;         // "CZBM"
+    constexpr uint16_t kVersion = 1;
+    constexpr size_t kHeaderBytes = 40;
+    constexpr size_t kWordBits = 64;
+
+    struct Header {
+        uint32_t T = 0;
+        uint64_t n = 0;             // input elements (bits)
+        uint64_t count = 0;         // set bits
+        double time_us = 0.0;       // the time in the file name
+    };
+
+    inline size_t AlignDown(size_t index) { return index - index % kWordBits; }
+    inline size_t WordCount(size_t n) { return (n + kWordBits - 1) / kWordBits; }
+    uint64_t ToFileOrder(uint64_t word);    // little-endian; a no-op on x86/x64 and ARM
+
+    bool WriteHeader(Platform::FileHandle file, const Header& header, std::wstring& err);   // at offset 0
+    bool ReadHeader(Platform::FileHandle file, Header& header, std::wstring& err);
+
+    // Bits of one worker, appended in input order. Each Begin starts a run at a word
+    // boundary (a run that continues the buffered one just keeps going); full words
+    // collect in the buffer and go out with one positional write per buffer or run.
+    // Like BufferedWriter, the first failed write latches.
+    class RangeWriter {
+    public:
+        RangeWriter() = default;
+        ~RangeWriter();
+        RangeWriter(const RangeWriter&) = delete;
+        RangeWriter& operator=(const RangeWriter&) = delete;
+
+        // Allocates the word buffer; bufferBytes 0 writes every word on its own
+        bool Open(Platform::FileHandle file, size_t bufferBytes, std::wstring& err);
+
+        bool Begin(size_t firstIndex);      // firstIndex % kWordBits == 0
+        void Add(bool bit) {
+            current |= (uint64_t)bit << bits;
+            if (++bits == kWordBits) PushWord();
+        }
+        bool End();                         // writes the partial last word and the buffer
+        // count ready-made words (ToFileOrder) for the range at firstIndex, in one write
+        bool PutWords(size_t firstIndex, const uint64_t* fileWords, size_t count);
+        bool Close();
+
+        bool Failed() const { return !stats.error.empty(); }
+        const ResultWriter::WriteStats& Stats() const { return stats; }
+
+    private:
+        void PushWord();
+        bool FlushWords();
+
+        Platform::FileHandle file = Platform::kInvalidFile;
+        uint64_t* words = nullptr;
+        size_t capacity = 0;                // words
+        size_t used = 0;
+        size_t firstWord = 0;               // file word index of words[0]
+        uint64_t current = 0;
+        size_t bits = 0;
+        ResultWriter::WriteStats stats;
+    };
+
+    // Expands a bitmap back to the values it marks, as "<count>:a,b,c" (the sequential
+    // text layout) in textEncoding. inputPath must be the input the bitmap was made from
+    // (same element count). An empty textPath becomes TextPathFor(bitmapPath).
+    bool ExpandToText(const std::wstring& bitmapPath, const std::wstring& inputPath, std::wstring& textPath,
+        FileIO::ResultEncoding textEncoding, uint64_t& values, std::wstring& err);
+
+    std::wstring TextPathFor(const std::wstring& bitmapPath);   // "x.bits" -> "x.txt"
+}
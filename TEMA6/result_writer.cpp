@@ -0,0 +1,602 @@
+#include "result_writer.h"
+#include "result_binary.h"
+#include "thread_pool.h"
+#include <cstring>
+#include <cwchar>
+#include <new>
+
+namespace ResultWriter {
+
+    // a full batch of formatted values; also the whole buffer in unbuffered mode
+    static constexpr size_t kScratchBytes = DecimalFormat::ListCapacity(DecimalFormat::kBatch) * sizeof(char16_t);
+
+    const wchar_t* SegmentModeName(SegmentMode mode) {
+        switch (mode) {
+        case SegmentMode::TempFiles: return L"temp";
+        case SegmentMode::Direct: return L"direct";
+        default: return L"unknown";
+        }
+    }
+
+    size_t BufferCapacity(size_t bufferBytes, bool uncached) {
+        if (bufferBytes > kMaxBufferBytes) bufferBytes = kMaxBufferBytes;
+        size_t capacity = bufferBytes < kScratchBytes ? kScratchBytes : bufferBytes;
+        if (uncached) {
+            // after a flush up to a block less one byte stays behind; a batch must still fit
+            if (capacity < kScratchBytes + Platform::kUncachedAlign) capacity = kScratchBytes + Platform::kUncachedAlign;
+            capacity = (capacity + Platform::kUncachedAlign - 1) / Platform::kUncachedAlign * Platform::kUncachedAlign;
+        }
+        return capacity;
+    }
+
+    void WriteStats::Add(const WriteStats& other) {
+        writeCalls += other.writeCalls;
+        bytes += other.bytes;
+        if (error.empty()) error = other.error;
+        queuedBlocks += other.queuedBlocks;
+        queueDepthSum += other.queueDepthSum;
+        if (other.maxQueueDepth > maxQueueDepth) maxQueueDepth = other.maxQueueDepth;
+        stall_us += other.stall_us;
+    }
+
+    static bool PutAt(Platform::FileHandle out, const void* data, size_t bytes, uint64_t offset, WriteStats& stats) {
+        if (bytes == 0) return true;
+        std::wstring err;
+        stats.writeCalls++;
+        if (!Platform::WriteAt(out, data, bytes, offset, err)) {
+            if (stats.error.empty()) stats.error = err;
+            return false;
+        }
+        stats.bytes += bytes;
+        return true;
+    }
+
+    BufferedWriter::~BufferedWriter() {
+        Close();
+    }
+
+    void BufferedWriter::Reset(FileIO::ResultEncoding enc) {
+        Close();
+        encoding = enc;
+        stats = WriteStats();
+        first = true;
+        deltaBase = 0;
+        pendingCount = 0;
+        memoryLimit = 0;
+        spillPath.clear();
+        spilled = 0;
+        flushEach = false;
+    }
+
+    bool BufferedWriter::Open(Platform::FileHandle f, size_t bufferBytes, FileIO::ResultEncoding enc, std::wstring& err) {
+        if (enc == FileIO::ResultEncoding::Bitmap) {
+            err = L"Bitmap results are written with ResultBitmap::RangeWriter";
+            return false;
+        }
+        Reset(enc);
+
+        flushEach = bufferBytes == 0;
+        capacity = BufferCapacity(bufferBytes);
+
+        // raw storage: FormatList writes char16_t units into it directly
+        buffer = static_cast<char*>(::operator new(capacity, std::nothrow));
+        if (!buffer) {
+            capacity = 0;
+            err = L"Out of memory for a " + std::to_wstring(bufferBytes) + L" byte output buffer";
+            return false;
+        }
+        file = f;
+        return true;
+    }
+
+    bool BufferedWriter::OpenQueued(Platform::FileHandle f, AsyncWriter::Service& svc, FileIO::ResultEncoding enc,
+        bool uncachedBlocks, std::wstring& err) {
+        if (enc == FileIO::ResultEncoding::Bitmap) {
+            err = L"Bitmap results are written with ResultBitmap::RangeWriter";
+            return false;
+        }
+        if (!svc.Running() || svc.BufferBytes() < BufferCapacity(0, uncachedBlocks)) {
+            err = L"Async writer is not running or its buffers are too small";
+            return false;
+        }
+        Reset(enc);
+
+        // the writer threads only ever see whole blocks, so they get the uncached handle
+        if (uncachedBlocks) {
+            std::wstring reopenErr;
+            uncached = Platform::ReopenUncached(f, reopenErr);
+            if (uncached == Platform::kInvalidFile) Platform::DebugLog(L"Uncached output not available, writing through the cache: " + reopenErr);
+        }
+        target.Reset(uncached != Platform::kInvalidFile ? uncached : f);
+        if (!svc.Attach(target, err)) {
+            Close();
+            return false;
+        }
+
+        // the pool holds a buffer for every producer, so this does not wait
+        double stall_us = 0.0;
+        buffer = svc.Acquire(stall_us);
+        capacity = svc.BufferBytes();
+        service = &svc;
+        blockOffset = 0;
+        file = f;
+        return true;
+    }
+
+    bool BufferedWriter::OpenUncached(Platform::FileHandle f, uint64_t startOffset, size_t bufferBytes,
+        FileIO::ResultEncoding enc, std::wstring& err) {
+        if (bufferBytes == 0) return Open(f, bufferBytes, enc, err);   // one write per value: nothing to align
+        if (enc == FileIO::ResultEncoding::Bitmap) {
+            err = L"Bitmap results are written with ResultBitmap::RangeWriter";
+            return false;
+        }
+        Reset(enc);
+
+        std::wstring reopenErr;
+        uncached = Platform::ReopenUncached(f, reopenErr);
+        if (uncached == Platform::kInvalidFile) {
+            Platform::DebugLog(L"Uncached output not available, writing through the cache: " + reopenErr);
+            return Open(f, bufferBytes, enc, err);
+        }
+
+        capacity = BufferCapacity(bufferBytes, true);
+        buffer = static_cast<char*>(::operator new(capacity, std::align_val_t(Platform::kUncachedAlign), std::nothrow));
+        if (!buffer) {
+            capacity = 0;
+            Platform::CloseFile(uncached);
+            uncached = Platform::kInvalidFile;
+            err = L"Out of memory for a " + std::to_wstring(bufferBytes) + L" byte output buffer";
+            return false;
+        }
+        file = f;
+        blockOffset = startOffset;
+        return true;
+    }
+
+    bool BufferedWriter::OpenInMemory(size_t limit, const std::wstring& spill, FileIO::ResultEncoding enc, std::wstring& err) {
+        if (limit < kScratchBytes) limit = kScratchBytes;
+        if (!Open(Platform::kInvalidFile, limit < kDefaultBufferBytes ? limit : kDefaultBufferBytes, enc, err)) return false;
+        memoryLimit = limit;
+        spillPath = spill;
+        return true;
+    }
+
+    bool BufferedWriter::Reserve(size_t bytes) {
+        if (Failed() || !buffer) return false;
+        if (capacity - used >= bytes) return true;
+        if (memoryLimit && Grow(bytes)) return true;
+        return Flush() && capacity - used >= bytes;   // uncached: a partial block stays
+    }
+
+    // in-memory writer: double the buffer, up to memoryLimit
+    bool BufferedWriter::Grow(size_t bytes) {
+        if (used + bytes > memoryLimit) return false;
+        size_t grown = capacity * 2 > used + bytes ? capacity * 2 : used + bytes;
+        if (grown > memoryLimit) grown = memoryLimit;
+
+        char* bigger = static_cast<char*>(::operator new(grown, std::nothrow));
+        if (!bigger) return false;   // spill instead
+        memcpy(bigger, buffer, used);
+        ::operator delete(buffer);
+        buffer = bigger;
+        capacity = grown;
+        return true;
+    }
+
+    bool BufferedWriter::FormatPending() {
+        if (pendingCount == 0) return !Failed();
+        size_t n = pendingCount;
+        pendingCount = 0;
+
+        if (FileIO::IsBinary(encoding)) {
+            if (!Reserve(n * ResultBinary::kMaxBytesPerValue)) return false;
+            used += ResultBinary::EncodeValues(pending, n, encoding, deltaBase, reinterpret_cast<uint8_t*>(buffer + used));
+            return true;
+        }
+
+        if (!Reserve(DecimalFormat::ListCapacity(n) * FileIO::UnitBytes(encoding))) return false;
+        if (encoding == FileIO::ResultEncoding::Utf8) {
+            used += DecimalFormat::FormatList(pending, n, !first, buffer + used);
+        }
+        else {
+            char16_t* out = reinterpret_cast<char16_t*>(buffer + used);
+            used += DecimalFormat::FormatList(pending, n, !first, out) * sizeof(char16_t);
+        }
+        first = false;
+        return true;
+    }
+
+    bool BufferedWriter::AppendValue(uint32_t x) {
+        if (Failed()) return false;
+        pending[pendingCount++] = x;
+        if (flushEach) return FormatPending() && Flush();
+        return pendingCount < DecimalFormat::kBatch || FormatPending();
+    }
+
+    void BufferedWriter::StartList() {
+        FormatPending();
+        first = true;
+        deltaBase = 0;
+    }
+
+    bool BufferedWriter::AppendText(const wchar_t* s, size_t count) {
+        if (!FormatPending()) return false;
+        if (FileIO::IsBinary(encoding)) {
+            stats.error = L"Text appended to a binary result segment";
+            return false;
+        }
+
+        if (encoding == FileIO::ResultEncoding::Utf8) {
+            std::string utf8 = Platform::ToUtf8(std::wstring(s, count));
+            for (size_t done = 0; done < utf8.size();) {
+                if (!Reserve(1)) return false;
+                size_t n = utf8.size() - done < capacity - used ? utf8.size() - done : capacity - used;
+                memcpy(buffer + used, utf8.data() + done, n);
+                used += n;
+                done += n;
+            }
+            return flushEach ? Flush() : true;
+        }
+        for (size_t i = 0; i < count; i++) {
+            char16_t units[2];
+            size_t n = 1;
+            uint32_t c = (uint32_t)s[i];
+            if (c >= 0x10000) {   // UTF-32 wchar_t (non-Windows): surrogate pair, as FileIO::WriteW
+                c -= 0x10000;
+                units[0] = (char16_t)(0xD800 + (c >> 10));
+                units[1] = (char16_t)(0xDC00 + (c & 0x3FF));
+                n = 2;
+            }
+            else {
+                units[0] = (char16_t)c;
+            }
+
+            if (!Reserve(n * sizeof(char16_t))) return false;
+            memcpy(buffer + used, units, n * sizeof(char16_t));
+            used += n * sizeof(char16_t);
+        }
+        return flushEach ? Flush() : true;
+    }
+
+    // OpenQueued: the buffer goes to the writer threads; refill takes the next one from the
+    // pool, which is where a disk that cannot keep up makes the worker wait. Uncached, only
+    // whole blocks go, and the partial one left over starts the next buffer.
+    bool BufferedWriter::Submit(bool refill) {
+        if (target.failed.load()) {
+            stats.error = target.Error();
+            used = 0;
+            return false;
+        }
+        size_t bytes = uncached != Platform::kInvalidFile ? used / Platform::kUncachedAlign * Platform::kUncachedAlign : used;
+        if (bytes == 0) return true;
+
+        // the rest has to be copied out before the buffer belongs to the service
+        char* next = nullptr;
+        size_t carry = used - bytes;
+        if (refill && carry > 0) {
+            next = service->Acquire(stats.stall_us);
+            memcpy(next, buffer + bytes, carry);
+        }
+        uint32_t depth = service->Submit(target, buffer, bytes, blockOffset);
+        blockOffset += bytes;
+        stats.queuedBlocks++;
+        stats.queueDepthSum += depth;
+        if (depth > stats.maxQueueDepth) stats.maxQueueDepth = depth;
+        buffer = refill ? (next ? next : service->Acquire(stats.stall_us)) : nullptr;
+        used = refill ? carry : 0;
+        return true;
+    }
+
+    // OpenUncached: whole blocks through the uncached handle from the front of the buffer,
+    // the partial one moved back to it; tail also writes that one, through file. A stream
+    // that starts mid-block first writes up to the boundary through file.
+    bool BufferedWriter::WriteBlocks(bool tail) {
+        const size_t align = Platform::kUncachedAlign;
+        bool ok = true;
+        size_t head = blockOffset % align ? align - (size_t)(blockOffset % align) : 0;
+        if (head > 0 && (head <= used || tail)) {
+            if (head > used) head = used;
+            ok = PutAt(file, buffer, head, blockOffset, stats);
+            memmove(buffer, buffer + head, used - head);
+            used -= head;
+            blockOffset += head;
+        }
+        size_t whole = blockOffset % align ? 0 : used / align * align;
+        if (ok && whole > 0) {
+            ok = PutAt(uncached, buffer, whole, blockOffset, stats);
+            memmove(buffer, buffer + whole, used - whole);
+            used -= whole;
+            blockOffset += whole;
+        }
+        if (ok && tail && used > 0) {
+            ok = PutAt(file, buffer, used, blockOffset, stats);
+            blockOffset += used;
+            used = 0;
+        }
+        if (!ok) used = 0;
+        return ok;
+    }
+
+    bool BufferedWriter::Flush() {
+        if (!FormatPending()) return false;
+        if (used == 0) return true;
+        if (service) return Submit(true);
+        if (uncached != Platform::kInvalidFile) return WriteBlocks(false);
+
+        std::wstring err;
+        if (memoryLimit && file == Platform::kInvalidFile) {
+            file = Platform::OpenFile(spillPath, Platform::FileMode::ReadWrite, err);
+            if (file == Platform::kInvalidFile) {
+                stats.error = err;
+                used = 0;
+                return false;
+            }
+        }
+
+        stats.writeCalls++;
+        if (!Platform::WriteAll(file, buffer, used, err)) {
+            stats.error = err;
+            used = 0;
+            return false;
+        }
+        stats.bytes += used;
+        if (memoryLimit) spilled += used;
+        used = 0;
+        return true;
+    }
+
+    uint64_t BufferedWriter::SegmentBytes() {
+        FormatPending();
+        return spilled + used;
+    }
+
+    bool BufferedWriter::WritePlaced(Platform::FileHandle out, const SegmentPlace& place) {
+        bool ok = FormatPending() && memoryLimit != 0;
+        if (ok) ok = PutAt(out, place.prefix.data(), place.prefix.size(), place.offset - place.prefix.size(), stats);
+
+        // the spilled front of the segment goes back through the file, block by block
+        std::wstring err;
+        std::vector<char> block(spilled ? kDefaultBufferBytes : 0);
+        for (uint64_t done = 0; ok && done < spilled;) {
+            size_t got = 0;
+            size_t want = spilled - done < block.size() ? (size_t)(spilled - done) : block.size();
+            if (!Platform::ReadAt(file, block.data(), want, done, got, err) || got == 0) {
+                stats.error = got == 0 && err.empty() ? L"Spill file is short: " + spillPath : err;
+                ok = false;
+                break;
+            }
+            ok = PutAt(out, block.data(), got, place.offset + done, stats);
+            done += got;
+        }
+
+        ok = ok && PutAt(out, buffer, used, place.offset + spilled, stats);
+        ok = ok && PutAt(out, place.suffix.data(), place.suffix.size(), place.offset + spilled + used, stats);
+        used = 0;   // written: Close must not spill it
+        return Close() && ok;
+    }
+
+    bool BufferedWriter::Close() {
+        if (service) {
+            // the last block goes out without taking another buffer; then wait for the writers.
+            // Uncached, its partial end is written here first, through file.
+            if (FormatPending() && used > 0) {
+                size_t whole = uncached != Platform::kInvalidFile ? used / Platform::kUncachedAlign * Platform::kUncachedAlign : used;
+                PutAt(file, buffer + whole, used - whole, blockOffset + whole, stats);
+                used = whole;
+                if (used > 0) Submit(false);
+            }
+            service->Release(buffer);
+            buffer = nullptr;
+            service->WaitIdle(target);
+            service->Detach(target);
+            stats.writeCalls += target.writeCalls;
+            stats.bytes += target.bytes;
+            if (target.failed.load() && stats.error.empty()) stats.error = target.Error();
+            service = nullptr;
+        }
+        if (buffer && uncached != Platform::kInvalidFile) {
+            if (Flush()) WriteBlocks(true);
+            ::operator delete(buffer, std::align_val_t(Platform::kUncachedAlign));
+        }
+        else if (buffer) {
+            if (!memoryLimit) Flush();   // an in-memory segment only leaves through WritePlaced
+            ::operator delete(buffer);
+        }
+        if (memoryLimit && file != Platform::kInvalidFile) {
+            Platform::CloseFile(file);
+            Platform::RemoveFile(spillPath);
+        }
+        Platform::CloseFile(uncached);
+        uncached = Platform::kInvalidFile;
+        buffer = nullptr;
+        capacity = 0;
+        used = 0;
+        pendingCount = 0;
+        spilled = 0;
+        file = Platform::kInvalidFile;
+        return !Failed();
+    }
+
+    static ResultBinary::Header MakeBinaryHeader(const std::vector<Segment>& segments,
+        FileIO::ResultEncoding encoding, uint32_t T, double time_us) {
+        ResultBinary::Header header;
+        header.encoding = encoding;
+        header.layout = ResultBinary::Layout::WorkerLines;
+        header.T = T;
+        header.time_us = time_us;
+        for (const Segment& s : segments) header.workers.push_back({ s.count, s.bytes, s.time_us });
+        return header;
+    }
+
+    // framing text is ASCII: one byte per character in UTF-8, two (LE) in UTF-16
+    static std::string EncodeFraming(const wchar_t* s, size_t count, FileIO::ResultEncoding encoding) {
+        std::string bytes;
+        for (size_t i = 0; i < count; i++) {
+            bytes.push_back((char)s[i]);
+            if (encoding != FileIO::ResultEncoding::Utf8) bytes.push_back((char)((uint32_t)s[i] >> 8));
+        }
+        return bytes;
+    }
+
+    // One temp file of a merge: framing and contents at its place in the result file
+    struct MergeCopy {
+        Platform::FileHandle out = Platform::kInvalidFile;
+        Platform::FileHandle outUncached = Platform::kInvalidFile;   // MergeSegments uncached
+        const Segment* segment = nullptr;
+        const SegmentPlace* place = nullptr;
+        FileIO::ResultEncoding encoding = FileIO::ResultEncoding::Utf16;
+        std::wstring err;
+    };
+
+    // bytes of in (from 0) to out at outOffset: the whole blocks of that range through
+    // outUncached, the partial ones at either end (shared with the neighbours' framing,
+    // so never written uncached) through out
+    static bool CopyUncached(Platform::FileHandle in, Platform::FileHandle out, Platform::FileHandle outUncached,
+        uint64_t outOffset, uint64_t bytes, std::wstring& err) {
+        const size_t align = Platform::kUncachedAlign;
+        char* block = static_cast<char*>(::operator new(kDefaultBufferBytes, std::align_val_t(align), std::nothrow));
+        if (!block) return Platform::CopyRange(in, 0, out, outOffset, bytes, err);
+
+        const uint64_t head = outOffset % align ? align - outOffset % align : 0;
+        bool ok = true;
+        for (uint64_t done = 0; ok && done < bytes;) {
+            uint64_t left = bytes - done;
+            size_t want = (size_t)(done < head ? (head < left ? head : left)
+                : (left < kDefaultBufferBytes ? left : kDefaultBufferBytes));
+            for (size_t have = 0; ok && have < want;) {
+                size_t got = 0;
+                ok = Platform::ReadAt(in, block + have, want - have, done + have, got, err);
+                if (ok && got == 0) {
+                    err = L"Merge: temp file ended early";
+                    ok = false;
+                }
+                have += got;
+            }
+            size_t whole = done < head ? 0 : want / align * align;
+            ok = ok && (whole == 0 || Platform::WriteAt(outUncached, block, whole, outOffset + done, err));
+            ok = ok && (whole == want || Platform::WriteAt(out, block + whole, want - whole, outOffset + done + whole, err));
+            done += want;
+        }
+        ::operator delete(block, std::align_val_t(align));
+        return ok;
+    }
+
+    static unsigned int PLATFORM_CALL CopySegment(void* param) {
+        MergeCopy* mc = static_cast<MergeCopy*>(param);
+        const Segment& segment = *mc->segment;
+        const SegmentPlace& place = *mc->place;
+        std::wstring& err = mc->err;
+
+        Platform::FileHandle hIn = Platform::OpenFile(segment.path, Platform::FileMode::Read, err);
+        if (hIn == Platform::kInvalidFile) {
+            err = L"Open temp failed: " + err;
+            Platform::RemoveFile(segment.path);
+            return 0;
+        }
+
+        uint64_t bytes = 0;
+        bool ok = Platform::GetFileSize(hIn, bytes, err);
+        if (ok && bytes != segment.bytes) {
+            // the layout came from segment.bytes, so a short temp file cannot be placed
+            err = L"Merge: " + segment.path + L" has " + std::to_wstring(bytes) + L" bytes, expected "
+                + std::to_wstring(segment.bytes);
+            ok = false;
+        }
+        if (ok && bytes % FileIO::UnitBytes(mc->encoding) != 0) {
+            err = L"Merge: " + segment.path + L" is not whole " + FileIO::EncodingName(mc->encoding) + L" units";
+            ok = false;
+        }
+        ok = ok && Platform::WriteAt(mc->out, place.prefix.data(), place.prefix.size(), place.offset - place.prefix.size(), err);
+        ok = ok && (mc->outUncached != Platform::kInvalidFile
+            ? CopyUncached(hIn, mc->out, mc->outUncached, place.offset, bytes, err)
+            : Platform::CopyRange(hIn, 0, mc->out, place.offset, bytes, err));
+        ok = ok && Platform::WriteAt(mc->out, place.suffix.data(), place.suffix.size(), place.offset + bytes, err);
+        if (!ok && err.empty()) err = L"Merge failed";
+
+        Platform::CloseFile(hIn);
+        Platform::RemoveFile(segment.path);
+        return 0;
+    }
+
+    bool MergeSegments(Platform::FileHandle out, const std::vector<Segment>& segments,
+        FileIO::ResultEncoding encoding, uint32_t T, double time_us, bool uncached, std::wstring& err) {
+        bool ok = true;
+        std::wstring stepErr;
+
+        if (FileIO::IsBinary(encoding)) {
+            ok = ResultBinary::WriteHeader(out, MakeBinaryHeader(segments, encoding, T, time_us), stepErr);
+            if (!ok) err = stepErr;
+        }
+
+        // every segment has its offset before any copy starts, so they all go at once on
+        // the pool; sizing the file first keeps the copies from racing to extend it
+        std::vector<SegmentPlace> places = PlaceSegments(segments, encoding);
+        std::vector<MergeCopy> copies(segments.size());
+        std::vector<ThreadPool::Task> tasks(segments.size());
+        for (size_t i = 0; i < segments.size(); i++) {
+            copies[i].out = out;
+            copies[i].segment = &segments[i];
+            copies[i].place = &places[i];
+            copies[i].encoding = encoding;
+            tasks[i] = { CopySegment, &copies[i] };
+        }
+        const uint64_t total = PlacedBytes(segments, places);
+        Platform::FileHandle outUncached = Platform::kInvalidFile;
+        if (ok && uncached) {
+            // the final size is known: one allocation instead of extents as the copies land
+            if (!Platform::Preallocate(out, total, stepErr)) Platform::DebugLog(L"Merge: preallocation failed: " + stepErr);
+            outUncached = Platform::ReopenUncached(out, stepErr);
+            if (outUncached == Platform::kInvalidFile) Platform::DebugLog(L"Merge: uncached output not available: " + stepErr);
+            for (MergeCopy& mc : copies) mc.outUncached = outUncached;
+        }
+        if (ok && !Platform::SetFileSize(out, total, stepErr)) {
+            Platform::DebugLog(L"Merge: presizing the result failed: " + stepErr);
+        }
+
+        if (tasks.size() < 2 || !ThreadPool::RunJob(tasks)) {
+            for (ThreadPool::Task& task : tasks) task.proc(task.param);
+        }
+        Platform::CloseFile(outUncached);
+        for (const MergeCopy& mc : copies) {
+            if (mc.err.empty()) continue;
+            ok = false;
+            if (err.empty()) err = mc.err;
+        }
+        return ok;
+    }
+
+    std::vector<SegmentPlace> PlaceSegments(const std::vector<Segment>& segments, FileIO::ResultEncoding encoding) {
+        std::vector<SegmentPlace> places(segments.size());
+        const bool binary = FileIO::IsBinary(encoding);
+
+        uint64_t at = 0;
+        if (binary) {
+            ResultBinary::Header header;
+            header.workers.resize(segments.size());
+            at = header.Bytes();
+        }
+        for (uint32_t i = 0; i < segments.size(); i++) {
+            if (!binary) {
+                wchar_t header[64];
+                int hlen = swprintf_s(header, L"%u_%llu:", i, (unsigned long long)segments[i].count);
+                places[i].prefix = EncodeFraming(header, (size_t)hlen, encoding);
+                places[i].suffix = EncodeFraming(L"\r\n", 2, encoding);
+            }
+            at += places[i].prefix.size();
+            places[i].offset = at;
+            at += segments[i].bytes + places[i].suffix.size();
+        }
+        return places;
+    }
+
+    uint64_t PlacedBytes(const std::vector<Segment>& segments, const std::vector<SegmentPlace>& places) {
+        if (segments.empty() || places.size() != segments.size()) return 0;
+        return places.back().offset + segments.back().bytes + places.back().suffix.size();
+    }
+
+    bool WritePlacedHeader(Platform::FileHandle out, const std::vector<Segment>& segments,
+        FileIO::ResultEncoding encoding, uint32_t T, double time_us, std::wstring& err) {
+        if (!FileIO::IsBinary(encoding)) return true;
+        return ResultBinary::WriteHeaderAt(out, MakeBinaryHeader(segments, encoding, T, time_us), 0, err);
+    }
+}
@@ -0,0 +1,163 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "platform.h"
+#include "fileio.h"
+#include "decimal_format.h"
+#include "async_writer.h"
+
+namespace ResultWriter {
+    constexpr size_t kDefaultBufferBytes = (size_t)1 << 20;   // per worker
+    constexpr size_t kMaxBufferBytes = (size_t)64 << 20;
+    constexpr size_t kMaxInMemoryBytes = (size_t)256 << 20;    // per worker, SegmentMode::Direct
+
+    // How the parallel runners get worker segments into the result file
+    enum class SegmentMode {
+        TempFiles,      // each worker writes a temp file, MergeSegments copies them in (the original)
+        Direct          // workers keep their segment in memory; once the layout is known each
+                        // writes it at its final offset (PlaceSegments): no temp files, no merge
+    };
+    const wchar_t* SegmentModeName(SegmentMode mode);   // "temp", "direct"
+
+    // Bytes of buffer BufferedWriter::Open allocates for bufferBytes (also the block size an
+    // AsyncWriter::Service needs for OpenQueued); uncached writers round it to whole
+    // Platform::kUncachedAlign blocks with room for a batch behind a partial one
+    size_t BufferCapacity(size_t bufferBytes, bool uncached = false);
+
+    // What a writer (or all writers of a run) handed to the OS
+    struct WriteStats {
+        uint64_t writeCalls = 0;    // write syscalls issued
+        uint64_t bytes = 0;
+        std::wstring error;         // first failed write, empty if none
+
+        // OpenQueued writers: blocks handed to the writer threads, the queue depth each of
+        // them found (summed, and the deepest) and the time spent waiting for a free buffer
+        uint64_t queuedBlocks = 0;
+        uint64_t queueDepthSum = 0;
+        uint32_t maxQueueDepth = 0;
+        double stall_us = 0.0;
+
+        void Add(const WriteStats& other);
+        void Fail(const std::wstring& message) { if (error.empty()) error = message; }   // keeps the first
+        double BytesPerWrite() const { return writeCalls ? (double)bytes / (double)writeCalls : 0.0; }
+        double MeanQueueDepth() const { return queuedBlocks ? (double)queueDepthSum / (double)queuedBlocks : 0.0; }
+    };
+
+    // Where one segment goes in a PlaceSegments layout
+    struct SegmentPlace {
+        uint64_t offset = 0;        // first byte of the segment
+        std::string prefix;         // text: "<i>_<count>:" in the file's encoding, just before it
+        std::string suffix;         // text: "\r\n", just after it
+    };
+
+    // Builds one result line ("a,b,c", UTF-16LE or UTF-8 per FileIO::ResultEncoding; for the
+    // binary encodings a ResultBinary value segment) in memory and writes it to the file in
+    // blocks of bufferBytes. bufferBytes 0 writes every value on its own
+    // (the old per-hit WriteFile, kept for comparison). One writer per worker, no locking.
+    // Values are queued in groups of DecimalFormat::kBatch and formatted straight into
+    // the buffer by DecimalFormat::FormatList.
+    // The first failed write latches: later appends are dropped and return false, and
+    // Stats().error says why.
+    class BufferedWriter {
+    public:
+        BufferedWriter() = default;
+        ~BufferedWriter();
+        BufferedWriter(const BufferedWriter&) = delete;
+        BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+        // Allocates the buffer (do it before the timed section); the file stays the caller's
+        bool Open(Platform::FileHandle file, size_t bufferBytes, FileIO::ResultEncoding encoding, std::wstring& err);
+        // SegmentMode::Direct: the segment grows in memory up to memoryLimit; past that the
+        // front of it spills to spillPath (created on first use), so nothing is lost, it is
+        // only written twice. WritePlaced then puts it into the result file.
+        bool OpenInMemory(size_t memoryLimit, const std::wstring& spillPath, FileIO::ResultEncoding encoding, std::wstring& err);
+        // Full buffers go to service's writer threads (positional writes from offset 0 of an
+        // empty file) and the writer carries on with a pool buffer. Close waits until all of
+        // them are written. The service must outlive the writer's Close.
+        bool OpenQueued(Platform::FileHandle file, AsyncWriter::Service& service, FileIO::ResultEncoding encoding,
+            bool uncached, std::wstring& err);
+        // Like Open, but whole Platform::kUncachedAlign blocks bypass the page cache through
+        // a second handle (Platform::ReopenUncached) from an aligned buffer; startOffset is
+        // file's current position. What is not a whole block, the part before the first
+        // boundary and the final tail, goes through file, so Flush may keep up to a block
+        // back until Close. Without a buffer, or where the OS refuses, this is Open (logged).
+        // OpenQueued with uncached does the same with the service's (aligned) pool buffers.
+        bool OpenUncached(Platform::FileHandle file, uint64_t startOffset, size_t bufferBytes,
+            FileIO::ResultEncoding encoding, std::wstring& err);
+
+        bool AppendValue(uint32_t x);   // comma before every value but the first
+        bool AppendText(const wchar_t* s, size_t count);   // text encodings only
+        // The next value starts a new list: no comma, and a fresh delta base
+        void StartList();
+
+        bool Flush();
+        // Final flush and buffer release; false if any write of this writer failed
+        bool Close();
+
+        // In-memory writer: queued values formatted, returns the full segment size
+        uint64_t SegmentBytes();
+        // In-memory writer: the segment and its framing at place (positional writes, so every
+        // worker can do this at once), then the spill file is removed and the buffer released
+        bool WritePlaced(Platform::FileHandle out, const SegmentPlace& place);
+
+        bool Failed() const { return !stats.error.empty(); }
+        const WriteStats& Stats() const { return stats; }
+
+    private:
+        void Reset(FileIO::ResultEncoding encoding);
+        bool Reserve(size_t bytes);
+        bool Grow(size_t bytes);
+        bool FormatPending();
+        bool Submit(bool refill);
+        bool WriteBlocks(bool tail);
+
+        Platform::FileHandle file = Platform::kInvalidFile;
+        char* buffer = nullptr;
+        size_t capacity = 0;
+        size_t used = 0;
+        uint32_t pending[DecimalFormat::kBatch];
+        size_t pendingCount = 0;
+        FileIO::ResultEncoding encoding = FileIO::ResultEncoding::Utf16;
+        bool flushEach = false;
+        bool first = true;
+        uint32_t deltaBase = 0;     // DeltaVarint: previous value of this segment
+        size_t memoryLimit = 0;     // 0: file writer (Open)
+        std::wstring spillPath;
+        uint64_t spilled = 0;       // bytes of the segment in the spill file
+        AsyncWriter::Service* service = nullptr;   // OpenQueued
+        AsyncWriter::Target target;
+        Platform::FileHandle uncached = Platform::kInvalidFile;   // OpenUncached, OpenQueued
+        uint64_t blockOffset = 0;   // OpenQueued, OpenUncached: file offset of the next block
+        WriteStats stats;
+    };
+
+    // A worker's finished temp file, for MergeSegments
+    struct Segment {
+        std::wstring path;
+        uint64_t count = 0;
+        uint64_t bytes = 0;         // as written (WriteStats::bytes)
+        double time_us = 0.0;       // 0 when the runner does not time workers
+    };
+
+    // Builds the result file from worker segments in order. Text: "<i>_<count>:", the
+    // segment and "\r\n" per worker. Binary: the ResultBinary header, then the segments
+    // back to back. Every temp file is copied to its PlaceSegments offset at the same time
+    // (one ThreadPool task each, Platform::CopyRange so the bytes can stay in the kernel).
+    // uncached: the file is preallocated to its final size and each segment's whole blocks
+    // are written around the page cache instead (read back through an aligned buffer).
+    // The temp files are removed either way.
+    bool MergeSegments(Platform::FileHandle out, const std::vector<Segment>& segments,
+        FileIO::ResultEncoding encoding, uint32_t T, double time_us, bool uncached, std::wstring& err);
+
+    // The layout MergeSegments would produce, from the segment sizes alone (Segment::bytes
+    // is the whole segment, Segment::path is not used). Binary files keep room for the
+    // ResultBinary header, written by WritePlacedHeader once the run time is known.
+    std::vector<SegmentPlace> PlaceSegments(const std::vector<Segment>& segments, FileIO::ResultEncoding encoding);
+    // File size of that layout
+    uint64_t PlacedBytes(const std::vector<Segment>& segments, const std::vector<SegmentPlace>& places);
+    // Binary encodings: the header at offset 0; text: nothing to do
+    bool WritePlacedHeader(Platform::FileHandle out, const std::vector<Segment>& segments,
+        FileIO::ResultEncoding encoding, uint32_t T, double time_us, std::wstring& err);
+}
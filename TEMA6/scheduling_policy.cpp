@@ -0,0 +1,209 @@
+#include "scheduling_policy.h"
+#include <cmath>
+
+namespace Scheduling {
+
+    static size_t AtLeastOne(double chunk) {
+        return chunk < 1.0 ? 1 : (size_t)chunk;
+    }
+
+    // worker weight / mean weight
+    static std::vector<double> RelativeWeights(const std::vector<double>& weights, uint32_t nWorkers) {
+        std::vector<double> scale(nWorkers, 1.0);
+        double sum = 0.0;
+        for (uint32_t i = 0; i < nWorkers; i++) {
+            double w = i < weights.size() ? weights[i] : 1.0;
+            scale[i] = w > 0.0 ? w : 1.0;
+            sum += scale[i];
+        }
+        for (uint32_t i = 0; i < nWorkers; i++) scale[i] *= nWorkers / sum;
+        return scale;
+    }
+
+    class HalvingPolicy : public ChunkPolicy {
+        uint32_t nWorkers = 1;
+        std::vector<double> scale;
+    public:
+        const wchar_t* Name() const override { return L"halving"; }
+
+        void Reset(size_t, uint32_t workers, const std::vector<double>& weights) override {
+            nWorkers = workers;
+            scale = RelativeWeights(weights, workers);
+        }
+
+        size_t NextChunk(const ChunkRequest& req) override {
+            return AtLeastOne((double)(req.remaining / (2ull * nWorkers)) * scale[req.workerId]);
+        }
+    };
+
+    class FixedPolicy : public ChunkPolicy {
+        size_t requested;
+        size_t chunk = 1;
+    public:
+        explicit FixedPolicy(size_t fixedChunk) : requested(fixedChunk) {}
+        const wchar_t* Name() const override { return L"fixed"; }
+
+        void Reset(size_t n, uint32_t workers, const std::vector<double>&) override {
+            chunk = requested ? requested : AtLeastOne((double)n / (64.0 * workers));
+        }
+
+        size_t NextChunk(const ChunkRequest&) override { return chunk; }
+    };
+
+    class GuidedPolicy : public ChunkPolicy {
+        uint32_t nWorkers = 1;
+    public:
+        const wchar_t* Name() const override { return L"guided"; }
+
+        void Reset(size_t, uint32_t workers, const std::vector<double>&) override { nWorkers = workers; }
+
+        size_t NextChunk(const ChunkRequest& req) override {
+            return (req.remaining + nWorkers - 1) / nWorkers;
+        }
+    };
+
+    // Tzen & Ni: first = n / (2P), last = 1, N = ceil(2n / (first + last)) chunks,
+    // each one delta = (first - last) / (N - 1) smaller than the previous
+    class TrapezoidPolicy : public ChunkPolicy {
+        double next = 1.0;
+        double delta = 0.0;
+    public:
+        const wchar_t* Name() const override { return L"trapezoid"; }
+
+        void Reset(size_t n, uint32_t workers, const std::vector<double>&) override {
+            double first = (double)n / (2.0 * workers);
+            if (first < 1.0) first = 1.0;
+            const double last = 1.0;
+            double steps = std::ceil(2.0 * (double)n / (first + last));
+            next = first;
+            delta = steps > 1.0 ? (first - last) / (steps - 1.0) : 0.0;
+        }
+
+        size_t NextChunk(const ChunkRequest&) override {
+            size_t chunk = AtLeastOne(next);
+            next -= delta;
+            if (next < 1.0) next = 1.0;
+            return chunk;
+        }
+    };
+
+    // Hummel et al.: work goes out in batches; a batch is half of what remains,
+    // split into P chunks (equal, or proportional to worker weight for WF)
+    class FactoringPolicy : public ChunkPolicy {
+        bool weighted;
+        uint32_t nWorkers = 1;
+        std::vector<double> scale;
+        size_t batchRemaining = 0;   // chunks still to hand out from the current batch
+        double batchChunk = 1.0;     // chunk size of an average-weight worker in this batch
+    public:
+        explicit FactoringPolicy(bool useWeights) : weighted(useWeights) {}
+        const wchar_t* Name() const override { return weighted ? L"weighted-factoring" : L"factoring"; }
+
+        void Reset(size_t, uint32_t workers, const std::vector<double>& weights) override {
+            nWorkers = workers;
+            scale = weighted ? RelativeWeights(weights, workers) : std::vector<double>(workers, 1.0);
+            batchRemaining = 0;
+        }
+
+        size_t NextChunk(const ChunkRequest& req) override {
+            if (batchRemaining == 0) {
+                batchChunk = std::ceil((double)req.remaining / (2.0 * nWorkers));
+                batchRemaining = nWorkers;
+            }
+            batchRemaining--;
+            return AtLeastOne(batchChunk * scale[req.workerId]);
+        }
+    };
+
+    // Feedback controller: keeps dispatch overhead under overheadTarget of the
+    // compute time and no chunk longer than tailTarget_us
+    class AdaptivePolicy : public ChunkPolicy {
+        // Chunk handed out before any feedback exists: small enough to measure quickly
+        static constexpr size_t kProbeChunk = 4096;
+        static constexpr double kEwmaAlpha = 0.25;
+
+        double overheadTarget;
+        double tailTarget_us;
+        uint32_t nWorkers = 1;
+        std::vector<double> scale;
+
+        bool haveCost = false;
+        double perElement_us = 0.0;   // EWMA of chunk time / chunk elements
+        double overhead_us = 0.0;     // EWMA of dispatch wait
+    public:
+        AdaptivePolicy(double overhead, double tail)
+            : overheadTarget((overhead > 0.0 && overhead < 1.0) ? overhead : 0.01),
+            tailTarget_us(tail > 0.0 ? tail : 2000.0) {
+        }
+
+        const wchar_t* Name() const override { return L"adaptive"; }
+
+        void Reset(size_t, uint32_t workers, const std::vector<double>& weights) override {
+            nWorkers = workers;
+            scale = RelativeWeights(weights, workers);
+            haveCost = false;
+            perElement_us = 0.0;
+            overhead_us = 0.0;
+        }
+
+        // overhead / (overhead + chunk * cost) <= target  ->  chunk >= overhead * (1 - target) / (target * cost)
+        // chunk * cost <= tailTarget                      ->  chunk <= tailTarget / cost
+        size_t NextChunk(const ChunkRequest& req) override {
+            if (req.lastChunkElems > 0 && req.lastChunkTime_us > 0.0) {
+                double cost = req.lastChunkTime_us / (double)req.lastChunkElems;
+                perElement_us = haveCost ? (1.0 - kEwmaAlpha) * perElement_us + kEwmaAlpha * cost : cost;
+                haveCost = true;
+            }
+            if (req.lastWait_us > 0.0) {
+                overhead_us = (overhead_us == 0.0) ? req.lastWait_us
+                    : (1.0 - kEwmaAlpha) * overhead_us + kEwmaAlpha * req.lastWait_us;
+            }
+
+            if (!haveCost || perElement_us <= 0.0) return kProbeChunk;
+
+            double minChunk = overhead_us * (1.0 - overheadTarget) / (overheadTarget * perElement_us);
+            double maxChunk = tailTarget_us / perElement_us;
+            if (maxChunk < minChunk) maxChunk = minChunk;   // overhead target wins over tail target
+
+            double chunk = (double)(req.remaining / (2ull * nWorkers)) * scale[req.workerId];
+            if (chunk < minChunk) chunk = minChunk;
+            if (chunk > maxChunk) chunk = maxChunk;
+            return AtLeastOne(chunk);
+        }
+
+        double PerElementEstimate_us() const override { return perElement_us; }
+        double OverheadEstimate_us() const override { return overhead_us; }
+    };
+
+    const wchar_t* PolicyKindName(PolicyKind kind) {
+        switch (kind) {
+        case PolicyKind::Halving: return L"halving";
+        case PolicyKind::Fixed: return L"fixed";
+        case PolicyKind::Guided: return L"guided";
+        case PolicyKind::Trapezoid: return L"trapezoid";
+        case PolicyKind::Factoring: return L"factoring";
+        case PolicyKind::WeightedFactoring: return L"weighted-factoring";
+        case PolicyKind::Adaptive: return L"adaptive";
+        default: return L"unknown";
+        }
+    }
+
+    std::vector<PolicyKind> AllPolicyKinds() {
+        return { PolicyKind::Halving, PolicyKind::Fixed, PolicyKind::Guided, PolicyKind::Trapezoid,
+            PolicyKind::Factoring, PolicyKind::WeightedFactoring, PolicyKind::Adaptive };
+    }
+
+    std::unique_ptr<ChunkPolicy> CreatePolicy(PolicyKind kind, size_t fixedChunk,
+        double overheadTarget, double tailTarget_us) {
+        switch (kind) {
+        case PolicyKind::Fixed: return std::make_unique<FixedPolicy>(fixedChunk);
+        case PolicyKind::Guided: return std::make_unique<GuidedPolicy>();
+        case PolicyKind::Trapezoid: return std::make_unique<TrapezoidPolicy>();
+        case PolicyKind::Factoring: return std::make_unique<FactoringPolicy>(false);
+        case PolicyKind::WeightedFactoring: return std::make_unique<FactoringPolicy>(true);
+        case PolicyKind::Adaptive: return std::make_unique<AdaptivePolicy>(overheadTarget, tailTarget_us);
+        case PolicyKind::Halving:
+        default: return std::make_unique<HalvingPolicy>();
+        }
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <memory>
+
+namespace Scheduling {
+    // What the dynamic coordinator knows when a worker asks for work
+    struct ChunkRequest {
+        uint32_t workerId;
+        size_t remaining;          // Unassigned elements
+        size_t lastChunkElems;     // Feedback from the requesting worker's previous chunk
+        double lastChunkTime_us;
+        double lastWait_us;        // Request -> assignment latency of that chunk
+    };
+
+    // Self-scheduling rule used by ParallelDynamic's coordinator.
+    // NextChunk is only called from the coordinator thread.
+    class ChunkPolicy {
+    public:
+        virtual ~ChunkPolicy() {}
+        virtual const wchar_t* Name() const = 0;
+
+        // Called once per run before the first request; weights has nWorkers entries
+        // (relative worker throughput, 1.0 when unweighted)
+        virtual void Reset(size_t n, uint32_t nWorkers, const std::vector<double>& weights) = 0;
+
+        // Elements to hand out next (>= 1 while remaining > 0); clamped by the caller
+        virtual size_t NextChunk(const ChunkRequest& req) = 0;
+
+        // Controller estimates for telemetry (0 when the policy does not measure)
+        virtual double PerElementEstimate_us() const { return 0.0; }
+        virtual double OverheadEstimate_us() const { return 0.0; }
+    };
+
+    enum class PolicyKind {
+        Halving,            // remaining / (2P), scaled by worker weight (original rule)
+        Fixed,              // constant chunk (chunk self-scheduling)
+        Guided,             // remaining / P (GSS)
+        Trapezoid,          // linearly decreasing from n / (2P) to 1 (TSS)
+        Factoring,          // batches of P equal chunks of remaining / (2P) (FSS)
+        WeightedFactoring,  // factoring with chunks proportional to worker weight (WF)
+        Adaptive            // feedback-driven: overhead and tail targets
+    };
+
+    const wchar_t* PolicyKindName(PolicyKind kind);
+
+    // Every kind, in the order the orchestrator compares them
+    std::vector<PolicyKind> AllPolicyKinds();
+
+    // fixedChunk: chunk size for Fixed (0 = n / (64 * P));
+    // overheadTarget / tailTarget_us: targets for Adaptive
+    std::unique_ptr<ChunkPolicy> CreatePolicy(PolicyKind kind, size_t fixedChunk = 0,
+        double overheadTarget = 0.01, double tailTarget_us = 2000.0);
+}
@@ -1,4 +1,5 @@
 #include "security.h"
+#include "platform.h"
 #include <windows.h>
 #include <sddl.h>
 #include <aclapi.h>
@@ -7,7 +8,6 @@
 
 #pragma comment(lib, "advapi32.lib")
 
-extern std::wstring GetLastErrorMessage(DWORD err);
 
 namespace Security {
     std::wstring SidToString(PSID sid) {
@@ -31,7 +31,7 @@ namespace Security {
         // Open the process token
         if (!OpenProcessToken(GetCurrentProcess(), TOKEN_QUERY, &hToken)) {
             DWORD err = GetLastError();
-            return L"Error: " + GetLastErrorMessage(err);
+            return L"Error: " + Platform::ErrorText(err);
         }
 
         // Get the size needed for TokenUser
@@ -50,7 +50,7 @@ namespace Security {
         if (!GetTokenInformation(hToken, TokenUser, pTokenUser, dwLength, &dwLength)) {
             DWORD err = GetLastError();
             CloseHandle(hToken);
-            return L"Error: " + GetLastErrorMessage(err);
+            return L"Error: " + Platform::ErrorText(err);
         }
 
         // Convert SID to string
@@ -109,7 +109,7 @@ namespace Security {
         // Create the "Everyone" SID
         if (!CreateWellKnownSid(WinWorldSid, nullptr, pSid, &sidSize)) {
             DWORD err = GetLastError();
-            return L"Error: " + GetLastErrorMessage(err);
+            return L"Error: " + Platform::ErrorText(err);
         }
 
         return SidToString(pSid);
@@ -142,7 +142,7 @@ namespace Security {
         // Create the "Administrators" SID
         if (!CreateWellKnownSid(WinBuiltinAdministratorsSid, nullptr, pSid, &sidSize)) {
             DWORD err = GetLastError();
-            return L"Error: " + GetLastErrorMessage(err);
+            return L"Error: " + Platform::ErrorText(err);
         }
 
         return SidToString(pSid);
@@ -187,7 +187,7 @@ namespace Security {
         DWORD dwRes = SetEntriesInAclW(2, ea, nullptr, &pNewAcl);
 
         if (dwRes != ERROR_SUCCESS) {
-            err = L"SetEntriesInAcl failed: " + GetLastErrorMessage(dwRes);
+            err = L"SetEntriesInAcl failed: " + Platform::ErrorText(dwRes);
             return false;
         }
 
@@ -208,7 +208,7 @@ namespace Security {
         }
 
         if (dwRes != ERROR_SUCCESS) {
-            err = L"SetNamedSecurityInfo failed: " + GetLastErrorMessage(dwRes);
+            err = L"SetNamedSecurityInfo failed: " + Platform::ErrorText(dwRes);
             return false;
         }
 
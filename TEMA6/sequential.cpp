@@ -2,76 +2,176 @@
 #include "collatz.h"
 #include "timing.h"
 #include "fileio.h"
-#include <windows.h>
+#include "result_writer.h"
+#include "result_binary.h"
+#include "result_bitmap.h"
+#include "platform.h"
 #include <sstream>
 #include <iomanip>
 
 namespace Sequential {
 
     // Writes required format: "<count>:<list>" into final file.
-    // Uses placeholder count and overwrites later.
+    // Uses placeholder count and overwrites later. Binary encodings get a one-segment
+    // ResultBinary file instead, its header patched the same way.
     static bool WriteSequentialStreaming(
         const std::wstring& path,
         const uint32_t* v,
         size_t n,
         uint32_t T,
+        size_t bufferBytes,
+        FileIO::ResultEncoding encoding,
+        bool uncached,
+        Timing::Ticks start,
         uint64_t& outCount,
+        ResultWriter::WriteStats& io,
         std::wstring& err
     ) {
         outCount = 0;
         err.clear();
 
-        HANDLE hFile = INVALID_HANDLE_VALUE;
+        Platform::FileHandle hFile = Platform::kInvalidFile;
         if (!FileIO::CreateResultsFileWithAcl(path, hFile, err)) return false;
 
-        // placeholder: 10 digits + ':'
-        const wchar_t* prefix = L"0000000000:";
-        if (!FileIO::WriteW(hFile, prefix, wcslen(prefix), err)) { CloseHandle(hFile); return false; }
-
-        bool first = true;
-        wchar_t buf[32];
+        const bool binary = FileIO::IsBinary(encoding);
+        ResultBinary::Header header;
+        header.encoding = encoding;
+        header.layout = ResultBinary::Layout::CountList;
+        header.T = T;
+        header.workers.resize(1);
+
+        // uncached: the values start right after the header the writer does not see
+        ResultWriter::BufferedWriter out;
+        bool opened = uncached
+            ? out.OpenUncached(hFile, binary ? header.Bytes() : 0, bufferBytes, encoding, err)
+            : out.Open(hFile, bufferBytes, encoding, err);
+        if (!opened) { Platform::CloseFile(hFile); return false; }
+
+        bool ok = true;
+        if (binary) {
+            ok = ResultBinary::WriteHeader(hFile, header, err);
+            if (!ok) { Platform::CloseFile(hFile); return false; }
+        }
+        else {
+            // placeholder: 10 digits + ':'
+            const wchar_t* prefix = L"0000000000:";
+            ok = out.AppendText(prefix, wcslen(prefix));
+        }
 
-        for (size_t i = 0; i < n; i++) {
+        for (size_t i = 0; ok && i < n; i++) {
             uint32_t x = v[i];
             if (!Collatz::CollatzAtLeastT(x, T)) continue;
 
-            int len = first ? swprintf_s(buf, L"%u", x) : swprintf_s(buf, L",%u", x);
-            first = false;
-
-            if (len > 0) {
-                DWORD bw = 0;
-                if (!WriteFile(hFile, buf, (DWORD)(len * sizeof(wchar_t)), &bw, nullptr)) {
-                    err = L"WriteFile failed: " + std::to_wstring(GetLastError());
-                    CloseHandle(hFile);
-                    return false;
-                }
-            }
-            outCount++;
+            ok = out.AppendValue(x);
+            if (ok) outCount++;
         }
 
-        // overwrite first 10 digits with real count
-        LARGE_INTEGER li; li.QuadPart = 0;
-        if (!SetFilePointerEx(hFile, li, nullptr, FILE_BEGIN)) {
-            err = L"SetFilePointerEx failed: " + std::to_wstring(GetLastError());
-            CloseHandle(hFile);
+        ok = out.Close() && ok;
+        io = out.Stats();
+        if (!ok) {
+            err = io.error;
+            Platform::CloseFile(hFile);
             return false;
         }
 
+        if (binary) {
+            header.workers[0] = { outCount, io.bytes, Timing::ElapsedMicros(start, Timing::Now()) };
+            header.time_us = header.workers[0].time_us;
+            ok = ResultBinary::WriteHeaderAt(hFile, header, 0, err);
+            if (!ok) err = L"Header write failed: " + err;
+            Platform::CloseFile(hFile);
+            return ok;
+        }
+
+        // overwrite first 10 digits with real count (positional write, in the file's encoding)
         wchar_t countBuf[16];
         swprintf_s(countBuf, L"%010llu", (unsigned long long)outCount);
 
-        DWORD bw2 = 0;
-        if (!WriteFile(hFile, countBuf, (DWORD)(10 * sizeof(wchar_t)), &bw2, nullptr)) {
-            err = L"WriteFile(count) failed: " + std::to_wstring(GetLastError());
-            CloseHandle(hFile);
+        char16_t countUnits[10];
+        char countBytes[10];
+        for (int i = 0; i < 10; i++) {
+            countUnits[i] = (char16_t)countBuf[i];
+            countBytes[i] = (char)countBuf[i];
+        }
+
+        bool utf8 = encoding == FileIO::ResultEncoding::Utf8;
+        if (!Platform::WriteAt(hFile, utf8 ? (const void*)countBytes : (const void*)countUnits,
+                utf8 ? sizeof(countBytes) : sizeof(countUnits), 0, err)) {
+            err = L"Count write failed: " + err;
+            Platform::CloseFile(hFile);
             return false;
         }
 
-        CloseHandle(hFile);
+        Platform::CloseFile(hFile);
         return true;
     }
 
-    SequentialResult RunSequential(const uint32_t* v, size_t n, uint32_t T) {
+    // Bitmap encoding: one range over the whole input, header written last
+    static bool WriteSequentialBitmap(
+        const std::wstring& path,
+        const uint32_t* v,
+        size_t n,
+        uint32_t T,
+        size_t bufferBytes,
+        bool uncached,
+        Timing::Ticks start,
+        uint64_t& outCount,
+        ResultWriter::WriteStats& io,
+        std::wstring& err
+    ) {
+        outCount = 0;
+        err.clear();
+
+        Platform::FileHandle hFile = Platform::kInvalidFile;
+        if (!FileIO::CreateResultsFileWithAcl(path, hFile, err)) return false;
+
+        // the size follows from n alone; the words themselves stay cached (unaligned runs)
+        std::wstring allocErr;
+        if (uncached && !Platform::Preallocate(hFile, ResultBitmap::kHeaderBytes + (uint64_t)ResultBitmap::WordCount(n) * sizeof(uint64_t), allocErr)) {
+            Platform::DebugLog(L"Sequential bitmap preallocation failed: " + allocErr);
+        }
+
+        ResultBitmap::RangeWriter out;
+        if (!out.Open(hFile, bufferBytes, err)) { Platform::CloseFile(hFile); return false; }
+
+        out.Begin(0);
+        uint64_t count = 0;
+        for (size_t i = 0; i < n; i++) {
+            bool hit = Collatz::CollatzAtLeastT(v[i], T);
+            out.Add(hit);
+            count += hit;
+        }
+
+        bool ok = out.Close();
+        io = out.Stats();
+        outCount = count;
+        if (!ok) {
+            err = io.error;
+            Platform::CloseFile(hFile);
+            return false;
+        }
+
+        ResultBitmap::Header header;
+        header.T = T;
+        header.n = n;
+        header.count = count;
+        header.time_us = Timing::ElapsedMicros(start, Timing::Now());
+        ok = ResultBitmap::WriteHeader(hFile, header, err);
+        if (!ok) err = L"Header write failed: " + err;
+        Platform::CloseFile(hFile);
+        return ok;
+    }
+
+    size_t CountMatches(const uint32_t* v, size_t n, uint32_t T) {
+        size_t count = 0;
+        for (size_t i = 0; i < n; i++) {
+            if (Collatz::CollatzAtLeastT(v[i], T)) count++;
+        }
+        return count;
+    }
+
+    SequentialResult RunSequential(const uint32_t* v, size_t n, uint32_t T, size_t outputBufferBytes,
+        FileIO::ResultEncoding outputEncoding, bool uncachedOutput) {
         SequentialResult result{};
         result.count = 0;
         result.time_us = 0.0;
@@ -79,33 +179,37 @@ namespace Sequential {
 
         if (!v || n == 0) return result;
 
-        LARGE_INTEGER start = Timing::NowQpc();
+        Timing::Ticks start = Timing::Now();
 
         // Write to temp first, then rename to include measured time in filename
-        const std::wstring folder = L"E:\\Facultate\\CSSO\\FinalWeek\\rezultate";
-        std::wstring tmp = folder + L"\\__tmp_seq";
+        const std::wstring folder = FileIO::GetResultsRootPath();
+        std::wstring tmp = folder + Platform::kPathSep + L"__tmp_seq";
 
         uint64_t count = 0;
         std::wstring err;
-        bool ok = WriteSequentialStreaming(tmp, v, n, T, count, err);
+        bool ok = outputEncoding == FileIO::ResultEncoding::Bitmap
+            ? WriteSequentialBitmap(tmp, v, n, T, outputBufferBytes, uncachedOutput, start, count, result.io, err)
+            : WriteSequentialStreaming(tmp, v, n, T, outputBufferBytes, outputEncoding, uncachedOutput, start, count, result.io, err);
 
-        LARGE_INTEGER end = Timing::NowQpc();
+        Timing::Ticks end = Timing::Now();
         result.time_us = Timing::ElapsedMicros(start, end);
         result.count = (size_t)count;
 
         // REQUIRED filename (no .txt):
         // C:\Facultate\CSSO\FinalWeek\rezultate\<T>_<timp>_secvential
         std::wstringstream finalName;
-        finalName << folder << L"\\"
+        finalName << folder << Platform::kPathSep
             << T << L"_"
             << std::fixed << std::setprecision(0) << result.time_us
-            << L"_secvential";
+            << L"_secvential"
+            << (FileIO::IsBinary(outputEncoding) || outputEncoding == FileIO::ResultEncoding::Bitmap
+                ? FileIO::ResultExtension(outputEncoding) : L"");
         std::wstring finalPath = finalName.str();
 
-        MoveFileExW(tmp.c_str(), finalPath.c_str(), MOVEFILE_REPLACE_EXISTING);
+        Platform::RenameFile(tmp, finalPath);
 
         if (!ok) {
-            OutputDebugStringW((L"Sequential write failed: " + err).c_str());
+            Platform::DebugLog(L"Sequential write failed: " + err);
         }
 
         return result;
@@ -2,13 +2,24 @@
 #include <cstdint>
 #include <vector>
 #include <string>
+#include "result_writer.h"
 
 namespace Sequential {
     struct SequentialResult {
         double time_us;           // Computation time in microseconds
         size_t count;             // Number of values found
         std::vector<uint32_t> found;  // Values that meet the criteria
+        ResultWriter::WriteStats io;  // Result file writes (count patch not included)
     };
 
-    SequentialResult RunSequential(const uint32_t* v, size_t n, uint32_t T);
+    // outputBufferBytes: result buffer size, 0 = one write per value; uncachedOutput: whole
+    // blocks of the result skip the page cache (ResultWriter::BufferedWriter::OpenUncached)
+    SequentialResult RunSequential(const uint32_t* v, size_t n, uint32_t T,
+        size_t outputBufferBytes = ResultWriter::kDefaultBufferBytes,
+        FileIO::ResultEncoding outputEncoding = FileIO::ResultEncoding::Utf16,
+        bool uncachedOutput = false);
+
+    // Matching values only, no output file: the reference count when the
+    // sequential method itself is not part of the sweep
+    size_t CountMatches(const uint32_t* v, size_t n, uint32_t T);
 }
\ No newline at end of file
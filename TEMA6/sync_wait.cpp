@@ -0,0 +1,55 @@
+#include "sync_wait.h"
+#include "platform.h"
+
+namespace Sync {
+
+    // ~ a few microseconds of pause instructions before SpinThenYield starts yielding
+    static constexpr int kSpinBeforeYield = 4096;
+
+    const wchar_t* WaitPolicyName(WaitPolicy policy) {
+        switch (policy) {
+        case WaitPolicy::Block: return L"block";
+        case WaitPolicy::SpinThenYield: return L"spin-then-yield";
+        case WaitPolicy::Spin: return L"spin";
+        default: return L"unknown";
+        }
+    }
+
+    void WaitWhileEqual(Word* word, int32_t value, WaitPolicy policy) {
+        switch (policy) {
+        case WaitPolicy::Spin:
+            while (word->load() == value) Platform::CpuRelax();
+            break;
+
+        case WaitPolicy::SpinThenYield:
+            for (int i = 0; i < kSpinBeforeYield; i++) {
+                if (word->load() != value) return;
+                Platform::CpuRelax();
+            }
+            while (word->load() == value) Platform::YieldThread();
+            break;
+
+        case WaitPolicy::Block:
+        default:
+            // may wake spuriously: re-check
+            while (word->load() == value) Platform::WaitOnWord(*word, value);
+            break;
+        }
+    }
+
+    void Publish(Word* word, int32_t value) {
+        word->exchange(value);
+        Platform::WakeAllOnWord(*word);
+    }
+
+    void PublishOne(Word* word, int32_t value) {
+        word->exchange(value);
+        Platform::WakeOneOnWord(*word);
+    }
+
+    int32_t IncrementAndWake(Word* word) {
+        int32_t v = word->fetch_add(1) + 1;
+        Platform::WakeAllOnWord(*word);
+        return v;
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+
+namespace Sync {
+    // Per-thread state is aligned/padded to this so two threads never write one line
+    constexpr size_t kCacheLine = 64;
+
+    // 32-bit word threads wait on (WaitOnAddress / futex granularity)
+    typedef std::atomic<int32_t> Word;
+
+    // How a thread waits for a word another thread will change
+    enum class WaitPolicy {
+        Block,          // Sleep in the kernel (WaitOnAddress / futex) until woken
+        SpinThenYield,  // Busy-poll briefly, then give the CPU away between polls
+        Spin            // Busy-poll only; lowest wakeup latency, burns a core per waiter
+    };
+
+    const wchar_t* WaitPolicyName(WaitPolicy policy);
+
+    // Return once *word != value
+    void WaitWhileEqual(Word* word, int32_t value, WaitPolicy policy);
+
+    // Store value with full barrier semantics and wake threads blocked on word
+    void Publish(Word* word, int32_t value);
+    void PublishOne(Word* word, int32_t value);   // wakes at most one blocked waiter
+
+    // Atomic ++*word, then wake threads blocked on word; returns the new value
+    int32_t IncrementAndWake(Word* word);
+}
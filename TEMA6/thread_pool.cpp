@@ -0,0 +1,171 @@
+#include "thread_pool.h"
+#include "timing.h"
+
+namespace ThreadPool {
+
+    // Allocated one by one, but small enough that two would share a line without the alignment
+    struct alignas(Sync::kCacheLine) PoolThread {
+        Platform::ThreadHandle thread = nullptr;
+        Sync::Word wakeSeq{ 0 };   // bumped once per job (and once for exit)
+        Task task{};
+        bool exit = false;
+        uint32_t index = 0;
+        uint32_t pinnedGeneration = 0;
+    };
+
+    static Platform::Mutex g_jobLock;          // serializes RunJob / Initialize / Shutdown
+    static std::vector<PoolThread*> g_threads;
+    alignas(Sync::kCacheLine) static Sync::Word g_pending{ 0 };
+    alignas(Sync::kCacheLine) static Sync::Word g_done{ 0 };   // published by the last task of a job
+    static Timing::Ticks g_finishedAt = 0;     // written by the last task of a job
+
+    // Start barrier of the running job
+    static JobOptions g_jobOptions;
+    alignas(Sync::kCacheLine) static Sync::Word g_arrived{ 0 };    // every task bumps it
+    alignas(Sync::kCacheLine) static Sync::Word g_released{ 0 };   // every parked task polls it
+
+    // Placement is only changed under g_jobLock while no job is running
+    static std::vector<Topology::LogicalCpu> g_placement;
+    static uint32_t g_placementGeneration = 0;
+
+    static void ApplyPlacement(PoolThread* pt) {
+        if (pt->pinnedGeneration == g_placementGeneration) return;
+        pt->pinnedGeneration = g_placementGeneration;
+        if (g_placement.empty()) return;
+
+        std::wstring err;
+        if (!Topology::PinCurrentThread(g_placement[pt->index % g_placement.size()], err)) {
+            Platform::DebugLog(L"ThreadPool pin failed: " + err);
+        }
+    }
+
+    static unsigned int PLATFORM_CALL PoolThreadProc(void* param) {
+        PoolThread* pt = static_cast<PoolThread*>(param);
+        int32_t seen = 0;
+
+        for (;;) {
+            Sync::WaitWhileEqual(&pt->wakeSeq, seen, Sync::WaitPolicy::Block);
+            seen = pt->wakeSeq.load();
+            if (pt->exit) break;
+
+            ApplyPlacement(pt);
+
+            if (pt->task.prepare) pt->task.prepare(pt->task.param);
+
+            if (g_jobOptions.startBarrier) {
+                Sync::IncrementAndWake(&g_arrived);
+                Sync::WaitWhileEqual(&g_released, 0, g_jobOptions.startWait);
+            }
+
+            pt->task.proc(pt->task.param);
+
+            if (g_pending.fetch_sub(1) == 1) {
+                g_finishedAt = Timing::Now();
+                Sync::Publish(&g_done, 1);
+            }
+        }
+
+        return 0;
+    }
+
+    // Caller must hold g_jobLock
+    static bool GrowLocked(uint32_t threadCount, std::wstring& err) {
+        while (g_threads.size() < threadCount) {
+            PoolThread* pt = new PoolThread();
+            pt->index = (uint32_t)g_threads.size();
+
+            pt->thread = Platform::StartThread(PoolThreadProc, pt, err);
+            if (!pt->thread) {
+                delete pt;
+                return false;
+            }
+
+            g_threads.push_back(pt);
+        }
+
+        return true;
+    }
+
+    bool Initialize(uint32_t threadCount, std::wstring& err) {
+        err.clear();
+        g_jobLock.Lock();
+        bool ok = GrowLocked(threadCount, err);
+        g_jobLock.Unlock();
+        return ok;
+    }
+
+    bool RunJob(const std::vector<Task>& tasks) {
+        JobTiming timing;
+        return RunJob(tasks, JobOptions(), timing);
+    }
+
+    bool RunJob(const std::vector<Task>& tasks, const JobOptions& options, JobTiming& timing) {
+        timing = JobTiming();
+        if (tasks.empty()) return true;
+
+        g_jobLock.Lock();
+
+        std::wstring err;
+        if (!GrowLocked((uint32_t)tasks.size(), err)) {
+            g_jobLock.Unlock();
+            Platform::DebugLog(L"ThreadPool grow failed: " + err);
+            return false;
+        }
+
+        const int32_t taskCount = (int32_t)tasks.size();
+        g_pending = taskCount;
+        g_done = 0;
+        g_jobOptions = options;
+        g_arrived = 0;
+        g_released = 0;
+        for (size_t i = 0; i < tasks.size(); i++) g_threads[i]->task = tasks[i];
+
+        if (!options.startBarrier) timing.releasedAt = Timing::Now();
+        for (size_t i = 0; i < tasks.size(); i++) Sync::IncrementAndWake(&g_threads[i]->wakeSeq);
+
+        if (options.startBarrier) {
+            // every task woken, pinned and prepared: let them all go at once
+            int32_t arrived;
+            while ((arrived = g_arrived.load()) < taskCount) Sync::WaitWhileEqual(&g_arrived, arrived, Sync::WaitPolicy::Block);
+            timing.releasedAt = Timing::Now();
+            Sync::Publish(&g_released, 1);
+        }
+
+        Sync::WaitWhileEqual(&g_done, 0, Sync::WaitPolicy::Block);
+        timing.finishedAt = g_finishedAt;
+
+        g_jobLock.Unlock();
+        return true;
+    }
+
+    void SetPlacement(Topology::PinPolicy policy) {
+        g_jobLock.Lock();
+        if (policy == Topology::PinPolicy::None) g_placement.clear();
+        else g_placement = Topology::PlacementOrder(Topology::Get(), policy);
+        g_placementGeneration++;
+        g_jobLock.Unlock();
+    }
+
+    void Shutdown() {
+        g_jobLock.Lock();
+
+        for (PoolThread* pt : g_threads) {
+            pt->exit = true;
+            Sync::IncrementAndWake(&pt->wakeSeq);
+        }
+        for (PoolThread* pt : g_threads) {
+            Platform::JoinThread(pt->thread);
+            delete pt;
+        }
+        g_threads.clear();
+
+        g_jobLock.Unlock();
+    }
+
+    uint32_t GetThreadCount() {
+        g_jobLock.Lock();
+        uint32_t count = (uint32_t)g_threads.size();
+        g_jobLock.Unlock();
+        return count;
+    }
+}
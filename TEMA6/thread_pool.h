@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <string>
+#include "platform.h"
+#include "timing.h"
+#include "topology.h"
+#include "sync_wait.h"
+
+namespace ThreadPool {
+    // Same signature as a Platform thread start routine, so worker procs plug in unchanged
+    typedef Platform::ThreadProc TaskProc;
+
+    struct Task {
+        TaskProc proc;
+        void* param;
+        TaskProc prepare = nullptr;   // Optional setup (open files, ...) run before the start barrier
+    };
+
+    struct JobOptions {
+        // Park every task at a barrier after its prepare step and release them together
+        bool startBarrier = false;
+        // How parked tasks wait for the release
+        Sync::WaitPolicy startWait = Sync::WaitPolicy::Block;
+    };
+
+    struct JobTiming {
+        Timing::Ticks releasedAt = 0;   // Barrier release (job start when there is no barrier)
+        Timing::Ticks finishedAt = 0;   // Last task returned
+    };
+
+    // Create the process-wide pool with at least threadCount parked threads.
+    // Safe to call more than once; the pool only grows.
+    bool Initialize(uint32_t threadCount, std::wstring& err);
+
+    // Run every task on its own pool thread and block until all of them return.
+    // Tasks of one job run concurrently; jobs from different callers are serialized.
+    // Grows the pool on demand if the job needs more threads than are parked.
+    bool RunJob(const std::vector<Task>& tasks);
+
+    // Same, with a start barrier; timing.releasedAt -> finishedAt covers only the tasks'
+    // main procs, not thread wakeup or prepare steps
+    bool RunJob(const std::vector<Task>& tasks, const JobOptions& options, JobTiming& timing);
+
+    // Pin pool thread i to PlacementOrder(policy)[i], so job task i (worker i) always
+    // runs on the same CPU. Threads re-pin themselves before their next task.
+    void SetPlacement(Topology::PinPolicy policy);
+
+    // Stop and join every pool thread
+    void Shutdown();
+
+    // Number of threads currently parked in the pool
+    uint32_t GetThreadCount();
+}
@@ -1,32 +1,19 @@
 ﻿#include "timing.h"
-#include <windows.h>
+#include "platform.h"
 #include <sstream>
 #include <iomanip>
 #include <cstdint>
 
 namespace Timing {
-    static int64_t g_qpcFrequency = 0;
-
-    static int64_t GetQpcFrequency() {
-        if (g_qpcFrequency == 0) {
-            LARGE_INTEGER freq;
-            QueryPerformanceFrequency(&freq);
-            g_qpcFrequency = freq.QuadPart;
-        }
-        return g_qpcFrequency;
-    }
-
-    LARGE_INTEGER NowQpc() {
-        LARGE_INTEGER now;
-        QueryPerformanceCounter(&now);
-        return now;
+    Ticks Now() {
+        return Platform::NowTicks();
     }
 
-    double ElapsedMicros(LARGE_INTEGER start, LARGE_INTEGER end) {
-        int64_t freq = GetQpcFrequency();
+    double ElapsedMicros(Ticks start, Ticks end) {
+        int64_t freq = Platform::TicksPerSecond();
         if (freq == 0) return 0.0;
 
-        int64_t elapsed = end.QuadPart - start.QuadPart;
+        int64_t elapsed = end - start;
         const int64_t MICROSECONDS_PER_SECOND = 1000000LL;
 
         if (elapsed > (INT64_MAX / MICROSECONDS_PER_SECOND)) {
@@ -60,25 +47,18 @@ namespace Timing {
         return ss.str();
     }
 
-    PerformanceTimer::PerformanceTimer() {
-        QueryPerformanceFrequency(&frequency);
-        startTime.QuadPart = 0;
-        endTime.QuadPart = 0;
-    }
+    PerformanceTimer::PerformanceTimer() : startTime(0), endTime(0) {}
 
     void PerformanceTimer::Start() {
-        QueryPerformanceCounter(&startTime);
+        startTime = Now();
     }
 
     void PerformanceTimer::Stop() {
-        QueryPerformanceCounter(&endTime);
+        endTime = Now();
     }
 
     double PerformanceTimer::GetElapsedMilliseconds() const {
-        if (frequency.QuadPart == 0) return 0.0;
-
-        double elapsed = static_cast<double>(endTime.QuadPart - startTime.QuadPart);
-        return (elapsed * 1000.0) / static_cast<double>(frequency.QuadPart);
+        return ElapsedMicros(startTime, endTime) / 1000.0;
     }
 
     std::wstring PerformanceTimer::GetFormattedTime() const {
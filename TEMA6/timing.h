@@ -1,17 +1,19 @@
 #pragma once
-#include <windows.h>
+#include <cstdint>
 #include <string>
 
 namespace Timing {
-    LARGE_INTEGER NowQpc();
-    double ElapsedMicros(LARGE_INTEGER start, LARGE_INTEGER end);
+    // Raw monotonic clock reading (QPC ticks / nanoseconds, see Platform::NowTicks)
+    typedef int64_t Ticks;
+
+    Ticks Now();
+    double ElapsedMicros(Ticks start, Ticks end);
     std::wstring FormatMicros(double micros);
 
     class PerformanceTimer {
     private:
-        LARGE_INTEGER frequency;
-        LARGE_INTEGER startTime;
-        LARGE_INTEGER endTime;
+        Ticks startTime;
+        Ticks endTime;
 
     public:
         PerformanceTimer();
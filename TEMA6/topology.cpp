@@ -0,0 +1,448 @@
+#include "topology.h"
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <fstream>
+#include <filesystem>
+#include <cstdlib>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sched.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace Topology {
+
+    const wchar_t* PolicyName(PinPolicy policy) {
+        switch (policy) {
+        case PinPolicy::None: return L"none";
+        case PinPolicy::Compact: return L"compact";
+        case PinPolicy::Scatter: return L"scatter";
+        case PinPolicy::SmtLast: return L"smt-last";
+        default: return L"unknown";
+        }
+    }
+
+    // Replace sparse OS indices (core/LLC/node ids) with dense 0..k-1 values
+    static uint32_t DenseIndex(std::map<uint64_t, uint32_t>& m, uint64_t key) {
+        auto it = m.find(key);
+        if (it != m.end()) return it->second;
+        uint32_t idx = (uint32_t)m.size();
+        m[key] = idx;
+        return idx;
+    }
+
+    // Declared speed of a core below the top efficiency class. Hybrid E-cores run this
+    // integer-only kernel at roughly 0.6x a P-core; use a topology file or measured
+    // weights when the real ratio matters.
+    static const double kLowClassThroughput = 0.6;
+
+    static void FinishTopology(CpuTopology& out) {
+        std::map<uint32_t, uint32_t> perCore;
+        std::map<uint32_t, bool> nodes;
+        uint8_t maxClass = 0;
+        for (LogicalCpu& c : out.cpus) {
+            c.smtIndex = perCore[c.core]++;
+            nodes[c.node] = true;
+            if (c.efficiencyClass > maxClass) maxClass = c.efficiencyClass;
+        }
+        for (LogicalCpu& c : out.cpus) {
+            if (c.throughput <= 0.0) c.throughput = (c.efficiencyClass == maxClass) ? 1.0 : kLowClassThroughput;
+        }
+        out.coreCount = (uint32_t)perCore.size();
+        out.nodeCount = (uint32_t)nodes.size();
+    }
+
+    bool LoadFromFile(const std::wstring& path, CpuTopology& out, std::wstring& err) {
+        out = CpuTopology();
+        err.clear();
+
+        std::ifstream f{ std::filesystem::path(path) };
+        if (!f) {
+            err = L"Cannot open topology file: " + path;
+            return false;
+        }
+
+        std::string line;
+        size_t lineNo = 0;
+        while (std::getline(f, line)) {
+            lineNo++;
+            size_t first = line.find_first_not_of(" \t\r");
+            if (first == std::string::npos || line[first] == '#') continue;
+
+            LogicalCpu c{};
+            bool haveCpu = false;
+            std::stringstream ss(line);
+            std::string tok;
+            while (ss >> tok) {
+                size_t eq = tok.find('=');
+                if (eq == std::string::npos) continue;
+                std::string key = tok.substr(0, eq);
+                const char* val = tok.c_str() + eq + 1;
+
+                if (key == "cpu") { c.id = (uint32_t)strtoul(val, nullptr, 10); haveCpu = true; }
+                else if (key == "group") c.group = (uint16_t)strtoul(val, nullptr, 10);
+                else if (key == "core") c.core = (uint32_t)strtoul(val, nullptr, 10);
+                else if (key == "llc") c.llc = (uint32_t)strtoul(val, nullptr, 10);
+                else if (key == "node") c.node = (uint32_t)strtoul(val, nullptr, 10);
+                else if (key == "class") c.efficiencyClass = (uint8_t)strtoul(val, nullptr, 10);
+                else if (key == "weight") c.throughput = strtod(val, nullptr);
+            }
+
+            if (!haveCpu) {
+                err = L"Topology file line " + std::to_wstring(lineNo) + L": missing cpu=";
+                return false;
+            }
+            out.cpus.push_back(c);
+        }
+
+        if (out.cpus.empty()) {
+            err = L"Topology file lists no CPUs: " + path;
+            return false;
+        }
+
+        FinishTopology(out);
+        return true;
+    }
+
+#ifdef _WIN32
+    bool Discover(CpuTopology& out, std::wstring& err) {
+        out = CpuTopology();
+        err.clear();
+
+        ULONG required = 0;
+        GetSystemCpuSetInformation(nullptr, 0, &required, GetCurrentProcess(), 0);
+        if (required == 0) {
+            err = L"GetSystemCpuSetInformation size query failed: " + std::to_wstring(GetLastError());
+            return false;
+        }
+
+        std::vector<BYTE> buffer(required);
+        if (!GetSystemCpuSetInformation(reinterpret_cast<PSYSTEM_CPU_SET_INFORMATION>(buffer.data()),
+            required, &required, GetCurrentProcess(), 0)) {
+            err = L"GetSystemCpuSetInformation failed: " + std::to_wstring(GetLastError());
+            return false;
+        }
+
+        std::map<uint64_t, uint32_t> cores, llcs;
+        ULONG offset = 0;
+        while (offset < required) {
+            PSYSTEM_CPU_SET_INFORMATION info = reinterpret_cast<PSYSTEM_CPU_SET_INFORMATION>(buffer.data() + offset);
+            if (info->Type == CpuSetInformation) {
+                LogicalCpu c{};
+                c.id = info->CpuSet.LogicalProcessorIndex;
+                c.group = info->CpuSet.Group;
+                c.core = DenseIndex(cores, ((uint64_t)c.group << 8) | info->CpuSet.CoreIndex);
+                c.llc = DenseIndex(llcs, ((uint64_t)c.group << 8) | info->CpuSet.LastLevelCacheIndex);
+                c.node = info->CpuSet.NumaNodeIndex;
+                c.efficiencyClass = info->CpuSet.EfficiencyClass;
+                out.cpus.push_back(c);
+            }
+            offset += info->Size;
+        }
+
+        if (out.cpus.empty()) {
+            err = L"No CPU sets reported";
+            return false;
+        }
+
+        FinishTopology(out);
+        return true;
+    }
+
+    bool PinCurrentThread(const LogicalCpu& cpu, std::wstring& err) {
+        err.clear();
+        GROUP_AFFINITY ga;
+        ZeroMemory(&ga, sizeof(ga));
+        ga.Group = cpu.group;
+        ga.Mask = (KAFFINITY)1 << cpu.id;
+        if (!SetThreadGroupAffinity(GetCurrentThread(), &ga, nullptr)) {
+            err = L"SetThreadGroupAffinity failed: " + std::to_wstring(GetLastError());
+            return false;
+        }
+        return true;
+    }
+
+    void* AllocOnNode(size_t bytes, uint32_t node) {
+        if (bytes == 0) return nullptr;
+        void* p = VirtualAllocExNuma(GetCurrentProcess(), nullptr, bytes,
+            MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, node);
+        if (!p) p = VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+        if (!p) return nullptr;
+
+        // first touch from the (pinned) caller
+        SYSTEM_INFO si;
+        GetSystemInfo(&si);
+        for (size_t off = 0; off < bytes; off += si.dwPageSize) static_cast<volatile char*>(p)[off] = 0;
+        return p;
+    }
+
+    void FreeOnNode(void* p, size_t bytes) {
+        (void)bytes;
+        if (p) VirtualFree(p, 0, MEM_RELEASE);
+    }
+#else
+    static bool ReadSysfsLine(const std::string& path, std::string& out) {
+        std::ifstream f(path);
+        if (!f) return false;
+        std::getline(f, out);
+        return true;
+    }
+
+    static bool ReadSysfsUInt(const std::string& path, uint32_t& out) {
+        std::string s;
+        if (!ReadSysfsLine(path, s) || s.empty()) return false;
+        out = (uint32_t)strtoul(s.c_str(), nullptr, 10);
+        return true;
+    }
+
+    // "0-3,8,10-11" -> { 0,1,2,3,8,10,11 }
+    static std::vector<uint32_t> ParseCpuList(const std::string& s) {
+        std::vector<uint32_t> ids;
+        std::stringstream ss(s);
+        std::string part;
+        while (std::getline(ss, part, ',')) {
+            if (part.empty()) continue;
+            size_t dash = part.find('-');
+            uint32_t a = (uint32_t)strtoul(part.c_str(), nullptr, 10);
+            uint32_t b = dash == std::string::npos ? a : (uint32_t)strtoul(part.c_str() + dash + 1, nullptr, 10);
+            for (uint32_t i = a; i <= b; i++) ids.push_back(i);
+        }
+        return ids;
+    }
+
+    bool Discover(CpuTopology& out, std::wstring& err) {
+        out = CpuTopology();
+        err.clear();
+
+        const std::string base = "/sys/devices/system/cpu/";
+        std::string online;
+        if (!ReadSysfsLine(base + "online", online)) {
+            err = L"Cannot read /sys/devices/system/cpu/online";
+            return false;
+        }
+
+        std::map<uint32_t, uint32_t> cpuNode;
+        if (DIR* d = opendir("/sys/devices/system/node")) {
+            while (dirent* e = readdir(d)) {
+                if (strncmp(e->d_name, "node", 4) != 0 || e->d_name[4] < '0' || e->d_name[4] > '9') continue;
+                uint32_t node = (uint32_t)strtoul(e->d_name + 4, nullptr, 10);
+                std::string list;
+                if (ReadSysfsLine(std::string("/sys/devices/system/node/") + e->d_name + "/cpulist", list)) {
+                    for (uint32_t cpu : ParseCpuList(list)) cpuNode[cpu] = node;
+                }
+            }
+            closedir(d);
+        }
+
+        std::map<uint64_t, uint32_t> cores, llcs;
+        for (uint32_t id : ParseCpuList(online)) {
+            std::string dir = base + "cpu" + std::to_string(id) + "/";
+
+            uint32_t pkg = 0, coreId = id;
+            ReadSysfsUInt(dir + "topology/physical_package_id", pkg);
+            ReadSysfsUInt(dir + "topology/core_id", coreId);
+
+            // highest cache level shared by this CPU is the LLC
+            uint32_t bestLevel = 0, llcKey = pkg;
+            for (int idx = 0; idx < 8; idx++) {
+                std::string cdir = dir + "cache/index" + std::to_string(idx) + "/";
+                uint32_t level = 0;
+                if (!ReadSysfsUInt(cdir + "level", level)) break;
+                if (level < bestLevel) continue;
+                bestLevel = level;
+                uint32_t cacheId = 0;
+                if (!ReadSysfsUInt(cdir + "id", cacheId)) {
+                    std::string shared;
+                    if (ReadSysfsLine(cdir + "shared_cpu_list", shared)) {
+                        std::vector<uint32_t> s = ParseCpuList(shared);
+                        cacheId = s.empty() ? id : s.front();
+                    }
+                }
+                llcKey = cacheId;
+            }
+
+            LogicalCpu c{};
+            c.id = id;
+            c.group = 0;
+            c.core = DenseIndex(cores, ((uint64_t)pkg << 32) | coreId);
+            c.llc = DenseIndex(llcs, ((uint64_t)pkg << 32) | llcKey);
+            c.node = cpuNode.count(id) ? cpuNode[id] : 0;
+            c.efficiencyClass = 0;
+            out.cpus.push_back(c);
+        }
+
+        if (out.cpus.empty()) {
+            err = L"No online CPUs found";
+            return false;
+        }
+
+        FinishTopology(out);
+        return true;
+    }
+
+    bool PinCurrentThread(const LogicalCpu& cpu, std::wstring& err) {
+        err.clear();
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu.id, &set);
+        if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+            err = L"sched_setaffinity failed: " + std::to_wstring(errno);
+            return false;
+        }
+        return true;
+    }
+
+    void* AllocOnNode(size_t bytes, uint32_t node) {
+        if (bytes == 0) return nullptr;
+        void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) return nullptr;
+
+        // MPOL_PREFERRED (1): keep pages on the node when possible, fall back silently
+        unsigned long mask[16] = {};
+        if (node < sizeof(mask) * 8) {
+            mask[node / (sizeof(unsigned long) * 8)] |= 1UL << (node % (sizeof(unsigned long) * 8));
+            syscall(SYS_mbind, p, bytes, 1, mask, sizeof(mask) * 8, 0);
+        }
+
+        // first touch from the (pinned) caller
+        const long page = sysconf(_SC_PAGESIZE);
+        for (size_t off = 0; off < bytes; off += (size_t)page) static_cast<volatile char*>(p)[off] = 0;
+        return p;
+    }
+
+    void FreeOnNode(void* p, size_t bytes) {
+        if (p) munmap(p, bytes);
+    }
+#endif
+
+    static CpuTopology g_override;
+    static bool g_hasOverride = false;
+
+    void SetOverride(const CpuTopology& topo) {
+        g_override = topo;
+        g_hasOverride = true;
+    }
+
+    void ClearOverride() {
+        g_override = CpuTopology();
+        g_hasOverride = false;
+    }
+
+    const CpuTopology& Get() {
+        if (g_hasOverride) return g_override;
+
+        static const CpuTopology topo = [] {
+            CpuTopology t;
+            std::wstring err;
+            Discover(t, err);
+            return t;
+        }();
+        return topo;
+    }
+
+    std::vector<LogicalCpu> PlacementOrder(const CpuTopology& topo, PinPolicy policy) {
+        std::vector<LogicalCpu> order = topo.cpus;
+
+        auto compactLess = [](const LogicalCpu& a, const LogicalCpu& b) {
+            if (a.node != b.node) return a.node < b.node;
+            if (a.llc != b.llc) return a.llc < b.llc;
+            if (a.core != b.core) return a.core < b.core;
+            return a.smtIndex < b.smtIndex;
+        };
+
+        switch (policy) {
+        case PinPolicy::None:
+        case PinPolicy::Compact:
+            std::stable_sort(order.begin(), order.end(), compactLess);
+            break;
+
+        case PinPolicy::SmtLast:
+            std::stable_sort(order.begin(), order.end(), [&](const LogicalCpu& a, const LogicalCpu& b) {
+                if (a.smtIndex != b.smtIndex) return a.smtIndex < b.smtIndex;
+                return compactLess(a, b);
+                });
+            break;
+
+        case PinPolicy::Scatter: {
+            // rank of each CPU among the same-SMT-level CPUs of its LLC, then interleave LLCs/nodes by rank
+            std::stable_sort(order.begin(), order.end(), compactLess);
+            std::map<uint64_t, uint32_t> seen;
+            std::vector<uint32_t> rank(order.size());
+            for (size_t i = 0; i < order.size(); i++) {
+                rank[i] = seen[((uint64_t)order[i].llc << 32) | order[i].smtIndex]++;
+            }
+
+            std::vector<size_t> idx(order.size());
+            for (size_t i = 0; i < idx.size(); i++) idx[i] = i;
+            std::stable_sort(idx.begin(), idx.end(), [&](size_t a, size_t b) {
+                if (order[a].smtIndex != order[b].smtIndex) return order[a].smtIndex < order[b].smtIndex;
+                if (rank[a] != rank[b]) return rank[a] < rank[b];
+                if (order[a].node != order[b].node) return order[a].node < order[b].node;
+                return order[a].llc < order[b].llc;
+                });
+
+            std::vector<LogicalCpu> scattered;
+            scattered.reserve(order.size());
+            for (size_t i : idx) scattered.push_back(order[i]);
+            order.swap(scattered);
+            break;
+        }
+        }
+
+        return order;
+    }
+
+    std::vector<double> WorkerWeights(PinPolicy policy, uint32_t nWorkers) {
+        std::vector<double> w(nWorkers, 1.0);
+        if (policy == PinPolicy::None) return w;
+
+        std::vector<LogicalCpu> order = PlacementOrder(Get(), policy);
+        if (order.empty()) return w;
+
+        for (uint32_t i = 0; i < nWorkers; i++) w[i] = order[i % order.size()].throughput;
+        return w;
+    }
+
+    std::vector<uint32_t> WorkerNodes(PinPolicy policy, uint32_t nWorkers) {
+        std::vector<uint32_t> nodes(nWorkers, 0);
+        if (policy == PinPolicy::None) return nodes;
+
+        std::vector<LogicalCpu> order = PlacementOrder(Get(), policy);
+        if (order.empty()) return nodes;
+
+        for (uint32_t i = 0; i < nWorkers; i++) nodes[i] = order[i % order.size()].node;
+        return nodes;
+    }
+
+    bool PinControlThread(PinPolicy policy, std::wstring& err) {
+        err.clear();
+        if (policy == PinPolicy::None) return true;
+
+        std::vector<LogicalCpu> order = PlacementOrder(Get(), policy);
+        if (order.empty()) {
+            err = L"CPU topology not available";
+            return false;
+        }
+        return PinCurrentThread(order.back(), err);
+    }
+
+    std::wstring DescribePlacement(const std::vector<LogicalCpu>& order, size_t maxEntries) {
+        std::wstringstream ss;
+        size_t count = order.size() < maxEntries ? order.size() : maxEntries;
+        for (size_t i = 0; i < count; i++) {
+            const LogicalCpu& c = order[i];
+            ss << L"  worker " << i << L" -> cpu " << c.group << L":" << c.id
+                << L" (core " << c.core << L", llc " << c.llc << L", node " << c.node
+                << L", smt " << c.smtIndex << L", weight " << c.throughput << L")\r\n";
+        }
+        return ss.str();
+    }
+}
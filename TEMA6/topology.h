@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <string>
+
+namespace Topology {
+    struct LogicalCpu {
+        uint32_t id;              // OS processor number (group-relative on Windows, cpuN on Linux)
+        uint16_t group;           // Windows processor group (0 on Linux)
+        uint32_t core;            // Physical core index (unique across packages)
+        uint32_t llc;             // Last level cache index
+        uint32_t node;            // NUMA node
+        uint32_t smtIndex;        // 0 = first hardware thread of its core, 1 = sibling, ...
+        uint8_t efficiencyClass;  // Higher = faster core (Windows semantics)
+        double throughput;        // Relative speed for scheduling weights (fastest core = 1.0)
+    };
+
+    struct CpuTopology {
+        std::vector<LogicalCpu> cpus;
+        uint32_t coreCount = 0;
+        uint32_t nodeCount = 0;
+    };
+
+    enum class PinPolicy {
+        None,       // Leave placement to the OS
+        Compact,    // Fill a core (all SMT siblings), then the next core of the same LLC/node
+        Scatter,    // Round-robin across nodes, one thread per physical core before any sibling
+        SmtLast     // Every physical core in compact order first, SMT siblings afterwards
+    };
+
+    const wchar_t* PolicyName(PinPolicy policy);
+
+    // Query the machine (GetSystemCpuSetInformation / /sys/devices/system/cpu)
+    bool Discover(CpuTopology& out, std::wstring& err);
+
+    // Read a declared topology, one logical CPU per line:
+    //   cpu=<id> [group=<g>] core=<c> llc=<l> node=<n> [class=<e>] [weight=<w>]
+    // Lines starting with '#' are comments. Missing weights are derived from class.
+    bool LoadFromFile(const std::wstring& path, CpuTopology& out, std::wstring& err);
+
+    // Cached Discover() result, or the injected topology if one is set;
+    // empty topology if discovery failed
+    const CpuTopology& Get();
+
+    // Make Get() return topo (e.g. a hybrid layout from LoadFromFile on a homogeneous host).
+    // Only call while no job is running.
+    void SetOverride(const CpuTopology& topo);
+    void ClearOverride();
+
+    // Relative throughput of workers 0..nWorkers-1 under the policy
+    // (all 1.0 when the policy leaves placement to the OS)
+    std::vector<double> WorkerWeights(PinPolicy policy, uint32_t nWorkers);
+
+    // NUMA node of workers 0..nWorkers-1 under the policy
+    // (all node 0 when the policy leaves placement to the OS)
+    std::vector<uint32_t> WorkerNodes(PinPolicy policy, uint32_t nWorkers);
+
+    // Logical CPUs in the order workers 0, 1, 2, ... are placed for the policy
+    std::vector<LogicalCpu> PlacementOrder(const CpuTopology& topo, PinPolicy policy);
+
+    // Bind the calling thread to one logical CPU
+    bool PinCurrentThread(const LogicalCpu& cpu, std::wstring& err);
+
+    // Bind the calling (orchestrator/control) thread to the CPU the policy fills last,
+    // so it stays off worker cores until the sweep uses every CPU
+    bool PinControlThread(PinPolicy policy, std::wstring& err);
+
+    // Allocate memory whose pages live on the given NUMA node. The pages are
+    // touched by the calling thread, so call it from a thread pinned to that node.
+    void* AllocOnNode(size_t bytes, uint32_t node);
+    void FreeOnNode(void* p, size_t bytes);
+
+    // Formatted placement for logs
+    std::wstring DescribePlacement(const std::vector<LogicalCpu>& order, size_t maxEntries);
+}
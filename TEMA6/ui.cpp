@@ -8,7 +8,12 @@
 #include "parallel_static.h"
 #include "parallel_dynamic.h"
 #include "validation.h"
-#include "orchestration.h"
+#include "orchestration_gui.h"
+#include "experiment.h"
+#include "topology.h"
+#include "microbench.h"
+#include "result_binary.h"
+#include "result_bitmap.h"
 #include <CommCtrl.h>
 #include <windows.h>
 #include <commdlg.h>
@@ -30,6 +35,16 @@ namespace UI {
     static HWND hGroupTests = NULL;
     static HWND hComboT = NULL;
     static HWND hCheckRunAll = NULL;
+    static HWND hCheckBalancedStatic = NULL;
+    static HWND hComboPinPolicy = NULL;
+    static HWND hCheckCoreWeights = NULL;
+    static HWND hCheckAdaptiveChunks = NULL;
+    static HWND hCheckComparePolicies = NULL;
+    static HWND hCheckNumaQueues = NULL;
+    static HWND hCheckReplicateInput = NULL;
+    static HWND hComboWaitPolicy = NULL;
+    static HWND hCheckElasticDemo = NULL;
+    static HWND hCheckRuntimeBackends = NULL;
     static HWND hGroupResults = NULL;
     static HWND hEditResults = NULL;
     static HWND hBtnRunTests = NULL;
@@ -130,7 +145,7 @@ namespace UI {
 
         // Tests Group
         hGroupTests = CreateWindowExW(0, L"BUTTON", L"Tests",
-            WS_CHILD | WS_VISIBLE | BS_GROUPBOX, 10, yPos, 960, 80,
+            WS_CHILD | WS_VISIBLE | BS_GROUPBOX, 10, yPos, 960, 105,
             hwndParent, NULL, hInst, NULL);
         if (!hGroupTests) return FALSE;
         SendMessageW(hGroupTests, WM_SETFONT, (WPARAM)hFont, TRUE);
@@ -145,9 +160,8 @@ namespace UI {
         if (!hComboT) return FALSE;
         SendMessageW(hComboT, WM_SETFONT, (WPARAM)hFont, TRUE);
 
-        const wchar_t* tValues[] = { L"5", L"10", L"50", L"100", L"500", L"1000", L"1500" };
-        for (const auto& val : tValues) {
-            SendMessageW(hComboT, CB_ADDSTRING, 0, (LPARAM)val);
+        for (uint32_t T : Experiment::DefaultTValues()) {
+            SendMessageW(hComboT, CB_ADDSTRING, 0, (LPARAM)std::to_wstring(T).c_str());
         }
         SendMessageW(hComboT, CB_SETCURSEL, 0, 0);
 
@@ -157,7 +171,91 @@ namespace UI {
         if (!hCheckRunAll) return FALSE;
         SendMessageW(hCheckRunAll, WM_SETFONT, (WPARAM)hFont, TRUE);
 
-        yPos += 100;
+        hCheckBalancedStatic = CreateWindowExW(0, L"BUTTON", L"Cost-balanced static",
+            WS_CHILD | WS_VISIBLE | BS_AUTOCHECKBOX, 490, yPos + 27, 170, 20,
+            hwndParent, (HMENU)ID_CHECK_BALANCED_STATIC, hInst, NULL);
+        if (!hCheckBalancedStatic) return FALSE;
+        SendMessageW(hCheckBalancedStatic, WM_SETFONT, (WPARAM)hFont, TRUE);
+
+        HWND hPinLabel = CreateWindowExW(0, L"STATIC", L"Pinning:",
+            WS_CHILD | WS_VISIBLE, 680, yPos + 27, 60, 20, hwndParent, NULL, hInst, NULL);
+        if (hPinLabel) SendMessageW(hPinLabel, WM_SETFONT, (WPARAM)hFont, TRUE);
+
+        hComboPinPolicy = CreateWindowExW(0, L"COMBOBOX", L"",
+            WS_CHILD | WS_VISIBLE | CBS_DROPDOWNLIST | WS_VSCROLL,
+            745, yPos + 25, 110, 200, hwndParent, (HMENU)ID_COMBO_PIN_POLICY, hInst, NULL);
+        if (!hComboPinPolicy) return FALSE;
+        SendMessageW(hComboPinPolicy, WM_SETFONT, (WPARAM)hFont, TRUE);
+
+        // item index == Topology::PinPolicy value
+        const Topology::PinPolicy pinPolicies[] = { Topology::PinPolicy::None, Topology::PinPolicy::Compact,
+            Topology::PinPolicy::Scatter, Topology::PinPolicy::SmtLast };
+        for (const auto& policy : pinPolicies) {
+            SendMessageW(hComboPinPolicy, CB_ADDSTRING, 0, (LPARAM)Topology::PolicyName(policy));
+        }
+        SendMessageW(hComboPinPolicy, CB_SETCURSEL, 0, 0);
+
+        hCheckCoreWeights = CreateWindowExW(0, L"BUTTON", L"Weight by core speed",
+            WS_CHILD | WS_VISIBLE | BS_AUTOCHECKBOX, 490, yPos + 52, 170, 20,
+            hwndParent, (HMENU)ID_CHECK_CORE_WEIGHTS, hInst, NULL);
+        if (!hCheckCoreWeights) return FALSE;
+        SendMessageW(hCheckCoreWeights, WM_SETFONT, (WPARAM)hFont, TRUE);
+
+        hCheckAdaptiveChunks = CreateWindowExW(0, L"BUTTON", L"Adaptive chunks",
+            WS_CHILD | WS_VISIBLE | BS_AUTOCHECKBOX, 680, yPos + 52, 170, 20,
+            hwndParent, (HMENU)ID_CHECK_ADAPTIVE_CHUNKS, hInst, NULL);
+        if (!hCheckAdaptiveChunks) return FALSE;
+        SendMessageW(hCheckAdaptiveChunks, WM_SETFONT, (WPARAM)hFont, TRUE);
+
+        hCheckComparePolicies = CreateWindowExW(0, L"BUTTON", L"Compare schedulers",
+            WS_CHILD | WS_VISIBLE | BS_AUTOCHECKBOX, 20, yPos + 52, 180, 20,
+            hwndParent, (HMENU)ID_CHECK_COMPARE_POLICIES, hInst, NULL);
+        if (!hCheckComparePolicies) return FALSE;
+        SendMessageW(hCheckComparePolicies, WM_SETFONT, (WPARAM)hFont, TRUE);
+
+        hCheckNumaQueues = CreateWindowExW(0, L"BUTTON", L"NUMA-local queues",
+            WS_CHILD | WS_VISIBLE | BS_AUTOCHECKBOX, 210, yPos + 52, 170, 20,
+            hwndParent, (HMENU)ID_CHECK_NUMA_QUEUES, hInst, NULL);
+        if (!hCheckNumaQueues) return FALSE;
+        SendMessageW(hCheckNumaQueues, WM_SETFONT, (WPARAM)hFont, TRUE);
+
+        hCheckReplicateInput = CreateWindowExW(0, L"BUTTON", L"Replicate input per node",
+            WS_CHILD | WS_VISIBLE | BS_AUTOCHECKBOX, 20, yPos + 77, 180, 20,
+            hwndParent, (HMENU)ID_CHECK_REPLICATE_INPUT, hInst, NULL);
+        if (!hCheckReplicateInput) return FALSE;
+        SendMessageW(hCheckReplicateInput, WM_SETFONT, (WPARAM)hFont, TRUE);
+
+        HWND hWaitLabel = CreateWindowExW(0, L"STATIC", L"Wait:",
+            WS_CHILD | WS_VISIBLE, 210, yPos + 77, 40, 20, hwndParent, NULL, hInst, NULL);
+        if (hWaitLabel) SendMessageW(hWaitLabel, WM_SETFONT, (WPARAM)hFont, TRUE);
+
+        hComboWaitPolicy = CreateWindowExW(0, L"COMBOBOX", L"",
+            WS_CHILD | WS_VISIBLE | CBS_DROPDOWNLIST | WS_VSCROLL,
+            255, yPos + 75, 130, 200, hwndParent, (HMENU)ID_COMBO_WAIT_POLICY, hInst, NULL);
+        if (!hComboWaitPolicy) return FALSE;
+        SendMessageW(hComboWaitPolicy, WM_SETFONT, (WPARAM)hFont, TRUE);
+
+        // item index == Sync::WaitPolicy value
+        const Sync::WaitPolicy waitPolicies[] = { Sync::WaitPolicy::Block, Sync::WaitPolicy::SpinThenYield,
+            Sync::WaitPolicy::Spin };
+        for (const auto& policy : waitPolicies) {
+            SendMessageW(hComboWaitPolicy, CB_ADDSTRING, 0, (LPARAM)Sync::WaitPolicyName(policy));
+        }
+        SendMessageW(hComboWaitPolicy, CB_SETCURSEL, 0, 0);
+
+        hCheckElasticDemo = CreateWindowExW(0, L"BUTTON", L"Elastic worker demo",
+            WS_CHILD | WS_VISIBLE | BS_AUTOCHECKBOX, 490, yPos + 77, 170, 20,
+            hwndParent, (HMENU)ID_CHECK_ELASTIC_DEMO, hInst, NULL);
+        if (!hCheckElasticDemo) return FALSE;
+        SendMessageW(hCheckElasticDemo, WM_SETFONT, (WPARAM)hFont, TRUE);
+
+        hCheckRuntimeBackends = CreateWindowExW(0, L"BUTTON", L"std::par / OpenMP",
+            WS_CHILD | WS_VISIBLE | BS_AUTOCHECKBOX, 680, yPos + 77, 170, 20,
+            hwndParent, (HMENU)ID_CHECK_RUNTIME_BACKENDS, hInst, NULL);
+        if (!hCheckRuntimeBackends) return FALSE;
+        SendMessageW(hCheckRuntimeBackends, WM_SETFONT, (WPARAM)hFont, TRUE);
+
+        yPos += 125;
 
         // Results Group
         hGroupResults = CreateWindowExW(0, L"BUTTON", L"Results",
@@ -338,15 +436,15 @@ namespace UI {
         ss << L"High-Precision Timing Test Results:\r\n====================================\r\n\r\n";
 
         ss << L"Test 1: Sleep(10) - 10 milliseconds\r\n";
-        LARGE_INTEGER start1 = Timing::NowQpc();
+        Timing::Ticks start1 = Timing::Now();
         Sleep(10);
-        LARGE_INTEGER end1 = Timing::NowQpc();
+        Timing::Ticks end1 = Timing::Now();
         ss << L"  Measured: " << Timing::FormatMicros(Timing::ElapsedMicros(start1, end1)) << L"\r\n\r\n";
 
         ss << L"Test 2: Sleep(100) - 100 milliseconds\r\n";
-        LARGE_INTEGER start2 = Timing::NowQpc();
+        Timing::Ticks start2 = Timing::Now();
         Sleep(100);
-        LARGE_INTEGER end2 = Timing::NowQpc();
+        Timing::Ticks end2 = Timing::Now();
         ss << L"  Measured: " << Timing::FormatMicros(Timing::ElapsedMicros(start2, end2)) << L"\r\n\r\n";
 
         LARGE_INTEGER freq;
@@ -373,6 +471,20 @@ namespace UI {
         SetEditText(hEditResults, cpuSetsInfo);
     }
 
+    void TestFalseSharing(HWND hwnd) {
+        SetEditText(hEditResults, L"Running false sharing benchmark...\r\n");
+
+        // 2P workers, like the top of the comprehensive sweep
+        uint32_t nWorkers = 2 * Orchestration::GetPhysicalCoreCount();
+        std::wstring report = MicroBench::FalseSharingReport(nWorkers, 20000000ull);
+        SetEditText(hEditResults, report);
+    }
+
+    void TestDecimalFormat(HWND hwnd) {
+        SetEditText(hEditResults, L"Running result formatting benchmark...\r\n");
+        SetEditText(hEditResults, MicroBench::DecimalFormatReport(4000000));
+    }
+
     void WriteSystemInfoFile(HWND hwnd) {
         std::wstringstream ss;
         ss << L"========================================\r\n"
@@ -411,7 +523,7 @@ namespace UI {
         BOOL runAll = (SendMessageW(hCheckRunAll, BM_GETCHECK, 0, 0) == BST_CHECKED);
 
         if (runAll) {
-            selectedTs = { 5, 10, 50, 100, 500, 1000, 1500 };
+            selectedTs = Experiment::DefaultTValues();
         }
         else {
             int selIndex = static_cast<int>(SendMessageW(hComboT, CB_GETCURSEL, 0, 0));
@@ -432,12 +544,111 @@ namespace UI {
         config.inputFilePath = g_selectedFilePath;
         config.tValues = selectedTs;
         config.maxWorkers = maxWorkers;
+        config.costBalancedStatic = (SendMessageW(hCheckBalancedStatic, BM_GETCHECK, 0, 0) == BST_CHECKED);
+
+        int pinIndex = static_cast<int>(SendMessageW(hComboPinPolicy, CB_GETCURSEL, 0, 0));
+        config.pinPolicy = (pinIndex == CB_ERR) ? Topology::PinPolicy::None : static_cast<Topology::PinPolicy>(pinIndex);
+
+        config.coreWeighting = (SendMessageW(hCheckCoreWeights, BM_GETCHECK, 0, 0) == BST_CHECKED)
+            ? Orchestration::CoreWeighting::Declared : Orchestration::CoreWeighting::None;
+        config.adaptiveChunks = (SendMessageW(hCheckAdaptiveChunks, BM_GETCHECK, 0, 0) == BST_CHECKED);
+        config.comparePolicies = (SendMessageW(hCheckComparePolicies, BM_GETCHECK, 0, 0) == BST_CHECKED);
+        config.numaQueues = (SendMessageW(hCheckNumaQueues, BM_GETCHECK, 0, 0) == BST_CHECKED);
+        config.replicateInput = (SendMessageW(hCheckReplicateInput, BM_GETCHECK, 0, 0) == BST_CHECKED);
+
+        int waitIndex = static_cast<int>(SendMessageW(hComboWaitPolicy, CB_GETCURSEL, 0, 0));
+        config.waitPolicy = (waitIndex == CB_ERR) ? Sync::WaitPolicy::Block : static_cast<Sync::WaitPolicy>(waitIndex);
+        config.elasticDemo = (SendMessageW(hCheckElasticDemo, BM_GETCHECK, 0, 0) == BST_CHECKED);
+        config.runtimeBackends = (SendMessageW(hCheckRuntimeBackends, BM_GETCHECK, 0, 0) == BST_CHECKED);
+
+        // Declared topology override: topology.ini next to the executable, if present
+        wchar_t exePath[MAX_PATH];
+        GetModuleFileNameW(NULL, exePath, MAX_PATH);
+        std::wstring topoPath(exePath);
+        topoPath = topoPath.substr(0, topoPath.find_last_of(L"\\/")) + L"\\topology.ini";
+        DWORD topoAttrs = GetFileAttributesW(topoPath.c_str());
+        if (topoAttrs != INVALID_FILE_ATTRIBUTES && !(topoAttrs & FILE_ATTRIBUTE_DIRECTORY)) {
+            config.topologyFile = topoPath;
+        }
 
         SetEditText(hEditResults, L"");
         g_orchestrationRunning = true;
         Orchestration::StartOrchestration(hwnd, config);
     }
 
+    // Pick an experiment spec (experiment.h), expand it and run the plan in the background
+    void RunExperimentSpec(HWND hwnd) {
+        if (g_orchestrationRunning) {
+            MessageBoxW(hwnd, L"Tests are already running!", L"Info", MB_OK | MB_ICONINFORMATION);
+            return;
+        }
+
+        wchar_t szFile[MAX_PATH] = { 0 };
+        OPENFILENAMEW ofn = { 0 };
+        ofn.lStructSize = sizeof(OPENFILENAMEW);
+        ofn.hwndOwner = hwnd;
+        ofn.lpstrFile = szFile;
+        ofn.nMaxFile = MAX_PATH;
+        ofn.lpstrFilter = L"Experiment Specs (*.ini)\0*.ini\0All Files (*.*)\0*.*\0";
+        ofn.nFilterIndex = 1;
+        ofn.lpstrTitle = L"Select Experiment Spec";
+        ofn.Flags = OFN_PATHMUSTEXIST | OFN_FILEMUSTEXIST | OFN_NOCHANGEDIR;
+        if (GetOpenFileNameW(&ofn) != TRUE) return;
+
+        std::vector<Experiment::JobSpec> jobs;
+        std::wstring err;
+        if (!Experiment::LoadSpec(szFile, jobs, err)) {
+            LogError(err);
+            MessageBoxW(hwnd, err.c_str(), L"Experiment Spec Error", MB_OK | MB_ICONERROR);
+            return;
+        }
+
+        SetEditText(hEditResults, L"");
+        g_orchestrationRunning = true;
+        Orchestration::StartExperimentPlan(hwnd, Experiment::Expand(jobs));
+    }
+
+    void ConvertBinaryResult(HWND hwnd) {
+        wchar_t szFile[MAX_PATH] = { 0 };
+        OPENFILENAMEW ofn = { 0 };
+        ofn.lStructSize = sizeof(OPENFILENAMEW);
+        ofn.hwndOwner = hwnd;
+        ofn.lpstrFile = szFile;
+        ofn.nMaxFile = MAX_PATH;
+        ofn.lpstrFilter = L"Binary Results (*.bin;*.bits)\0*.bin;*.bits\0All Files (*.*)\0*.*\0";
+        ofn.nFilterIndex = 1;
+        ofn.lpstrTitle = L"Select Binary Result";
+        ofn.Flags = OFN_PATHMUSTEXIST | OFN_FILEMUSTEXIST | OFN_NOCHANGEDIR;
+        if (GetOpenFileNameW(&ofn) != TRUE) return;
+
+        // a bitmap only marks positions: the values come from the input it was made from
+        std::wstring path = szFile;
+        const std::wstring bitsExt = FileIO::ResultExtension(FileIO::ResultEncoding::Bitmap);
+        bool isBitmap = path.size() > bitsExt.size() && path.compare(path.size() - bitsExt.size(), bitsExt.size(), bitsExt) == 0;
+        wchar_t szInput[MAX_PATH] = { 0 };
+        if (isBitmap) {
+            ofn.lpstrFile = szInput;
+            ofn.lpstrFilter = L"Binary Files (*.bin)\0*.bin\0All Files (*.*)\0*.*\0";
+            ofn.lpstrTitle = L"Select the Input of this Bitmap";
+            if (GetOpenFileNameW(&ofn) != TRUE) return;
+        }
+
+        std::wstring textPath, err;
+        uint64_t values = 0;
+        bool ok = isBitmap
+            ? ResultBitmap::ExpandToText(path, szInput, textPath, FileIO::ResultEncoding::Utf16, values, err)
+            : ResultBinary::ConvertToText(path, textPath, FileIO::ResultEncoding::Utf16, values, err);
+        if (!ok) {
+            LogError(err);
+            MessageBoxW(hwnd, err.c_str(), L"Conversion Error", MB_OK | MB_ICONERROR);
+            return;
+        }
+
+        std::wstringstream ss;
+        ss << L"Converted " << values << L" values:\r\n" << szFile << L"\r\n-> " << textPath << L"\r\n";
+        SetEditText(hEditResults, ss.str());
+    }
+
     void HandleOrchestrationLog(HWND hwnd, LPARAM lParam) {
         wchar_t* message = reinterpret_cast<wchar_t*>(lParam);
         int len = GetWindowTextLengthW(hEditResults);
@@ -472,6 +683,10 @@ namespace UI {
                 AppendMenuW(hMenu, MF_STRING, 3, L"Security/SID Tests");
                 AppendMenuW(hMenu, MF_STRING, 4, L"NUMA Information");
                 AppendMenuW(hMenu, MF_STRING, 5, L"CPU Sets Information");
+                AppendMenuW(hMenu, MF_STRING, 7, L"False Sharing Benchmark");
+                AppendMenuW(hMenu, MF_STRING, 9, L"Result Formatting Benchmark");
+                AppendMenuW(hMenu, MF_STRING, 8, L"Run Experiment Spec...");
+                AppendMenuW(hMenu, MF_STRING, 10, L"Convert Binary Result...");
                 AppendMenuW(hMenu, MF_SEPARATOR, 0, NULL);
                 AppendMenuW(hMenu, MF_STRING, 6, L"Write System Info to File");
 
@@ -487,6 +702,10 @@ namespace UI {
                 else if (cmd == 4) TestNumaInformation(hwnd);
                 else if (cmd == 5) TestCpuSetsInformation(hwnd);
                 else if (cmd == 6) WriteSystemInfoFile(hwnd);
+                else if (cmd == 7) TestFalseSharing(hwnd);
+                else if (cmd == 8) RunExperimentSpec(hwnd);
+                else if (cmd == 9) TestDecimalFormat(hwnd);
+                else if (cmd == 10) ConvertBinaryResult(hwnd);
             }
             else {
                 RunComprehensiveTests(hwnd);
@@ -12,6 +12,16 @@ namespace UI {
     constexpr int ID_BTN_RUN_TESTS = 1007;
     constexpr int ID_BTN_CLEAR = 1008;
     constexpr int ID_BTN_OPEN_FOLDER = 1009;
+    constexpr int ID_CHECK_BALANCED_STATIC = 1010;
+    constexpr int ID_COMBO_PIN_POLICY = 1011;
+    constexpr int ID_CHECK_CORE_WEIGHTS = 1012;
+    constexpr int ID_CHECK_ADAPTIVE_CHUNKS = 1013;
+    constexpr int ID_CHECK_COMPARE_POLICIES = 1014;
+    constexpr int ID_CHECK_NUMA_QUEUES = 1015;
+    constexpr int ID_CHECK_REPLICATE_INPUT = 1016;
+    constexpr int ID_COMBO_WAIT_POLICY = 1017;
+    constexpr int ID_CHECK_ELASTIC_DEMO = 1018;
+    constexpr int ID_CHECK_RUNTIME_BACKENDS = 1019;
 
     BOOL CreateControls(HWND hwndParent);
     void HandleResize(HWND hwnd, int width, int height);
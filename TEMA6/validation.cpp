@@ -48,6 +48,16 @@ namespace Validation {
         return result;
     }
 
+    ValidationResult ValidateCounts(size_t sequentialCount, size_t parallelCount) {
+        ValidationResult result;
+        result.sequentialCount = sequentialCount;
+        result.parallelCount = parallelCount;
+        result.missingCount = sequentialCount > parallelCount ? sequentialCount - parallelCount : 0;
+        result.extraCount = parallelCount > sequentialCount ? parallelCount - sequentialCount : 0;
+        result.passed = (sequentialCount == parallelCount);
+        return result;
+    }
+
     std::wstring FormatValidationResult(
         const ValidationResult& result,
         const std::wstring& testName
@@ -20,6 +20,10 @@ namespace Validation {
         const std::vector<uint32_t>& parallelFoundUnion
     );
 
+    // Runners stream their values to disk and keep only per-worker counts, so
+    // the sweep compares totals against the sequential reference
+    ValidationResult ValidateCounts(size_t sequentialCount, size_t parallelCount);
+
     std::wstring FormatValidationResult(
         const ValidationResult& result,
         const std::wstring& testName